@@ -9,6 +9,101 @@ using namespace oasclient;
 
 // statics
 int ClientInterface::_socketFD = -1;
+struct sockaddr_storage ClientInterface::_serverAddress;
+socklen_t ClientInterface::_serverAddressLength = 0;
+ClientInterface::Protocol ClientInterface::_protocol = ClientInterface::PROTOCOL_TEXT;
+bool ClientInterface::_isBatching = false;
+std::string ClientInterface::_batchData;
+int ClientInterface::_datagramFD = -1;
+unsigned int ClientInterface::_datagramSession = 0;
+unsigned int ClientInterface::_datagramKey = 0;
+unsigned int ClientInterface::_nextDatagramSequence = 1;
+int ClientInterface::_transferKey = 0;
+ClientInterface::RingHeader *ClientInterface::_ring = NULL;
+char *ClientInterface::_ringData = NULL;
+size_t ClientInterface::_ringMappedSize = 0;
+int ClientInterface::_ringWakeupFD = -1;
+std::string ClientInterface::_datagramData;
+unsigned int ClientInterface::_nextSequenceNumber = 1;
+std::string ClientInterface::_taggedData;
+std::map<unsigned int, std::string> ClientInterface::_taggedResponses;
+std::map<std::string, ClientInterface::ContentHash> ClientInterface::_contentHashes;
+
+// Append a 16 or 32 bit value to buf, in little-endian byte order
+static inline void putLittleEndian16(char *&buf, unsigned int value)
+{
+    *buf++ = (char) (value & 0xFF);
+    *buf++ = (char) ((value >> 8) & 0xFF);
+}
+
+static inline void putLittleEndian32(char *&buf, unsigned int value)
+{
+    putLittleEndian16(buf, value & 0xFFFF);
+    putLittleEndian16(buf, (value >> 16) & 0xFFFF);
+}
+
+// SHA-256 constants, from FIPS 180-4
+static const uint32_t hashInitialState[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t hashRoundConstants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotateRight(uint32_t value, unsigned int count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+// Add one 64 byte block to a SHA-256 hash
+static void hashBlock(uint32_t state[8], const unsigned char *block)
+{
+    uint32_t schedule[64];
+    uint32_t a, b, c, d, e, f, g, h;
+
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        schedule[i] = ((uint32_t) block[4 * i] << 24) | ((uint32_t) block[4 * i + 1] << 16)
+                      | ((uint32_t) block[4 * i + 2] << 8) | (uint32_t) block[4 * i + 3];
+    }
+
+    for (unsigned int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = rotateRight(schedule[i - 15], 7) ^ rotateRight(schedule[i - 15], 18)
+                      ^ (schedule[i - 15] >> 3);
+        uint32_t s1 = rotateRight(schedule[i - 2], 17) ^ rotateRight(schedule[i - 2], 19)
+                      ^ (schedule[i - 2] >> 10);
+
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3];
+    e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+    for (unsigned int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25))
+                      + ((e & f) ^ (~e & g)) + hashRoundConstants[i] + schedule[i];
+        uint32_t t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22))
+                      + ((a & b) ^ (a & c) ^ (b & c));
+
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
 
 bool ClientInterface::initialize(const std::string &host, unsigned short port)
 {
@@ -21,65 +116,647 @@ bool ClientInterface::initialize(const std::string &host, unsigned short port)
     // Set the internal socketFD to -1
     _socketFD = -1;
 
-    // Set the address info struct to 0
-    memset(&stSockAddr, 0, sizeof(stSockAddr));
+    // Set the address info struct to 0
+    memset(&stSockAddr, 0, sizeof(stSockAddr));
+
+    // Set the values for the address struct
+    stSockAddr.sin_family = AF_INET;
+    stSockAddr.sin_port = htons(port);
+
+    // Convert address from text to binary
+    if (0 >= inet_pton(AF_INET, host.c_str(), &stSockAddr.sin_addr))
+    {
+        return false;
+    }
+
+    // Create the socket, and connect to the server
+    if (!_connect((struct sockaddr *) &stSockAddr, sizeof(stSockAddr), socketFD))
+    {
+        return false;
+    }
+
+    ClientInterface::_socketFD = socketFD;
+    memcpy(&ClientInterface::_serverAddress, &stSockAddr, sizeof(stSockAddr));
+    ClientInterface::_serverAddressLength = sizeof(stSockAddr);
+    ClientInterface::_protocol = PROTOCOL_TEXT;
+    return true;
+}
+
+bool ClientInterface::initialize(const std::string &socketPath)
+{
+    if (isInitialized())
+        return true;
+
+    struct sockaddr_un localAddr;
+    int socketFD;
+
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sun_family = AF_UNIX;
+
+    if (sizeof(localAddr.sun_path) <= socketPath.size())
+    {
+        return false;
+    }
+
+    strcpy(localAddr.sun_path, socketPath.c_str());
+
+    if (!_connect((struct sockaddr *) &localAddr, sizeof(localAddr), socketFD))
+    {
+        return false;
+    }
+
+    ClientInterface::_socketFD = socketFD;
+    memcpy(&ClientInterface::_serverAddress, &localAddr, sizeof(localAddr));
+    ClientInterface::_serverAddressLength = sizeof(localAddr);
+    ClientInterface::_protocol = PROTOCOL_TEXT;
+    return true;
+}
+
+bool ClientInterface::_connect(const struct sockaddr *address, socklen_t addressLength, int &socketFD)
+{
+    socketFD = socket(address->sa_family, SOCK_STREAM, 0);
+
+    if (-1 == socketFD)
+    {
+        return false;
+    }
+
+    if (AF_INET == address->sa_family)
+    {
+        int one = 1;
+
+        setsockopt(socketFD, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    // Connect to the established socket
+    if (-1 == connect(socketFD, address, addressLength))
+    {
+        close(socketFD);
+        socketFD = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool ClientInterface::isInitialized()
+{
+    // Initialized only if socketFD
+    return (-1 != _socketFD);
+}
+
+bool ClientInterface::shutdown()
+{
+    if ((-1 == ClientInterface::_socketFD)
+        || (ClientInterface::endBatch()
+            && ClientInterface::writeToServer(Command("QUIT"))
+            && (0 == close(ClientInterface::_socketFD))))
+    {
+        ClientInterface::_socketFD = -1;
+        ClientInterface::_taggedData.clear();
+        ClientInterface::_taggedResponses.clear();
+        ClientInterface::_isBatching = false;
+
+        if (-1 != ClientInterface::_datagramFD)
+            close(ClientInterface::_datagramFD);
+        ClientInterface::_datagramFD = -1;
+        ClientInterface::_datagramData.clear();
+        ClientInterface::_transferKey = 0;
+
+        _closeSharedMemoryChannel();
+        return true;
+    }
+    else
+    {
+        return false;
+    }
+}
+
+bool ClientInterface::setProtocol(Protocol protocol)
+{
+    if (protocol == ClientInterface::_protocol)
+        return true;
+
+    // The request itself still goes out with the current protocol
+    if (!ClientInterface::writeToServer(Command("PROT").integer(protocol))
+        || !ClientInterface::_flushBatch())
+        return false;
+
+    // Servers that do not know about PROT ignore it and never respond, so don't wait forever
+    if (!_waitForSetupResponse())
+        return false;
+
+    // The server responds with the protocol that is in use from now on
+    int result;
+
+    if (!ClientInterface::readIntegerFromServer(result))
+        return false;
+
+    if (PROTOCOL_TEXT == result || PROTOCOL_BINARY == result)
+        ClientInterface::_protocol = (Protocol) result;
+
+    return (protocol == ClientInterface::_protocol);
+}
+
+ClientInterface::Protocol ClientInterface::getProtocol()
+{
+    return ClientInterface::_protocol;
+}
+
+bool ClientInterface::beginBatch()
+{
+    if (!isInitialized())
+        return false;
+
+    ClientInterface::_isBatching = true;
+    return true;
+}
+
+bool ClientInterface::endBatch()
+{
+    bool result = _flushDatagram();
+
+    result = _flushBatch() && result;
+
+    ClientInterface::_isBatching = false;
+    return result;
+}
+
+bool ClientInterface::openDatagramChannel()
+{
+    if (isDatagramChannelOpen())
+        return true;
+
+    // The datagrams go to the same host, so a TCP connection is needed
+    if (AF_INET != ClientInterface::_serverAddress.ss_family)
+        return false;
+
+    if (!ClientInterface::writeToServer(Command("DGRM"))
+        || !ClientInterface::_flushBatch()
+        || !_waitForSetupResponse())
+        return false;
+
+    // The response is "<port> <session> <key>", or "-1" if there is no datagram channel
+    char *data;
+    size_t count;
+
+    if (!ClientInterface::readFromServer(data, count))
+        return false;
+
+    std::istringstream converter(std::string(data, count));
+    long port = -1;
+    unsigned int session, key;
+
+    delete[] data;
+
+    if (!(converter >> port >> session >> key) || 0 >= port)
+        return false;
+
+    struct sockaddr_in datagramAddr;
+    memcpy(&datagramAddr, &ClientInterface::_serverAddress, sizeof(datagramAddr));
+    datagramAddr.sin_port = htons(port);
+
+    int datagramFD = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+
+    if (-1 == datagramFD)
+        return false;
+
+    if (-1 == connect(datagramFD, (struct sockaddr *) &datagramAddr, sizeof(datagramAddr)))
+    {
+        close(datagramFD);
+        return false;
+    }
+
+    ClientInterface::_datagramFD = datagramFD;
+    ClientInterface::_datagramSession = session;
+    ClientInterface::_datagramKey = key;
+    return true;
+}
+
+bool ClientInterface::isDatagramChannelOpen()
+{
+    return (-1 != ClientInterface::_datagramFD);
+}
+
+bool ClientInterface::openSharedMemoryChannel()
+{
+    if (isSharedMemoryChannelOpen())
+        return true;
+
+    // The descriptors of the ring can only be passed over a Unix domain socket
+    if (AF_UNIX != ClientInterface::_serverAddress.ss_family)
+        return false;
+
+    if (!ClientInterface::writeToServer(Command("SHMR"))
+        || !ClientInterface::_flushBatch()
+        || !_waitForSetupResponse())
+        return false;
+
+    // The response is the capacity of the ring, or "-1". The shared memory and the event
+    // descriptor that wakes up the server come along with it.
+    char buf[PACKET_SIZE];
+    int descriptors[2] = {-1, -1};
+    char control[CMSG_SPACE(sizeof(descriptors))];
+    struct iovec data;
+    struct msghdr message;
+    struct cmsghdr *controlHeader;
+
+    data.iov_base = buf;
+    data.iov_len = sizeof(buf) - 1;
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    int retval = recvmsg(ClientInterface::_socketFD, &message, 0);
+
+    if (0 >= retval)
+        return false;
+
+    buf[retval] = '\0';
+
+    controlHeader = CMSG_FIRSTHDR(&message);
+
+    if (controlHeader
+        && SOL_SOCKET == controlHeader->cmsg_level
+        && SCM_RIGHTS == controlHeader->cmsg_type
+        && CMSG_LEN(sizeof(descriptors)) == controlHeader->cmsg_len)
+    {
+        memcpy(descriptors, CMSG_DATA(controlHeader), sizeof(descriptors));
+    }
+
+    long capacity = atol(buf);
+    void *memory = MAP_FAILED;
+
+    if (0 < capacity && -1 != descriptors[0] && -1 != descriptors[1])
+    {
+        memory = mmap(NULL, RING_DATA_OFFSET + capacity, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      descriptors[0], 0);
+    }
+
+    // The mapping stays valid after its descriptor is closed
+    if (-1 != descriptors[0])
+        close(descriptors[0]);
+
+    if (MAP_FAILED == memory)
+    {
+        if (-1 != descriptors[1])
+            close(descriptors[1]);
+        return false;
+    }
+
+    ClientInterface::_ring = (RingHeader *) memory;
+    ClientInterface::_ringData = (char *) memory + RING_DATA_OFFSET;
+    ClientInterface::_ringMappedSize = RING_DATA_OFFSET + capacity;
+    ClientInterface::_ringWakeupFD = descriptors[1];
+
+    if (RING_MAGIC != ClientInterface::_ring->magic
+        || (uint32_t) capacity != ClientInterface::_ring->capacity)
+    {
+        _closeSharedMemoryChannel();
+        return false;
+    }
+
+    return true;
+}
+
+bool ClientInterface::isSharedMemoryChannelOpen()
+{
+    return (NULL != ClientInterface::_ring);
+}
+
+void ClientInterface::_closeSharedMemoryChannel()
+{
+    if (!isSharedMemoryChannelOpen())
+        return;
+
+    munmap(ClientInterface::_ring, ClientInterface::_ringMappedSize);
+    close(ClientInterface::_ringWakeupFD);
+
+    ClientInterface::_ring = NULL;
+    ClientInterface::_ringData = NULL;
+    ClientInterface::_ringMappedSize = 0;
+    ClientInterface::_ringWakeupFD = -1;
+}
+
+bool ClientInterface::_writeToRing(const char *data, size_t count)
+{
+    // Only this side writes the write index, and the capacity never changes
+    uint32_t capacity = ClientInterface::_ring->capacity;
+    uint32_t writeIndex = ClientInterface::_ring->writeIndex;
+    int waitedMs = 0;
+
+    while (count > 0)
+    {
+        uint32_t space = capacity - (writeIndex - __atomic_load_n(&ClientInterface::_ring->readIndex,
+                                                                  __ATOMIC_ACQUIRE));
+
+        // The server has fallen behind. Make sure that it is awake, and give it a moment.
+        if (0 == space)
+        {
+            if (RING_FULL_TIMEOUT_MS <= waitedMs++)
+                return false;
+
+            eventfd_write(ClientInterface::_ringWakeupFD, 1);
+            usleep(1000);
+            continue;
+        }
+
+        // The bytes may wrap around the end of the data area
+        uint32_t offset = writeIndex & (capacity - 1);
+        size_t amount = count;
+
+        if (amount > space)
+            amount = space;
+        if (amount > capacity - offset)
+            amount = capacity - offset;
+
+        memcpy(ClientInterface::_ringData + offset, data, amount);
+        data += amount;
+        count -= amount;
+        writeIndex += amount;
+
+        __atomic_store_n(&ClientInterface::_ring->writeIndex, writeIndex, __ATOMIC_RELEASE);
+    }
+
+    // Only wake up the server if it has announced that it is going to sleep. The index is
+    // published before the flag is checked, and the server does the opposite, so one of the
+    // two is guaranteed to see the other.
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(&ClientInterface::_ring->isServerSleeping, __ATOMIC_RELAXED))
+        eventfd_write(ClientInterface::_ringWakeupFD, 1);
+
+    return true;
+}
+
+bool ClientInterface::writeDatagramToServer(const Command &command)
+{
+    if (!isDatagramChannelOpen())
+        return writeToServer(command);
+
+    // Datagrams always hold messages in the binary protocol
+    char buf[PACKET_SIZE * 2];
+    int size = _encodeBinary(command, false, 0, buf);
+
+    if (0 > size)
+        return false;
+
+    // Start a new datagram if this would not fit
+    if (MAX_DATAGRAM_SIZE < DATAGRAM_HEADER_SIZE + ClientInterface::_datagramData.size() + size
+        && !_flushDatagram())
+        return false;
+
+    ClientInterface::_datagramData.append(buf, size);
+
+    if (ClientInterface::_isBatching)
+        return true;
+
+    return _flushDatagram();
+}
+
+bool ClientInterface::_flushDatagram()
+{
+    if (ClientInterface::_datagramData.empty())
+        return true;
+
+    // Header: session, key, sequence number
+    char header[DATAGRAM_HEADER_SIZE];
+    char *pos = header;
+
+    putLittleEndian32(pos, ClientInterface::_datagramSession);
+    putLittleEndian32(pos, ClientInterface::_datagramKey);
+    putLittleEndian32(pos, ClientInterface::_nextDatagramSequence++);
+
+    ClientInterface::_datagramData.insert(0, header, DATAGRAM_HEADER_SIZE);
+
+    bool result = (-1 != send(ClientInterface::_datagramFD,
+                              ClientInterface::_datagramData.data(),
+                              ClientInterface::_datagramData.size(),
+                              0));
+
+    ClientInterface::_datagramData.clear();
+    return result;
+}
+
+bool ClientInterface::_waitForSetupResponse()
+{
+    struct pollfd pollInfo;
+    pollInfo.fd = ClientInterface::_socketFD;
+    pollInfo.events = POLLIN;
+
+    return (0 < poll(&pollInfo, 1, SETUP_RESPONSE_TIMEOUT_MS));
+}
+
+bool ClientInterface::_flushBatch()
+{
+    if (ClientInterface::_batchData.empty())
+        return true;
+
+    // The batch starts with a BTCH message that holds the size of the batch in bytes, and is
+    // sent in one go along with the batch
+    Command header = Command("BTCH").integer(ClientInterface::_batchData.size());
+    char buf[PACKET_SIZE * 2];
+    int headerSize;
+
+    if (PROTOCOL_BINARY == ClientInterface::_protocol)
+        headerSize = _encodeBinary(header, false, 0, buf);
+    else
+        headerSize = _encodeText(header, false, 0, buf);
+
+    ClientInterface::_batchData.insert(0, buf, headerSize);
+
+    bool result = _send(ClientInterface::_batchData.data(), ClientInterface::_batchData.size());
+
+    ClientInterface::_batchData.clear();
+    return result;
+}
+
+bool ClientInterface::_write(const char *data, size_t count)
+{
+    if (ClientInterface::_isBatching)
+    {
+        // Send what has been collected so far as its own batch, if this would not fit
+        if (MAX_BATCH_SIZE < ClientInterface::_batchData.size() + count && !_flushBatch())
+            return false;
+
+        ClientInterface::_batchData.append(data, count);
+        return true;
+    }
+
+    return _send(data, count);
+}
+
+bool ClientInterface::_send(const char *data, size_t count)
+{
+    if (isSharedMemoryChannelOpen())
+        return _writeToRing(data, count);
+
+    return (-1 != write(ClientInterface::_socketFD, data, count));
+}
+
+bool ClientInterface::writeToServer(const Command &command)
+{
+    return _writeCommand(command, false, 0);
+}
+
+bool ClientInterface::writeRequestToServer(ResponseFuture &future, const Command &command)
+{
+    future = ResponseFuture();
+
+    unsigned int sequenceNumber = ClientInterface::_nextSequenceNumber++;
+
+    if (!_writeCommand(command, true, sequenceNumber))
+        return false;
+
+    future._sequenceNumber = sequenceNumber;
+    future._isValid = true;
+    return true;
+}
+
+bool ClientInterface::_writeCommand(const Command &command, bool isTagged, unsigned int sequenceNumber)
+{
+    if (!isInitialized())
+    {
+        return false;
+    }
+
+    char buf[PACKET_SIZE * 2];
+    int size;
+
+    if (PROTOCOL_BINARY == ClientInterface::_protocol)
+        size = _encodeBinary(command, isTagged, sequenceNumber, buf);
+    else
+        size = _encodeText(command, isTagged, sequenceNumber, buf);
+
+    // If the message exceeds the message packet size, then we cannot send
+    if (0 > size)
+    {
+        return false;
+    }
+
+    if (!_write(buf, size))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+int ClientInterface::_encodeText(const Command &command, bool isTagged, unsigned int sequenceNumber, char *buf)
+{
+    int length = 0;
+
+    // Parameters are separated by spaces, in the order:
+    // [@<sequence number>] <type> [filename] [handle] [integer] [values...]
+    if (isTagged)
+        length += snprintf(buf + length, PACKET_SIZE - length, "@%u ", sequenceNumber);
+
+    length += snprintf(buf + length, PACKET_SIZE - length, "%.4s", command._type);
+
+    if (!command._filename.empty() && PACKET_SIZE > length)
+        length += snprintf(buf + length, PACKET_SIZE - length, " %s", command._filename.c_str());
+
+    if (command._hasHandle && PACKET_SIZE > length)
+        length += snprintf(buf + length, PACKET_SIZE - length, " %ld", command._handle);
 
-    // Set the values for the address struct
-    stSockAddr.sin_family = AF_INET;
-    stSockAddr.sin_port = htons(port);
+    if (command._hasInteger && PACKET_SIZE > length)
+        length += snprintf(buf + length, PACKET_SIZE - length, " %ld", command._integer);
 
-    // Convert address from text to binary
-    if (0 >= inet_pton(AF_INET, host.c_str(), &stSockAddr.sin_addr))
+    for (unsigned int i = 0; i < command._numValues && PACKET_SIZE > length; i++)
+        length += snprintf(buf + length, PACKET_SIZE - length, " %f", command._values[i]);
+
+    if (PACKET_SIZE <= length)
     {
-        return false;
+        return -1;
     }
 
-    // Create the socket
-    socketFD = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    // Messages are null terminated
+    buf[length] = '\0';
+    return length + 1;
+}
 
-    if (-1 == socketFD)
+int ClientInterface::_encodeBinary(const Command &command, bool isTagged, unsigned int sequenceNumber, char *buf)
+{
+    // Header: type[4], handle (uint32), payload length (uint16), flags (uint16)
+    // Payload: [sequence number (uint32)] [integer (int32)] [values (float32)...] [filename]
+    unsigned int payloadLength = (isTagged ? 4 : 0)
+                                 + (command._hasInteger ? 4 : 0)
+                                 + 4 * command._numValues
+                                 + command._filename.size();
+
+    if (PACKET_SIZE < payloadLength)
     {
-        return false;
+        return -1;
     }
 
-    int one = 1;
+    char *pos = buf;
 
-    setsockopt(socketFD, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    memcpy(pos, command._type, 4);
+    pos += 4;
+    putLittleEndian32(pos, command._hasHandle ? (unsigned int) command._handle : 0);
+    putLittleEndian16(pos, payloadLength);
+    putLittleEndian16(pos, isTagged ? BINARY_FLAG_SEQUENCE_NUMBER : 0);
 
+    if (isTagged)
+        putLittleEndian32(pos, sequenceNumber);
 
-    // Connect to the established socket
-    if (-1 == connect(socketFD, (struct sockaddr *) &stSockAddr, sizeof(stSockAddr)))
+    if (command._hasInteger)
+        putLittleEndian32(pos, (unsigned int) command._integer);
+
+    for (unsigned int i = 0; i < command._numValues; i++)
     {
-        close(socketFD);
-        return false;
+        unsigned int bits;
+        memcpy(&bits, &command._values[i], sizeof(bits));
+        putLittleEndian32(pos, bits);
     }
 
-    ClientInterface::_socketFD = socketFD;
-    return true;
+    memcpy(pos, command._filename.data(), command._filename.size());
+    pos += command._filename.size();
+
+    return pos - buf;
 }
 
-bool ClientInterface::isInitialized()
+bool ClientInterface::writeToServer(const char *format, ...)
 {
-    // Initialized only if socketFD
-    return (-1 != _socketFD);
+    va_list args;
+    bool result;
+
+    va_start(args, format);
+    result = _writeToServer(NULL, format, args);
+    va_end(args);
+
+    return result;
 }
 
-bool ClientInterface::shutdown()
+bool ClientInterface::writeRequestToServer(ResponseFuture &future, const char *format, ...)
 {
-    if ((-1 == ClientInterface::_socketFD)
-        || (ClientInterface::writeToServer("QUIT")
-            && (0 == close(ClientInterface::_socketFD))))
-    {
-        ClientInterface::_socketFD = -1;
-        return true;
-    }
-    else
+    char tag[32];
+    va_list args;
+    bool result;
+
+    future = ResponseFuture();
+
+    // Tag the request with the next sequence number, as "@<sequence number> "
+    unsigned int sequenceNumber = ClientInterface::_nextSequenceNumber++;
+    sprintf(tag, "@%u ", sequenceNumber);
+
+    va_start(args, format);
+    result = _writeToServer(tag, format, args);
+    va_end(args);
+
+    if (result)
     {
-        return false;
+        future._sequenceNumber = sequenceNumber;
+        future._isValid = true;
     }
+
+    return result;
 }
 
-bool ClientInterface::writeToServer(const char *format, ...)
+bool ClientInterface::_writeToServer(const char *tag, const char *format, va_list args)
 {
     if (!format || !isInitialized())
     {
@@ -88,13 +765,16 @@ bool ClientInterface::writeToServer(const char *format, ...)
 
     // Create a buffer that should be more than long enough to fit data
     char buf[PACKET_SIZE * 2] = {0};
-    int bufSizeAttempt, length;
-    va_list args;
+    int bufSizeAttempt, tagLength = 0;
 
-    // Read var args, put the formatted string into buf
-    va_start(args, format);
-    bufSizeAttempt = vsnprintf(buf, PACKET_SIZE, format, args);
-    va_end(args);
+    if (tag)
+    {
+        tagLength = strlen(tag);
+        memcpy(buf, tag, tagLength);
+    }
+
+    // Put the formatted string into buf, after the tag
+    bufSizeAttempt = tagLength + vsnprintf(buf + tagLength, PACKET_SIZE - tagLength, format, args);
 
     // If the formatted string exceeds the message packet size, then we cannot send
     if (PACKET_SIZE <= bufSizeAttempt)
@@ -102,7 +782,7 @@ bool ClientInterface::writeToServer(const char *format, ...)
         return false;
     }
 
-    if (-1 == write(ClientInterface::_socketFD, buf, bufSizeAttempt + 1))
+    if (!_write(buf, bufSizeAttempt + 1))
     {
         return false;
     }
@@ -118,7 +798,8 @@ bool ClientInterface::readFromServer(char *&data, size_t &count)
     data = NULL;
     count = 0;
 
-    if (-1 == ClientInterface::_socketFD)
+    // The request for this response may still be waiting in a batch
+    if (-1 == ClientInterface::_socketFD || !_flushBatch())
     {
         return false;
     }
@@ -167,79 +848,453 @@ bool ClientInterface::readIntegerFromServer(int &value)
     return true;
 }
 
+bool ClientInterface::readIntegerFromServer(ResponseFuture &future, int &value)
+{
+    std::string response;
+
+    value = -1;
+    if (!_readResponse(future, response))
+        return false;
+
+    std::istringstream converter(response);
+    int result = -1;
+
+    if (!(converter >> result))
+        return false;
+
+    value = result;
+    return true;
+}
+
+bool ClientInterface::_isResponseReady(const ResponseFuture &future)
+{
+    if (!future.isValid())
+        return false;
+
+    // Pick up whatever has arrived so far, without waiting
+    if (ClientInterface::_taggedResponses.end() == ClientInterface::_taggedResponses.find(future._sequenceNumber))
+        _receiveTaggedResponses(false);
+
+    return (ClientInterface::_taggedResponses.end() != ClientInterface::_taggedResponses.find(future._sequenceNumber));
+}
+
+bool ClientInterface::_readResponse(ResponseFuture &future, std::string &response)
+{
+    if (!future.isValid())
+        return false;
+
+    std::map<unsigned int, std::string>::iterator iterator;
+
+    // Keep receiving until the response to this particular request shows up
+    while (ClientInterface::_taggedResponses.end()
+           == (iterator = ClientInterface::_taggedResponses.find(future._sequenceNumber)))
+    {
+        if (!_receiveTaggedResponses(true))
+            return false;
+    }
+
+    response = iterator->second;
+    ClientInterface::_taggedResponses.erase(iterator);
+    future._isValid = false;
+
+    return true;
+}
+
+bool ClientInterface::_receiveTaggedResponses(bool block)
+{
+    // The requests for these responses may still be waiting in a batch
+    if (-1 == ClientInterface::_socketFD || !_flushBatch())
+    {
+        return false;
+    }
+
+    char buf[PACKET_SIZE];
+    int retval;
+
+    if (!block)
+    {
+        struct pollfd pollInfo;
+        pollInfo.fd = ClientInterface::_socketFD;
+        pollInfo.events = POLLIN;
+
+        // Nothing to read right now
+        if (0 >= poll(&pollInfo, 1, 0))
+            return true;
+    }
+
+    retval = read(ClientInterface::_socketFD, buf, PACKET_SIZE);
+
+    if (-1 == retval || 0 == retval)
+    {
+        return false;
+    }
+
+    ClientInterface::_taggedData.append(buf, retval);
+
+    // Each tagged response is a line of the form "@<sequence number> <response>"
+    std::string::size_type lineEnd;
+
+    while (std::string::npos != (lineEnd = ClientInterface::_taggedData.find('\n')))
+    {
+        std::string line = ClientInterface::_taggedData.substr(0, lineEnd);
+        ClientInterface::_taggedData.erase(0, lineEnd + 1);
+
+        char *endp;
+        unsigned long sequenceNumber;
+
+        if (line.empty() || '@' != line[0])
+            continue;
+
+        sequenceNumber = strtoul(line.c_str() + 1, &endp, 10);
+
+        if (' ' == *endp)
+            endp++;
+
+        ClientInterface::_taggedResponses[sequenceNumber] = std::string(endp);
+    }
+
+    return true;
+}
+
 bool ClientInterface::sendFile(const std::string &sPath, const std::string &sFilename)
 {
-    int fileSize;
     struct stat fileInfo;
-    char *data;
-    const char *filePath;
 
-    // If the connection to the server is not established, fail early
-    if (-1 == ClientInterface::_socketFD)
+    // Append the path and filename together
+    std::string sFilePath = sPath + "/" + sFilename;
+
+    // Retrieve file information. Note: stat() returns 0 on success
+    if (0 != stat(sFilePath.c_str(), &fileInfo))
     {
         return false;
     }
 
-    // Append the path and filename together, and assign the filePath pointer to the appended string
+    return ClientInterface::_sendFile(Command("PTFI").filename(sFilename).integer(fileInfo.st_size),
+                                      sFilePath, fileInfo.st_size);
+}
+
+bool ClientInterface::sendFileContent(const std::string &sPath, const std::string &sFilename,
+                                      const std::string &hash)
+{
+    struct stat fileInfo;
     std::string sFilePath = sPath + "/" + sFilename;
-    filePath = sFilePath.c_str();
 
-    // Retrieve file information. Note: stat() returns 0 on success
-    if (0 != stat(filePath, &fileInfo))
+    if (0 != stat(sFilePath.c_str(), &fileInfo))
+    {
+        return false;
+    }
+
+    return ClientInterface::_sendFile(Command("PTFC").filename(hash).integer(fileInfo.st_size),
+                                      sFilePath, fileInfo.st_size);
+}
+
+bool ClientInterface::getContentHash(const std::string &sPath, const std::string &sFilename,
+                                     std::string &hash)
+{
+    struct stat fileInfo;
+    std::string sFilePath = sPath + "/" + sFilename;
+
+    if (0 != stat(sFilePath.c_str(), &fileInfo))
     {
         return false;
     }
 
-    fileSize = fileInfo.st_size;
+    // Only hash the file again if it has changed since the last time
+    std::map<std::string, ContentHash>::iterator iterator = _contentHashes.find(sFilePath);
+
+    if (_contentHashes.end() != iterator
+        && iterator->second.size == fileInfo.st_size
+        && iterator->second.modificationTime == fileInfo.st_mtime)
+    {
+        hash = iterator->second.hash;
+        return true;
+    }
 
-    // Send the PTFI message to the server
-    char buf[PACKET_SIZE + 1] = {0};
-    int sizeAttempt = snprintf(buf, PACKET_SIZE, "PTFI %s %d", sFilename.c_str(), fileSize);
+    std::ifstream fileIn(sFilePath.c_str(), std::ios::in | std::ios::binary);
+    char data[FILE_CHUNK_SIZE];
 
-    // If the amount written to buffer is greater than what we can send, return false
-    if (PACKET_SIZE <= sizeAttempt)
+    if (!fileIn.is_open())
     {
         return false;
     }
 
-    if (!ClientInterface::writeToServer(buf))
+    // SHA-256, the same hash that the server computes over uploaded files. Every chunk but the
+    // last one is a whole number of blocks, so only the end of the file has to be padded.
+    uint32_t state[8];
+    uint64_t length = 0;
+    unsigned char block[128];
+    unsigned int remaining = 0;
+
+    memcpy(state, hashInitialState, sizeof(state));
+
+    while (fileIn.read(data, FILE_CHUNK_SIZE) || fileIn.gcount() > 0)
+    {
+        const unsigned char *pos = (const unsigned char *) data;
+        unsigned int amount = fileIn.gcount();
+
+        length += amount;
+
+        for (; amount >= 64; pos += 64, amount -= 64)
+            hashBlock(state, pos);
+
+        memcpy(block, pos, amount);
+        remaining = amount;
+    }
+
+    // Pad with a single 1 bit and then 0 bits, up to the length in the last 8 bytes of a block
+    unsigned int paddedSize = (remaining < 56) ? 64 : 128;
+    uint64_t bitLength = length * 8;
+
+    block[remaining] = 0x80;
+    memset(block + remaining + 1, 0, paddedSize - remaining - 1);
+
+    for (unsigned int i = 0; i < 8; i++)
+        block[paddedSize - 1 - i] = (unsigned char) (bitLength >> (8 * i));
+
+    for (unsigned int i = 0; i < paddedSize; i += 64)
+        hashBlock(state, block + i);
+
+    char buf[65];
+
+    for (unsigned int i = 0; i < 8; i++)
+        snprintf(buf + 8 * i, 9, "%08x", state[i]);
+
+    ContentHash &cached = _contentHashes[sFilePath];
+    cached.size = fileInfo.st_size;
+    cached.modificationTime = fileInfo.st_mtime;
+    cached.hash = buf;
+
+    hash = cached.hash;
+    return true;
+}
+
+bool ClientInterface::_sendFile(const Command &command, const std::string &sFilePath, int fileSize)
+{
+    // If the connection to the server is not established, fail early. Likewise if the file can't
+    // be read, because the server can't be told about it and then not receive it.
+    if (-1 == ClientInterface::_socketFD || 0 != access(sFilePath.c_str(), R_OK))
     {
         return false;
     }
 
-    // Read file from disk
-    data = new char[fileSize];
-    std::ifstream fileIn(filePath, std::ios::in | std::ios::binary);
-    fileIn.read(data, fileInfo.st_size);
-    
-    // Send the file over the socket
-    int bytesLeft, bytesWritten;
+    // Prefer a transfer connection, so that the file does not hold up other commands
+    int transferFD = _openTransferConnection();
+
+    if (-1 != transferFD)
+    {
+        bool result = _sendFileOverTransferConnection(transferFD, command, sFilePath, fileSize);
+        close(transferFD);
+        return result;
+    }
+
+    // Everything written to the ring is read in order, so the file can't follow its PTFI message
+    // on the connection
+    if (isSharedMemoryChannelOpen())
+    {
+        return false;
+    }
+
+    // The file data goes straight to the socket, so it cannot be part of a batch
+    bool wasBatching = ClientInterface::_isBatching;
+
+    if (!ClientInterface::endBatch())
+    {
+        return false;
+    }
+
+    // Send the PTFI or PTFC message to the server, followed by the file
+    if (!ClientInterface::writeToServer(command)
+        || !_writeFile(ClientInterface::_socketFD, sFilePath, fileSize))
+    {
+        return false;
+    }
+
+    if (wasBatching)
+        ClientInterface::beginBatch();
+
+    return true;
+}
+
+int ClientInterface::_openTransferConnection()
+{
+    // Ask for the key once per connection. Servers that don't support transfer connections
+    // respond with -1, or not at all.
+    if (0 == ClientInterface::_transferKey)
+    {
+        int key = -1;
+
+        if (!ClientInterface::writeToServer(Command("XFER"))
+            || !ClientInterface::_flushBatch()
+            || !_waitForSetupResponse()
+            || !ClientInterface::readIntegerFromServer(key)
+            || 0 >= key)
+        {
+            key = -1;
+        }
+
+        ClientInterface::_transferKey = key;
+    }
+
+    if (0 > ClientInterface::_transferKey)
+    {
+        return -1;
+    }
+
+    int transferFD;
+
+    if (!_connect((struct sockaddr *) &ClientInterface::_serverAddress,
+                  ClientInterface::_serverAddressLength, transferFD))
+    {
+        return -1;
+    }
+
+    return transferFD;
+}
+
+bool ClientInterface::_sendFileOverTransferConnection(int transferFD, const Command &command,
+                                                      const std::string &sFilePath, int fileSize)
+{
+    // Transfer connections always start out with the text protocol
+    char buf[PACKET_SIZE * 4];
+    int attachSize = _encodeText(Command("ATCH").integer(ClientInterface::_transferKey), false, 0, buf);
+    int commandSize = _encodeText(command, false, 0, buf + attachSize);
+
+    if (0 > commandSize
+        || -1 == write(transferFD, buf, attachSize + commandSize)
+        || !_writeFile(transferFD, sFilePath, fileSize))
+    {
+        return false;
+    }
+
+    // The server responds once the file is in its cache, and then closes the connection
+    std::string response;
+    int bytesRead;
+
+    while (0 < (bytesRead = read(transferFD, buf, PACKET_SIZE)))
+    {
+        response.append(buf, bytesRead);
+    }
+
+    std::istringstream converter(response);
+    int result = -1;
+
+    return (converter >> result) && (0 == result);
+}
+
+bool ClientInterface::_writeFile(int fd, const std::string &sFilePath, int fileSize)
+{
+    std::ifstream fileIn(sFilePath.c_str(), std::ios::in | std::ios::binary);
+
+    if (!fileIn.is_open())
+    {
+        return false;
+    }
+
+    // Send the file over the socket, one chunk at a time
+    char data[FILE_CHUNK_SIZE];
+    int bytesLeft, bytesRead, bytesWritten;
     char *dataPtr;
-    
+
     bytesLeft = fileSize;
-    dataPtr = data;
 
     // While we still have bytes/data to write...
     while (bytesLeft > 0)
     {
-        // Write a chunk of data out to the socket
-        bytesWritten = write(ClientInterface::_socketFD, dataPtr, bytesLeft);
+        fileIn.read(data, (bytesLeft < FILE_CHUNK_SIZE) ? bytesLeft : FILE_CHUNK_SIZE);
+        bytesRead = fileIn.gcount();
 
-        // If an error occurred, return failure
-        if (bytesWritten == 0 || bytesWritten == -1)
+        // The file got shorter since its size was sent. The server is now out of sync.
+        if (bytesRead <= 0)
         {
             return false;
         }
 
-        // Move the data pointer up by the number of bytes written
-        dataPtr += bytesWritten;
+        bytesLeft -= bytesRead;
+        dataPtr = data;
+
+        while (bytesRead > 0)
+        {
+            // Write a chunk of data out to the socket
+            bytesWritten = write(fd, dataPtr, bytesRead);
+
+            // If an error occurred, return failure
+            if (bytesWritten == 0 || bytesWritten == -1)
+            {
+                return false;
+            }
 
-        // Reduce the number of bytes remaining by the number of bytes written
-        bytesLeft -= bytesWritten;
+            // Move the data pointer up by the number of bytes written
+            dataPtr += bytesWritten;
+
+            // Reduce the number of bytes remaining by the number of bytes written
+            bytesRead -= bytesWritten;
+        }
     }
-   
-    delete[] data;
 
     return true;
 }
 
+
+ResponseFuture::ResponseFuture() :
+    _sequenceNumber(0),
+    _isValid(false)
+{
+}
+
+bool ResponseFuture::isValid() const
+{
+    return _isValid;
+}
+
+bool ResponseFuture::isReady()
+{
+    return ClientInterface::_isResponseReady(*this);
+}
+
+bool ResponseFuture::getInteger(int &value)
+{
+    return ClientInterface::readIntegerFromServer(*this, value);
+}
+
+bool ResponseFuture::get(std::string &response)
+{
+    return ClientInterface::_readResponse(*this, response);
+}
+
+
+Command::Command(const char *type) :
+    _hasHandle(false),
+    _handle(0),
+    _hasInteger(false),
+    _integer(0),
+    _numValues(0)
+{
+    strncpy(_type, type, sizeof(_type));
+}
+
+Command& Command::handle(long handle)
+{
+    _hasHandle = true;
+    _handle = handle;
+    return *this;
+}
+
+Command& Command::integer(long value)
+{
+    _hasInteger = true;
+    _integer = value;
+    return *this;
+}
+
+Command& Command::value(float value)
+{
+    if (_numValues < MAX_VALUES)
+        _values[_numValues++] = value;
+    return *this;
+}
+
+Command& Command::filename(const std::string &filename)
+{
+    _filename = filename;
+    return *this;
+}
@@ -14,8 +14,15 @@
 #include <cstdarg>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <map>
+#include <stdint.h>
+#include <poll.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
 #include <netinet/in.h>
 #include <netinet/tcp.h>
 #include <arpa/inet.h>
@@ -24,6 +31,80 @@
 namespace oasclient
 {
 
+/**
+ * @brief Refers to the response of a request that was sent to the server with a sequence number.
+ * Sending the request does not wait for the response, which can be collected later on.
+ */
+class ResponseFuture
+{
+public:
+    /**
+     * Returns true if the request was sent, and its response has not been collected yet.
+     */
+    bool isValid() const;
+
+    /**
+     * Returns true if the response has arrived. This never blocks.
+     */
+    bool isReady();
+
+    /**
+     * Wait for the response, and interpret it as an integer. If it fails, the value is set to -1.
+     * Once the response is collected, this object is no longer valid.
+     */
+    bool getInteger(int &value);
+
+    /**
+     * Wait for the response, and get it as a string. Once the response is collected, this object
+     * is no longer valid.
+     */
+    bool get(std::string &response);
+
+    ResponseFuture();
+
+private:
+    friend class ClientInterface;
+
+    unsigned int _sequenceNumber;
+    bool _isValid;
+};
+
+/**
+ * @brief Describes one message to the server, independently of the protocol that it is sent with.
+ * Parameters are added in the order that the server expects them, e.g.
+ *     Command("SSPO").handle(handle).value(x).value(y).value(z)
+ */
+class Command
+{
+public:
+    /**
+     * Maximum number of floating point values in one command.
+     */
+    enum { MAX_VALUES = 6 };
+
+    /**
+     * Start a command of the given type, which must be the four character message name.
+     */
+    Command(const char *type);
+
+    Command& handle(long handle);
+    Command& integer(long value);
+    Command& value(float value);
+    Command& filename(const std::string &filename);
+
+private:
+    friend class ClientInterface;
+
+    char _type[4];
+    bool _hasHandle;
+    long _handle;
+    bool _hasInteger;
+    long _integer;
+    float _values[MAX_VALUES];
+    unsigned int _numValues;
+    std::string _filename;
+};
+
 /**
  * @brief This class provides the network interface for the client to connect to the server.
  */
@@ -38,12 +119,19 @@ public:
 
     friend class Sound;
     friend class Listener;
+    friend class ResponseFuture;
 
     /**
      * Initialize the connection to the audio server with the specified host location and port.
      */
     static bool initialize(const std::string &host, const unsigned short port);
 
+    /**
+     * Initialize the connection to an audio server on the same machine, through the Unix domain
+     * socket at the given path.
+     */
+    static bool initialize(const std::string &socketPath);
+
     /**
      * Returns true if the client interface is initialized and connected to the server.
      */
@@ -54,12 +142,81 @@ public:
      */
     static bool shutdown();
 
+    /**
+     * Wire protocols that the client can use to talk to the server.
+     */
+    enum Protocol
+    {
+        PROTOCOL_TEXT = 0,
+        PROTOCOL_BINARY = 1
+    };
+
+    /**
+     * Ask the server to switch to the given protocol for the rest of the connection. Every
+     * connection starts out with the text protocol. Responses from the server are always text.
+     * Returns false and stays with the current protocol if the server does not support it.
+     * Do not call this while tagged requests are still outstanding.
+     */
+    static bool setProtocol(Protocol protocol);
+
+    /**
+     * Returns the protocol currently used to write to the server.
+     */
+    static Protocol getProtocol();
+
+    /**
+     * Start collecting commands into a batch, instead of sending them right away. The server
+     * applies all commands of a batch together, within one update, so that e.g. the listener
+     * and all sounds of one frame move at the same time. A batch is sent when endBatch() is
+     * called, when it gets too large to fit in one batch, or before waiting on any response from
+     * the server.
+     */
+    static bool beginBatch();
+
+    /**
+     * Send the commands that were collected since beginBatch(), and stop collecting commands.
+     */
+    static bool endBatch();
+
+    /**
+     * Ask the server for a datagram (UDP) channel, for position, velocity and orientation
+     * updates of sounds and the listener. Datagrams are not held up behind other traffic on the
+     * connection, but may be lost or dropped when they arrive late, so only state where the
+     * newest value is all that matters should be sent this way. Returns false if the server
+     * does not offer a datagram channel. Do not call this while tagged requests are outstanding.
+     */
+    static bool openDatagramChannel();
+
+    /**
+     * Returns true if the datagram channel is open.
+     */
+    static bool isDatagramChannelOpen();
+
+    /**
+     * Ask the server for a ring in shared memory, and write every command into it from now on,
+     * instead of to the connection. This saves a system call per write in the common case, while
+     * keeping the commands in order. Only available when connected through a Unix domain socket.
+     * Files are then always sent over separate transfer connections. Returns false if the server
+     * does not offer a ring. Do not call this while tagged requests are outstanding.
+     */
+    static bool openSharedMemoryChannel();
+
+    /**
+     * Returns true if commands are written into a shared memory ring.
+     */
+    static bool isSharedMemoryChannelOpen();
+
 protected:
     /**
      * Write data to the server, using a format similar to the printf() family of functions.
      */
     static bool writeToServer(const char *format, ...);
 
+    /**
+     * Write a command to the server, using the current protocol.
+     */
+    static bool writeToServer(const Command &command);
+
     /**
      * Read data from the server. Data and number of bytes are returned by reference via the
      * function parameters. If successful, the caller is responsible for freeing the data that
@@ -72,13 +229,137 @@ protected:
      */
     static bool readIntegerFromServer(int &value);
 
+    /**
+     * Write a request to the server, tagged with a new sequence number, using a format similar to
+     * the printf() family of functions. The server keeps reading from this client while it works
+     * on the request, and tags the response with the same sequence number. The response can be
+     * collected through the future at any later point.
+     *
+     * Responses to untagged requests are not tagged, so do not use readFromServer() or
+     * readIntegerFromServer() while tagged requests are still outstanding.
+     */
+    static bool writeRequestToServer(ResponseFuture &future, const char *format, ...);
+
+    /**
+     * Write a command to the server as a request tagged with a new sequence number, using the
+     * current protocol. See above.
+     */
+    static bool writeRequestToServer(ResponseFuture &future, const Command &command);
+
+    /**
+     * Write a state update to the server over the datagram channel. Falls back to writeToServer()
+     * if the channel is not open. While a batch is being collected, the updates are collected
+     * into as few datagrams as possible, and sent at the end of the batch.
+     */
+    static bool writeDatagramToServer(const Command &command);
+
+    /**
+     * Read the integer response to a request that was written with writeRequestToServer(),
+     * waiting for it if needed. Responses to other requests that arrive first are kept until
+     * they are collected. If it fails, the value is set to -1.
+     */
+    static bool readIntegerFromServer(ResponseFuture &future, int &value);
+
     /**
      * Transfer the file with the given path and filename to the server.
      */
     static bool sendFile(const std::string &sPath, const std::string &sFilename);
 
+    /**
+     * Transfer the file with the given path and filename to the server, to be cached by its
+     * content hash instead of its name. The hash must come from getContentHash().
+     */
+    static bool sendFileContent(const std::string &sPath, const std::string &sFilename,
+                                const std::string &hash);
+
+    /**
+     * Compute the SHA-256 content hash of the file with the given path and filename. The
+     * server can look up files that it has cached by this hash. Hashes are remembered until the
+     * file's size or modification time changes.
+     */
+    static bool getContentHash(const std::string &sPath, const std::string &sFilename,
+                               std::string &hash);
+
 private:
+    enum
+    {
+        BINARY_FLAG_SEQUENCE_NUMBER = 0x0001,
+        SETUP_RESPONSE_TIMEOUT_MS = 2000,
+        MAX_BATCH_SIZE = PACKET_SIZE * 3,
+        DATAGRAM_HEADER_SIZE = 12,
+        MAX_DATAGRAM_SIZE = 1400,
+        FILE_CHUNK_SIZE = 64 * 1024,
+        RING_MAGIC = 0x5253414f,
+        RING_DATA_OFFSET = 256,
+        RING_FULL_TIMEOUT_MS = 2000
+    };
+
+    // Must match the layout of the shared memory ring on the server
+    struct RingHeader
+    {
+        uint32_t magic;
+        uint32_t capacity;
+        uint32_t writeIndex __attribute__((aligned(64)));
+        uint32_t readIndex __attribute__((aligned(64)));
+        uint32_t isServerSleeping;
+    };
+
+    struct ContentHash
+    {
+        off_t size;
+        time_t modificationTime;
+        std::string hash;
+    };
+
     static int _socketFD;
+    static struct sockaddr_storage _serverAddress;
+    static socklen_t _serverAddressLength;
+    static Protocol _protocol;
+
+    static bool _isBatching;
+    static std::string _batchData;
+
+    static int _datagramFD;
+    static unsigned int _datagramSession;
+    static unsigned int _datagramKey;
+    static unsigned int _nextDatagramSequence;
+    static std::string _datagramData;
+
+    // Key for attaching transfer connections to this session. 0 until it is asked for, and -1
+    // if the server does not support transfer connections.
+    static int _transferKey;
+
+    static RingHeader *_ring;
+    static char *_ringData;
+    static size_t _ringMappedSize;
+    static int _ringWakeupFD;
+
+    static unsigned int _nextSequenceNumber;
+    static std::string _taggedData;
+    static std::map<unsigned int, std::string> _taggedResponses;
+
+    static std::map<std::string, ContentHash> _contentHashes;
+
+    static bool _writeToServer(const char *tag, const char *format, va_list args);
+    static bool _writeCommand(const Command &command, bool isTagged, unsigned int sequenceNumber);
+    static bool _write(const char *data, size_t count);
+    static bool _send(const char *data, size_t count);
+    static bool _writeToRing(const char *data, size_t count);
+    static bool _connect(const struct sockaddr *address, socklen_t addressLength, int &socketFD);
+    static void _closeSharedMemoryChannel();
+    static bool _flushBatch();
+    static bool _flushDatagram();
+    static bool _waitForSetupResponse();
+    static bool _sendFile(const Command &command, const std::string &sFilePath, int fileSize);
+    static int  _openTransferConnection();
+    static bool _sendFileOverTransferConnection(int transferFD, const Command &command,
+                                                const std::string &sFilePath, int fileSize);
+    static bool _writeFile(int fd, const std::string &sFilePath, int fileSize);
+    static int  _encodeText(const Command &command, bool isTagged, unsigned int sequenceNumber, char *buf);
+    static int  _encodeBinary(const Command &command, bool isTagged, unsigned int sequenceNumber, char *buf);
+    static bool _isResponseReady(const ResponseFuture &future);
+    static bool _readResponse(ResponseFuture &future, std::string &response);
+    static bool _receiveTaggedResponses(bool block);
 
 };
 
@@ -17,7 +17,7 @@ Listener& Listener::getInstance()
 
 bool Listener::setGain(float gain)
 {
-    bool result = ClientInterface::writeToServer("GAIN %f", gain);
+    bool result = ClientInterface::writeToServer(Command("GAIN").value(gain));
     if (result)
     {
         _gain = gain;
@@ -28,7 +28,7 @@ bool Listener::setGain(float gain)
 
 bool Listener::setPosition(float x, float y, float z)
 {
-    bool result = ClientInterface::writeToServer("SLPO %f %f %f", x, y, z);
+    bool result = _writeUpdate(Command("SLPO").value(x).value(y).value(z));
     if (result)
     {
         _posX = x;
@@ -39,9 +39,19 @@ bool Listener::setPosition(float x, float y, float z)
 }
 
 
+void Listener::setDatagramUpdates(bool enabled)
+{
+    _usesDatagramUpdates = enabled;
+}
+
+bool Listener::usesDatagramUpdates() const
+{
+    return _usesDatagramUpdates;
+}
+
 bool Listener::setVelocity(float x, float y, float z)
 {
-    bool result = ClientInterface::writeToServer("SLVE %f %f %f", x, y, z);
+    bool result = ClientInterface::writeToServer(Command("SLVE").value(x).value(y).value(z));
     if (result)
     {
         _velX = x;
@@ -55,8 +65,8 @@ bool Listener::setVelocity(float x, float y, float z)
 bool Listener::setOrientation(float atX, float atY, float atZ,
         float upX, float upY, float upZ)
 {
-    bool result = ClientInterface::writeToServer("SLOR %f %f %f %f %f %f",
-                                        atX, atY, atZ, upX, upY, upZ);
+    bool result = _writeUpdate(Command("SLOR").value(atX).value(atY).value(atZ)
+                                              .value(upX).value(upY).value(upZ));
     if (result)
     {
         _atX = atX;
@@ -71,7 +81,7 @@ bool Listener::setOrientation(float atX, float atY, float atZ,
 
 bool Listener::setGlobalRenderingParameters(GlobalRenderingParameter whichParameter, float value)
 {
-    return ClientInterface::writeToServer("PARA %d %f", whichParameter, value);
+    return ClientInterface::writeToServer(Command("PARA").integer(whichParameter).value(value));
 }
 
 bool Listener::setGlobalSpeedOfSound(float speedOfSound)
@@ -136,6 +146,14 @@ float Listener::getGain() const
     return _gain;
 }
 
+bool Listener::_writeUpdate(const Command &command)
+{
+    if (_usesDatagramUpdates)
+        return ClientInterface::writeDatagramToServer(command);
+    else
+        return ClientInterface::writeToServer(command);
+}
+
 // private constructor
 Listener::Listener()
 {
@@ -156,5 +174,7 @@ Listener::Listener()
     _atX = 0;
     _atY = 0;
     _atZ = -1;
+
+    _usesDatagramUpdates = false;
 }
 
@@ -47,6 +47,17 @@ public:
      */
     bool setPosition(float x, float y, float z);
 
+    /**
+     * Send position and orientation updates of the listener over the datagram channel, if it is
+     * open. See ClientInterface::openDatagramChannel(). Off by default.
+     */
+    void setDatagramUpdates(bool enabled);
+
+    /**
+     * Check if position and orientation updates of the listener are sent over the datagram channel
+     */
+    bool usesDatagramUpdates() const;
+
     /**
      * Modify the listener's velocity. Default is <0, 0, 0>. Note that this is ONLY used for
      * doppler effect calculations, and does not cause the position to be updated.
@@ -168,6 +179,9 @@ private:
     float _atX, _atY, _atZ;
     float _upX, _upY, _upZ;
     float _gain;
+    bool _usesDatagramUpdates;
+
+    bool _writeUpdate(const Command &command);
 
 };
 }
@@ -44,11 +44,26 @@ bool Sound::initialize(const std::string &path, const std::string &filename)
         _filename = filename;
     }
 
-    _getHandleFromServer();
+    // Look the file up by its contents first, so that it is only uploaded if the server does not
+    // have it yet, and so that files with the same name but different contents do not collide
+    std::string hash;
 
+    if (ClientInterface::getContentHash(_path, _filename, hash))
+    {
+        _getHandleForContent(hash);
+
+        if (-1 == _handle && ClientInterface::sendFileContent(_path, _filename, hash))
+        {
+            _getHandleForContent(hash);
+        }
+    }
+
+    // Else look it up by name. The file may only exist on the server.
     if (-1 == _handle)
     {
-        if (ClientInterface::sendFile(_path, _filename))
+        _getHandleFromServer();
+
+        if (-1 == _handle && ClientInterface::sendFile(_path, _filename))
         {
             _getHandleFromServer();
         }
@@ -65,10 +80,10 @@ bool Sound::initialize(enum WaveformType waveType, float frequency, float phaseS
 {
     _reset();
 
-    if (ClientInterface::writeToServer("WAVE %d, %f, %f, %f", waveType,
-            frequency,
-            phaseShift,
-            durationInSeconds))
+    if (ClientInterface::writeToServer(Command("WAVE").integer(waveType)
+                                                    .value(frequency)
+                                                    .value(phaseShift)
+                                                    .value(durationInSeconds)))
     {
         ClientInterface::readIntegerFromServer(_handle);
     }
@@ -106,7 +121,7 @@ bool Sound::play(float seconds)
         setPlaybackPosition(seconds);
     }
 
-    bool result = ClientInterface::writeToServer("PLAY %ld", _handle);
+    bool result = ClientInterface::writeToServer(Command("PLAY").handle(_handle));
     if (result)
         _state = ST_PLAYING;
 
@@ -118,7 +133,7 @@ bool Sound::stop()
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("STOP %ld", _handle);
+    bool result = ClientInterface::writeToServer(Command("STOP").handle(_handle));
     if (result)
         _state = ST_STOPPED;
 
@@ -130,7 +145,7 @@ bool Sound::pause()
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("PAUS %ld", _handle);
+    bool result = ClientInterface::writeToServer(Command("PAUS").handle(_handle));
     if (result)
         _state = ST_PAUSED;
 
@@ -142,7 +157,7 @@ bool Sound::setPlaybackPosition(float seconds)
     if (!isValid())
         return false;
 
-    return ClientInterface::writeToServer("SSEC %ld %f", _handle, seconds);
+    return ClientInterface::writeToServer(Command("SSEC").handle(_handle).value(seconds));
 }
 
 bool Sound::setLoop(bool loop)
@@ -150,7 +165,7 @@ bool Sound::setLoop(bool loop)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSLP %ld %ld", _handle, loop ? 1 : 0);
+    bool result = ClientInterface::writeToServer(Command("SSLP").handle(_handle).integer(loop ? 1 : 0));
 
     if (result)
         _isLooping = loop;
@@ -163,7 +178,7 @@ bool Sound::setGain(float gain)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSVO %ld %f", _handle, gain);
+    bool result = ClientInterface::writeToServer(Command("SSVO").handle(_handle).value(gain));
 
     if (result)
         _gain = gain;
@@ -176,7 +191,7 @@ bool Sound::setPosition(float x, float y, float z)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSPO %ld %f %f %f", _handle, x, y, z);
+    bool result = _writeUpdate(Command("SSPO").handle(_handle).value(x).value(y).value(z));
 
     if (result)
     {
@@ -192,7 +207,7 @@ bool Sound::setDirection(float angle)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSDI %ld %f", _handle, angle);
+    bool result = ClientInterface::writeToServer(Command("SSDI").handle(_handle).value(angle));
 
     if (result)
     {
@@ -208,7 +223,7 @@ bool Sound::setDirection(float x, float y, float z)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSDI %ld %f %f %f", _handle, x, y, z);
+    bool result = ClientInterface::writeToServer(Command("SSDI").handle(_handle).value(x).value(y).value(z));
 
     if (result)
     {
@@ -219,12 +234,22 @@ bool Sound::setDirection(float x, float y, float z)
     return result;
 }
 
+void Sound::setDatagramUpdates(bool enabled)
+{
+    _usesDatagramUpdates = enabled;
+}
+
+bool Sound::usesDatagramUpdates() const
+{
+    return _usesDatagramUpdates;
+}
+
 bool Sound::setVelocity(float x, float y, float z)
 {   
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SSVE %ld %f %f %f", _handle, x, y, z);
+    bool result = _writeUpdate(Command("SSVE").handle(_handle).value(x).value(y).value(z));
 
     if (result)
     {
@@ -240,7 +265,7 @@ bool Sound::setPitch(float pitchFactor)
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("SPIT %ld %f", _handle, pitchFactor);
+    bool result = ClientInterface::writeToServer(Command("SPIT").handle(_handle).value(pitchFactor));
 
     if (result)
     {
@@ -263,8 +288,9 @@ bool Sound::fade(float finalGain, float durationInSeconds)
     _fadeStartTime.update(Time::OAS_CLOCK_MONOTONIC);
     _fadeEndTime = _fadeStartTime + Time(_fadeDuration);
 
-    return ClientInterface::writeToServer("FADE %ld %f %f",
-                                            _handle, finalGain, durationInSeconds);
+    return ClientInterface::writeToServer(Command("FADE").handle(_handle)
+                                                            .value(finalGain)
+                                                            .value(durationInSeconds));
 }
 
 bool Sound::setRenderingParameter(RenderingParameter whichParameter, float value)
@@ -272,7 +298,7 @@ bool Sound::setRenderingParameter(RenderingParameter whichParameter, float value
     if (!isValid())
         return false;
 
-    return ClientInterface::writeToServer("SPAR %ld %ld %f", _handle, whichParameter, value);
+    return ClientInterface::writeToServer(Command("SPAR").handle(_handle).integer(whichParameter).value(value));
 }
 
 bool Sound::updateState()
@@ -280,29 +306,52 @@ bool Sound::updateState()
     if (!isValid())
         return false;
 
-    bool result = ClientInterface::writeToServer("STAT %ld", _handle);
-    
-    if (result)
+    bool result;
+    int state;
+
+    // Collect the answer to an earlier request, if there is one
+    if (_stateRequest.isValid())
+    {
+        result = _stateRequest.getInteger(state);
+    }
+    else
     {
-        int state;
+        result = ClientInterface::writeToServer(Command("STAT").handle(_handle))
+                 && ClientInterface::readIntegerFromServer(state);
+    }
 
-        result = ClientInterface::readIntegerFromServer(state);
-        if (result)
+    if (result)
+    {
+        if (state <= ST_UNKNOWN || state > ST_LOADING)
         {
-            if (state <= ST_UNKNOWN || state > ST_DELETED)
-            {
-                _state = ST_UNKNOWN;
-            }
-            else
-            {
-                _state = (Sound::SoundState) state;
-            }
+            _state = ST_UNKNOWN;
+        }
+        else
+        {
+            _state = (Sound::SoundState) state;
         }
     }
 
     return result;
 }
 
+bool Sound::requestStateUpdate()
+{
+    if (!isValid())
+        return false;
+
+    // There is already a request on the way
+    if (_stateRequest.isValid())
+        return true;
+
+    return ClientInterface::writeRequestToServer(_stateRequest, Command("STAT").handle(_handle));
+}
+
+bool Sound::isStateUpdateReady()
+{
+    return _stateRequest.isReady();
+}
+
 Sound::SoundState Sound::getState() const
 {
     return _state;
@@ -400,6 +449,7 @@ void Sound::_init()
     _pitch = 1;
     _gain = 1;
     _isLooping = false;
+    _usesDatagramUpdates = false;
     _state = ST_UNKNOWN;
     _fadeDuration = 0;
     _fadeEndTime.reset();
@@ -410,8 +460,14 @@ void Sound::_init()
 
 void Sound::_reset()
 {
+    int ignored;
+
+    // Collect the answer to an outstanding state request, so that it is not left behind
+    if (_stateRequest.isValid())
+        _stateRequest.getInteger(ignored);
+
     if (isValid())
-        ClientInterface::writeToServer("RHDL %ld", _handle);
+        ClientInterface::writeToServer(Command("RHDL").handle(_handle));
 
     _path.clear();
     _filename.clear();
@@ -421,12 +477,28 @@ void Sound::_reset()
 
 void Sound::_getHandleFromServer()
 {
-    if (ClientInterface::writeToServer("GHDL %s", _filename.c_str()))
+    if (ClientInterface::writeToServer(Command("GHDL").filename(_filename)))
+    {
+        ClientInterface::readIntegerFromServer(_handle);
+    }
+}
+
+void Sound::_getHandleForContent(const std::string &hash)
+{
+    if (ClientInterface::writeToServer(Command("GHDC").filename(hash)))
     {
         ClientInterface::readIntegerFromServer(_handle);
     }
 }
 
+bool Sound::_writeUpdate(const Command &command)
+{
+    if (_usesDatagramUpdates)
+        return ClientInterface::writeDatagramToServer(command);
+    else
+        return ClientInterface::writeToServer(command);
+}
+
 void Sound::_splitFilename(const std::string &joinedFilePath)
 {
     size_t pathPos = joinedFilePath.find_last_of('/');
@@ -57,7 +57,8 @@ public:
         ST_PLAYING = 2, /**< Source is playing or has finished playing all the way through */
         ST_PAUSED =  3, /**< Source is paused at a specific point, and playback will resume from here */
         ST_STOPPED = 4, /**< Source is stopped and playback will resume from the beginning */
-        ST_DELETED = 5  /**< Source is in the process of being deleted, or was just deleted */
+        ST_DELETED = 5, /**< Source is in the process of being deleted, or was just deleted */
+        ST_LOADING = 6  /**< The file of the source is still being loaded by the server */
     };
 
     /**
@@ -246,6 +247,18 @@ public:
      */
     bool setDirection(float angle);
 
+    /**
+     * Send position and velocity updates of this sound over the datagram channel, if it is open.
+     * See ClientInterface::openDatagramChannel(). Off by default, and reset when the sound is
+     * reinitialized.
+     */
+    void setDatagramUpdates(bool enabled);
+
+    /**
+     * Check if position and velocity updates of this sound are sent over the datagram channel
+     */
+    bool usesDatagramUpdates() const;
+
     /**
      * Set the velocity of the sound source. The velocity is used ONLY for the doppler effect
      * calculations. The server does not internally update the position based on the specify the
@@ -276,10 +289,24 @@ public:
     bool setRenderingParameter(RenderingParameter whichParameter, float value);
 
     /**
-     * Update the current state of the sound source by asking the server.
+     * Update the current state of the sound source by asking the server. If requestStateUpdate()
+     * was used first, this collects the answer to that request instead of asking again.
      */
     bool updateState();
 
+    /**
+     * Ask the server for the current state of the sound source, without waiting for the answer.
+     * Other commands can be sent in the meantime, and the answer is collected by the next call
+     * to updateState().
+     */
+    bool requestStateUpdate();
+
+    /**
+     * Check if the answer to requestStateUpdate() has arrived, so that updateState() will not
+     * have to wait for it.
+     */
+    bool isStateUpdateReady();
+
     /**
      * Get the state of the sound source, as stored locally in this object.
      * NOTE: This does not communicate with the server to check the state.
@@ -326,13 +353,16 @@ private:
     void _init();
     void _reset();
     void _getHandleFromServer();
+    void _getHandleForContent(const std::string &hash);
     void _splitFilename(const std::string &joinedFilepath);
+    bool _writeUpdate(const Command &command);
 
     int _handle;
     std::string _filename;
     std::string _path;
 
     SoundState _state;
+    ResponseFuture _stateRequest;
 
     float _posX, _posY, _posZ;
     float _dirX, _dirY, _dirZ;
@@ -341,6 +371,7 @@ private:
     float _pitch;
     float _gain;
     bool _isLooping;
+    bool _usesDatagramUpdates;
 
     float _fadeFinalGain, _fadeInitialGain, _fadeGainDiff, _fadeDuration;
     Time _fadeStartTime;
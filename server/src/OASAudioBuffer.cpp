@@ -9,26 +9,23 @@ AudioBuffer::AudioBuffer(const std::string& filename)
 
     if (!filename.empty())
     {
-        FileHandler fileHandler;
-        int fileSize;
-        void *data;
+        PCMCache::Sound sound;
 
-        data = fileHandler.readFile(filename, fileSize);
-
-        if (data)
+        if (PCMCache::load(filename, sound))
         {
-            _handle = alutCreateBufferFromFileImage(data, fileSize);
-
-            if (AL_NONE != _handle)
-            {
-                _filename = std::string(filename);
-            }
-
-            delete[] (char *) data;
+            _create(filename, sound.getFormat(), sound.getData(), sound.getSize(),
+                    sound.getFrequency());
         }
     }
 }
 
+AudioBuffer::AudioBuffer(const std::string& filename, ALenum format, const ALvoid *data,
+                         ALsizei size, ALsizei frequency)
+{
+    _init();
+    _create(filename, format, data, size, frequency);
+}
+
 AudioBuffer::AudioBuffer(ALint waveShape, ALfloat frequency, ALfloat phase, ALfloat duration)
 {
     _init();
@@ -56,12 +53,11 @@ AudioBuffer::AudioBuffer(ALint waveShape, ALfloat frequency, ALfloat phase, ALfl
             break;
     }
 
-    // If buffer generated successfully, generate a unique filename for this buffer
+    // If buffer generated successfully, name it after the waveform
     if (AL_NONE != _handle)
     {
-        char buffer[250];
-        sprintf(buffer, "wave: %i, %f, %f, %f", waveShape, frequency, phase, duration);
-        _filename = std::string(buffer);
+        _filename = getWaveformFilename(waveShape, frequency, phase, duration);
+        _readSize();
     }
 }
 
@@ -83,6 +79,45 @@ AudioBuffer::~AudioBuffer()
 void AudioBuffer::_init()
 {
     _handle = AL_NONE;
+    _size = 0;
+}
+
+// private
+void AudioBuffer::_create(const std::string& filename, ALenum format, const ALvoid *data,
+                          ALsizei size, ALsizei frequency)
+{
+    if (!data)
+        return;
+
+    alGetError();
+    alGenBuffers(1, &_handle);
+
+    if (AL_NO_ERROR != alGetError())
+    {
+        _handle = AL_NONE;
+        return;
+    }
+
+    alBufferData(_handle, format, data, size, frequency);
+
+    if (AL_NO_ERROR != alGetError())
+    {
+        alDeleteBuffers(1, &_handle);
+        _handle = AL_NONE;
+        return;
+    }
+
+    _filename = filename;
+    _readSize();
+}
+
+// private
+void AudioBuffer::_readSize()
+{
+    ALint size = 0;
+
+    alGetBufferi(_handle, AL_SIZE, &size);
+    _size = (0 < size) ? size : 0;
 }
 
 // public
@@ -102,3 +137,18 @@ bool AudioBuffer::isValid() const
 {
     return (_handle != AL_NONE);
 }
+
+// public
+unsigned int AudioBuffer::getSize() const
+{
+    return _size;
+}
+
+// static, public
+std::string AudioBuffer::getWaveformFilename(ALint waveShape, ALfloat frequency, ALfloat phase,
+                                             ALfloat duration)
+{
+    char buffer[250];
+    sprintf(buffer, "wave: %i, %f, %f, %f", waveShape, frequency, phase, duration);
+    return std::string(buffer);
+}
@@ -10,6 +10,7 @@
 #include <string>
 #include <AL/alut.h>
 #include "OASFileHandler.h"
+#include "OASPCMCache.h"
 
 namespace oas
 {
@@ -36,12 +37,31 @@ public:
      */
     bool isValid() const;
 
+    /**
+     * @brief Get the number of bytes of sound data in the buffer
+     */
+    unsigned int getSize() const;
+
+    /**
+     * @brief Get the filename that a buffer with the given waveform is associated with. Buffers
+     *        with the same waveform parameters have the same name.
+     */
+    static std::string getWaveformFilename(ALint waveShape, ALfloat frequency, ALfloat phase,
+                                           ALfloat duration);
+
     /**
      * @brief Creates a new audio buffer based on the given file
      * @param filename
      */
     AudioBuffer(const std::string& filename);
 
+    /**
+     * @brief Creates a new audio buffer from sound data that was already decoded from the file
+     * @param filename Name of the file that the data was decoded from
+     */
+    AudioBuffer(const std::string& filename, ALenum format, const ALvoid *data, ALsizei size,
+                ALsizei frequency);
+
     /**
      * @brief Create a new buffer based on the specified waveform.
      * @param waveShape Sine        -> waveShape = 1
@@ -60,9 +80,13 @@ public:
 
 private:
     void _init();
+    void _create(const std::string& filename, ALenum format, const ALvoid *data, ALsizei size,
+                 ALsizei frequency);
+    void _readSize();
 
     ALuint _handle;
     std::string _filename;
+    unsigned int _size;
 };
 
 }
@@ -66,14 +66,27 @@ bool AudioHandler::initialize(std::string const& deviceString)
         }
     }
 
+    // Every sound source plays through one of the sources in the pool
+    if (!SourcePool::initialize(alcGetContextsDevice(alcGetCurrentContext())))
+    {
+        if (0 < deviceString.length())
+        {
+            alcMakeContextCurrent(NULL);
+            alcDestroyContext(AudioHandler::_context);
+            alcCloseDevice(AudioHandler::_device);
+        }
+        alutExit();
+        return false;
+    }
+
     if (0 < deviceString.length())
         oas::Logger::logf("AudioHandler initialized with device \"%s\"", deviceString.c_str());
     else
         oas::Logger::logf("AudioHandler initialized! Using system default device to drive sound.");
 
     AudioHandler::_deviceString = deviceString;
-    AudioHandler::_recentSource = NULL;
     _setRecentlyModifiedAudioUnit(AudioListener::getInstance());
+    _initializeDeferredUpdates();
 
     return true;
 }
@@ -81,34 +94,17 @@ bool AudioHandler::initialize(std::string const& deviceString)
 // public
 void AudioHandler::release()
 {
-    // Release the sources
-    SourceMapIterator sIter;
+    // Release the sources of every session
+    reset();
 
-    for (sIter = _sourceMap.begin(); sIter != _sourceMap.end(); sIter++)
-    {
-        if (sIter->second)
-            deleteSource(sIter->second);
-    }
-    
-    _sourceMap.clear();
-    oas::AudioSource::resetSources();
+    // Loads that are still running are thrown away when they finish
+    _loads.clear();
+    _preloads.clear();
 
     // Release the buffers
-    BufferMapIterator bIter;
-
-    for (bIter = _bufferMap.begin(); bIter != _bufferMap.end(); bIter++)
-    {
-        if (bIter->second)
-            delete bIter->second;
-    }
+    _bufferCache.clear();
 
-    _bufferMap.clear();
-
-    AudioListener::getInstance()->setGain(1);
-    AudioListener::getInstance()->setPosition(0, 0, 0);
-    AudioListener::getInstance()->setOrientation(0, 0, -1, 0, 1, 0);
-    AudioListener::getInstance()->setVelocity(0, 0, 0);
-    _setRecentlyModifiedAudioUnit(AudioListener::getInstance());
+    SourcePool::release();
 
     if (0 < AudioHandler::_deviceString.length())
     {
@@ -125,34 +121,262 @@ void AudioHandler::release()
 }
 
 // public
-ALuint AudioHandler::getBuffer(const std::string& filename)
+void AudioHandler::reset()
 {
-    if (filename.empty())
+    // releaseSession() changes the map, so the sessions are collected first
+    std::vector<unsigned int> sessions;
+    SessionSourceMapIterator sessionIter;
+
+    for (sessionIter = _sessionSourceMap.begin(); sessionIter != _sessionSourceMap.end(); sessionIter++)
+        sessions.push_back(sessionIter->first);
+
+    for (unsigned int i = 0; i < sessions.size(); i++)
+        releaseSession(sessions[i]);
+
+    // Don't leave the context suspended
+    processUpdates();
+
+    // The defaults of a new OpenAL context
+    AudioListener::getInstance()->setGain(1);
+    AudioListener::getInstance()->setPosition(0, 0, 0);
+    AudioListener::getInstance()->setOrientation(0, 0, -1, 0, 1, 0);
+    AudioListener::getInstance()->setVelocity(0, 0, 0);
+    AudioListener::getInstance()->setSpeedOfSound(343.3f);
+    AudioListener::getInstance()->setDopplerFactor(1);
+    _setRecentlyModifiedAudioUnit(AudioListener::getInstance());
+
+    _defaultRolloff = 1;
+    _defaultReferenceDistance = 1;
+}
+
+// private
+void AudioHandler::_addActiveSource(AudioSource *source)
+{
+    if (source->_isInActiveList || !source->needsUpdates())
+        return;
+
+    source->_previousActive = NULL;
+    source->_nextActive = _activeSources;
+
+    if (_activeSources)
+        _activeSources->_previousActive = source;
+
+    _activeSources = source;
+    source->_isInActiveList = true;
+}
+
+// private
+void AudioHandler::_removeActiveSource(AudioSource *source)
+{
+    if (!source->_isInActiveList)
+        return;
+
+    if (source->_previousActive)
+        source->_previousActive->_nextActive = source->_nextActive;
+    else
+        _activeSources = source->_nextActive;
+
+    if (source->_nextActive)
+        source->_nextActive->_previousActive = source->_previousActive;
+
+    source->_previousActive = source->_nextActive = NULL;
+    source->_isInActiveList = false;
+}
+
+// private
+void AudioHandler::_assignVoices()
+{
+    Time now;
+    now.update(Time::OAS_CLOCK_MONOTONIC);
+
+    if (!(now >= _nextVoiceAssignment))
+        return;
+
+    _nextVoiceAssignment = now + Time(VOICE_ASSIGNMENT_INTERVAL);
+
+    const AudioListener *listener = AudioListener::getInstance();
+
+    // Every source with a voice is active, so only the active sources compete
+    _voiceCandidates.clear();
+
+    for (AudioSource *source = _activeSources; source; source = source->_nextActive)
     {
-        return AL_NONE;
-    }
+        float audibility = source->getAudibility(listener);
 
-    // See if buffer with that filename exists already
-    BufferMapIterator iterator = _bufferMap.find(filename);
+        if (source->hasVoice())
+            audibility *= VOICE_HYSTERESIS;
+        // Sources that can not be heard anyway do not need a voice
+        else if (0 >= audibility)
+            continue;
+
+        _voiceCandidates.push_back(VoiceCandidate(audibility, source));
+    }
 
-    // If something was found 
-    if (_bufferMap.end() != iterator)
+    // Take the voices away from the least audible sources first, so that they are free for the
+    // most audible ones
+    if (_voiceCandidates.size() > SourcePool::getSize())
     {
-        // If the found buffer was valid
-        if(iterator->second && iterator->second->isValid())
+        std::nth_element(_voiceCandidates.begin(),
+                         _voiceCandidates.begin() + SourcePool::getSize(),
+                         _voiceCandidates.end(),
+                         std::greater<VoiceCandidate>());
+
+        for (unsigned int i = SourcePool::getSize(); i < _voiceCandidates.size(); i++)
         {
-            return iterator->second->getHandle();
+            AudioSource *source = _voiceCandidates[i].second;
+
+            if (source->hasVoice())
+            {
+                if (AudioSource::ST_PLAYING == source->getState())
+                    _voiceTransferCount++;
+
+                source->_releaseVoice();
+            }
         }
-        // Else remove the previous entry
-        else
+
+        _voiceCandidates.resize(SourcePool::getSize());
+    }
+
+    for (unsigned int i = 0; i < _voiceCandidates.size(); i++)
+    {
+        if (!_voiceCandidates[i].second->hasVoice())
+            _voiceCandidates[i].second->_acquireVoice();
+    }
+}
+
+// private
+void AudioHandler::_initializeDeferredUpdates()
+{
+    _alDeferUpdatesSOFT = NULL;
+    _alProcessUpdatesSOFT = NULL;
+    _isDeferringUpdates = false;
+
+    if (alIsExtensionPresent("AL_SOFT_deferred_updates"))
+    {
+        _alDeferUpdatesSOFT = (DeferUpdatesFunction) alGetProcAddress("alDeferUpdatesSOFT");
+        _alProcessUpdatesSOFT = (ProcessUpdatesFunction) alGetProcAddress("alProcessUpdatesSOFT");
+    }
+
+    if (_alDeferUpdatesSOFT && _alProcessUpdatesSOFT)
+        oas::Logger::logf("AudioHandler - Batches are applied with AL_SOFT_deferred_updates");
+    else
+        oas::Logger::logf("AudioHandler - Batches are applied by suspending the context");
+}
+
+// public
+void AudioHandler::deferUpdates()
+{
+    if (_isDeferringUpdates)
+        return;
+
+    if (_alDeferUpdatesSOFT && _alProcessUpdatesSOFT)
+        _alDeferUpdatesSOFT();
+    else
+        alcSuspendContext(alcGetCurrentContext());
+
+    _isDeferringUpdates = true;
+}
+
+// public
+void AudioHandler::processUpdates()
+{
+    if (!_isDeferringUpdates)
+        return;
+
+    if (_alDeferUpdatesSOFT && _alProcessUpdatesSOFT)
+        _alProcessUpdatesSOFT();
+    else
+        alcProcessContext(alcGetCurrentContext());
+
+    _isDeferringUpdates = false;
+}
+
+// public
+bool AudioHandler::isDeferringUpdates() const
+{
+    return _isDeferringUpdates;
+}
+
+// public
+unsigned long AudioHandler::getUnchangedUpdateCount() const
+{
+    return AudioSource::getUnchangedUpdateCount()
+           + AudioListener::getInstance()->getUnchangedUpdateCount();
+}
+
+// public
+unsigned long AudioHandler::getVoiceTransferCount() const
+{
+    return _voiceTransferCount;
+}
+
+// public
+void AudioHandler::setSession(unsigned int session)
+{
+    if (session == _session)
+        return;
+
+    _session = session;
+    _sourceTable = &_sessionSourceMap[_session];
+}
+
+// public
+void AudioHandler::releaseSession(unsigned int session)
+{
+    SessionSourceMapIterator sessionIter = _sessionSourceMap.find(session);
+
+    if (_sessionSourceMap.end() != sessionIter)
+    {
+        for (unsigned int i = 0; i < sessionIter->second.getSlotCount(); i++)
         {
-            if (iterator->second)
+            AudioSource *source = sessionIter->second.getSourceAt(i);
+
+            if (!source)
+                continue;
+
+            _removeActiveSource(source);
+
+            if (!source->deleteSource())
             {
-                delete iterator->second;
+                oas::Logger::warnf("AudioHandler - Deletion of sound source failed!");
             }
-            _bufferMap.erase(iterator);
+
+            _bufferCache.removeReference(source->getBuffer());
+
+            // Report the deletion with the next batch of updated sources. The lazy deletion queue
+            // is not trimmed here, so that the pointers stay valid until they have been reported.
+            _releasedSources.push(source);
+            _lazyDeletionQueue.push(source);
         }
+
+        oas::Logger::logf("AudioHandler - Released %u sound source(s) for session %u.",
+                          (unsigned int) sessionIter->second.size(), session);
+
+        _sessionSourceMap.erase(sessionIter);
+    }
+
+    // Fall back to the default namespace if the selected session was released
+    if (session == _session)
+    {
+        _session = 0;
+        _sourceTable = &_sessionSourceMap[_session];
     }
+}
+
+// public
+ALuint AudioHandler::getBuffer(const std::string& filename)
+{
+    if (filename.empty())
+    {
+        return AL_NONE;
+    }
+
+    // See if buffer with that key exists already. Only valid buffers are cached.
+    std::string key = _getBufferKey(filename);
+    AudioBuffer *buffer = _bufferCache.find(key);
+
+    if (buffer)
+        return buffer->getHandle();
 
     // Make a new buffer
     AudioBuffer *newBuffer = new AudioBuffer(filename);
@@ -164,31 +388,112 @@ ALuint AudioHandler::getBuffer(const std::string& filename)
         return AL_NONE;
     }
 
-    _bufferMap.insert(BufferPair(newBuffer->getFilename().c_str(), newBuffer));
+    _bufferCache.insert(key, newBuffer);
     return newBuffer->getHandle();
 }
 
-// private, static
-AudioSource* AudioHandler::_getSource(const ALuint sourceHandle)
+// private
+std::string AudioHandler::_getBufferKey(const std::string& filename)
 {
-    // Short circuit the map lookup. See if handle matches the most recently looked up source
-    if (_recentSource && (sourceHandle == _recentSource->getHandle()))
+    // Buffers are shared by all files with the same contents, if the contents are known.
+    // Else, they are only shared by name.
+    std::string key = ContentIndex::getHashForFile(filename);
+
+    if (key.empty())
+        key = filename;
+
+    return key;
+}
+
+// public
+void AudioHandler::setBufferCacheSize(unsigned long bytes)
+{
+    _bufferCache.setBudget(bytes);
+}
+
+// public
+const BufferCache& AudioHandler::getBufferCache() const
+{
+    return _bufferCache;
+}
+
+// public
+void AudioHandler::setStreamThreshold(unsigned long bytes)
+{
+    _streamThreshold = bytes;
+}
+
+// public
+bool AudioHandler::preloadBuffer(const std::string& filename)
+{
+    FileHandler fileHandler;
+    off_t size = fileHandler.getFileSize(filename);
+
+    if (0 > size)
     {
-        return _recentSource;
+        oas::Logger::warnf("AudioHandler - Could not find \"%s\" to preload", filename.c_str());
+        return false;
     }
 
-    // Else, we have to look through the map
-    SourceMapConstIterator iterator = _sourceMap.find(sourceHandle);
+    // Streamed files are never loaded whole. See createSource().
+    if (_streamThreshold && (unsigned long) size >= _streamThreshold)
+    {
+        AudioStream stream(filename);
 
-    if (_sourceMap.end() != iterator && iterator->second)
+        if (stream.isValid())
+        {
+            oas::Logger::logf("AudioHandler - \"%s\" is streamed, and is not preloaded.",
+                              filename.c_str());
+            return true;
+        }
+    }
+
+    std::string key = _getBufferKey(filename);
+
+    if (_bufferCache.contains(key) || _loads.end() != _loads.find(key))
+        return true;
+
+    if (!LoadHandler::isEnabled())
     {
-        _recentSource = iterator->second;
-        return iterator->second;
+        Time start, end;
+
+        start.update(Time::OAS_CLOCK_MONOTONIC);
+
+        if (AL_NONE == AudioHandler::getBuffer(filename))
+            return false;
+
+        end.update(Time::OAS_CLOCK_MONOTONIC);
+        oas::Logger::logf("AudioHandler - Preloaded \"%s\" in %.1f ms.", filename.c_str(),
+                          (end - start).asDouble() * 1000.0);
+        return true;
     }
-    else
+
+    // A load without sources leaves its buffer in the cache. GHDL for the same file joins it.
+    if (_preloads.empty())
     {
-        return NULL;
+        _preloadStart.update(Time::OAS_CLOCK_MONOTONIC);
+        _preloadCount = 0;
     }
+
+    _preloads.insert(key);
+    _preloadCount++;
+
+    _loads[key];
+    LoadHandler::addLoad(key, filename);
+    return true;
+}
+
+// public
+bool AudioHandler::isLoading() const
+{
+    return !_loads.empty();
+}
+
+// private, static
+AudioSource* AudioHandler::_getSource(const ALuint sourceHandle)
+{
+    // The handle indexes the table of the current session directly
+    return _sourceTable->find(sourceHandle);
 }
 
 // private, static
@@ -215,30 +520,180 @@ const AudioListener* AudioHandler::getListener()
     return AudioListener::getInstance();
 }
 
-void AudioHandler::populateQueueWithUpdatedSources(std::queue <const AudioUnit*> &sources)
+bool AudioHandler::populateQueueWithUpdatedSources(std::queue <const AudioUnit*> &sources)
 {
-    SourceMapIterator iterator;
+    // Sources released along with their session count as updated
+    while (!_releasedSources.empty())
+    {
+        sources.push(_releasedSources.front());
+        _releasedSources.pop();
+    }
+
+    // So do sources whose file has been loaded
+    _finishLoads(&sources);
 
-    for (iterator = _sourceMap.begin(); iterator != _sourceMap.end(); ++iterator)
+    AudioSource *source = _activeSources;
+    bool needsVoices = false;
+
+    while (source)
     {
-        if (!iterator->second)
-            continue;
+        AudioSource *next = source->_nextActive;
+
+        if (source->update())
+        {
+            sources.push(source);
+        }
 
-        if (iterator->second->update())
+        // Sources that are done give their voice back
+        if (!source->needsUpdates())
+        {
+            _removeActiveSource(source);
+            source->_releaseVoice();
+        }
+        else if (!source->hasVoice() && AudioSource::ST_PLAYING == source->getState())
+        {
+            needsVoices = true;
+        }
+
+        source = next;
+    }
+
+    if (needsVoices)
+        _assignVoices();
+
+    // Keep ticking while files are loading, to pick them up as soon as they are done
+    return (NULL != _activeSources || !_loads.empty());
+}
+
+bool AudioHandler::updateSources()
+{
+    // Nobody is interested in released sources without the GUI
+    while (!_releasedSources.empty())
+    {
+        _releasedSources.pop();
+    }
+
+    _finishLoads(NULL);
+
+    AudioSource *source = _activeSources;
+    bool needsVoices = false;
+
+    while (source)
+    {
+        AudioSource *next = source->_nextActive;
+
+        source->update();
+
+        // Sources that are done give their voice back
+        if (!source->needsUpdates())
+        {
+            _removeActiveSource(source);
+            source->_releaseVoice();
+        }
+        else if (!source->hasVoice() && AudioSource::ST_PLAYING == source->getState())
         {
-            sources.push(iterator->second);
+            needsVoices = true;
         }
+
+        source = next;
     }
+
+    if (needsVoices)
+        _assignVoices();
+
+    // See populateQueueWithUpdatedSources()
+    return (NULL != _activeSources || !_loads.empty());
 }
 
-void AudioHandler::updateSources()
+// private
+void AudioHandler::_finishLoads(std::queue<const AudioUnit*> *updatedSources)
 {
-    SourceMapIterator iterator;
+    LoadHandler::Load load;
 
-    for (iterator = _sourceMap.begin(); iterator != _sourceMap.end(); ++iterator)
+    while (LoadHandler::takeFinishedLoad(load))
     {
-        if (iterator->second)
-            iterator->second->update();
+        LoadMapIterator loadIter = _loads.find(load.key);
+
+        // Loads that were requested before the last release are of no use anymore
+        if (_loads.end() == loadIter)
+        {
+            delete load.sound;
+            continue;
+        }
+
+        AudioBuffer *buffer = NULL;
+        bool isFromCache = false;
+
+        if (load.sound)
+        {
+            buffer = new AudioBuffer(load.filename, load.sound->getFormat(), load.sound->getData(),
+                                     load.sound->getSize(), load.sound->getFrequency());
+            isFromCache = load.sound->isFromCache();
+            delete load.sound;
+
+            if (!buffer->isValid())
+            {
+                delete buffer;
+                buffer = NULL;
+            }
+        }
+
+        if (buffer)
+        {
+            _bufferCache.insert(load.key, buffer);
+            oas::Logger::logf("AudioHandler - Loaded \"%s\"%s in %.1f ms, for %u sound source(s).",
+                              load.filename.c_str(), isFromCache ? " from its decoded copy" : "",
+                              load.duration * 1000.0, (unsigned int) loadIter->second.size());
+        }
+        else
+        {
+            oas::Logger::warnf("AudioHandler - Could not create a sound buffer for \"%s\"",
+                               load.filename.c_str());
+        }
+
+        for (unsigned int i = 0; i < loadIter->second.size(); i++)
+        {
+            SessionSourceMapIterator sessionIter = _sessionSourceMap.find(loadIter->second[i].first);
+
+            // The source, or its whole session, may have been released while it was loading
+            if (_sessionSourceMap.end() == sessionIter)
+                continue;
+
+            ALuint handle = loadIter->second[i].second;
+            AudioSource *source = sessionIter->second.find(handle);
+
+            if (!source)
+                continue;
+
+            if (buffer && source->finishLoading(buffer->getHandle()))
+            {
+                _bufferCache.addReference(buffer->getHandle());
+                _addActiveSource(source);
+
+                // A PLAY that arrived while loading takes a free voice right away, like playSource()
+                source->_acquireVoice();
+            }
+            // A source without sound is of no use, so it is deleted. The client finds out with STAT.
+            else
+            {
+                sessionIter->second.remove(handle);
+                deleteSource(source);
+            }
+
+            if (updatedSources)
+                updatedSources->push(source);
+        }
+
+        _loads.erase(loadIter);
+
+        if (_preloads.erase(load.key) && _preloads.empty())
+        {
+            Time now;
+
+            now.update(Time::OAS_CLOCK_MONOTONIC);
+            oas::Logger::logf("AudioHandler - Preloaded %u sound file(s) in %.1f ms.", _preloadCount,
+                              (now - _preloadStart).asDouble() * 1000.0);
+        }
     }
 }
 
@@ -250,12 +705,20 @@ int AudioHandler::createSource(ALuint buffer)
         return -1;
     }
 
-    AudioSource *newSource = new AudioSource(buffer);
+    ALuint handle;
+
+    if (!_sourceTable->reserve(handle))
+    {
+        oas::Logger::warnf("AudioHandler - Session %u has too many sound sources!", _session);
+        return -1;
+    }
+
+    AudioSource *newSource = new AudioSource(buffer, _session, handle);
 
     if (newSource->isValid())
     {
-        _sourceMap.insert(SourcePair(newSource->getHandle(), newSource));
-        _recentSource = newSource;
+        _sourceTable->set(handle, newSource);
+        _bufferCache.addReference(buffer);
         newSource->setRolloffFactor(_defaultRolloff);
         newSource->setReferenceDistance(_defaultReferenceDistance);
         _setRecentlyModifiedAudioUnit(newSource);
@@ -263,6 +726,7 @@ int AudioHandler::createSource(ALuint buffer)
     }
     else
     {
+        _sourceTable->remove(handle);
         delete newSource;
         return -1;
     }
@@ -271,40 +735,163 @@ int AudioHandler::createSource(ALuint buffer)
 // public
 int AudioHandler::createSource(const std::string& filename)
 {
+    // Long files are read from disk while they play, instead of all at once
+    if (_streamThreshold)
+    {
+        FileHandler fileHandler;
+        off_t size = fileHandler.getFileSize(filename);
+
+        if (0 <= size && (unsigned long) size >= _streamThreshold)
+        {
+            AudioStream *stream = new AudioStream(filename);
+
+            if (stream->isValid())
+                return _createStreamingSource(stream);
+
+            // Anything but PCM WAVE files is loaded into a buffer as usual
+            oas::Logger::logf("AudioHandler - \"%s\" can not be streamed, and is loaded whole.",
+                              filename.c_str());
+            delete stream;
+        }
+    }
+
+    // Files that are not loaded yet are loaded in the background, and the source waits for them
+    if (LoadHandler::isEnabled() && !filename.empty())
+    {
+        std::string key = _getBufferKey(filename);
+        AudioBuffer *buffer = _bufferCache.find(key);
+
+        if (buffer)
+            return AudioHandler::createSource(buffer->getHandle());
+
+        return _createLoadingSource(key, filename);
+    }
+
     ALuint buffer = AudioHandler::getBuffer(filename);
     return AudioHandler::createSource(buffer);
 }
 
+// private
+int AudioHandler::_createLoadingSource(const std::string& key, const std::string& filename)
+{
+    // A file that does not exist still fails right away
+    FileHandler fileHandler;
+
+    if (0 > fileHandler.getFileSize(filename))
+    {
+        oas::Logger::warnf("AudioHandler - Could not find \"%s\"", filename.c_str());
+        return -1;
+    }
+
+    ALuint handle;
+
+    if (!_sourceTable->reserve(handle))
+    {
+        oas::Logger::warnf("AudioHandler - Session %u has too many sound sources!", _session);
+        return -1;
+    }
+
+    AudioSource *newSource = new AudioSource(_session, handle);
+
+    _sourceTable->set(handle, newSource);
+    newSource->setRolloffFactor(_defaultRolloff);
+    newSource->setReferenceDistance(_defaultReferenceDistance);
+    _setRecentlyModifiedAudioUnit(newSource);
+
+    // Sources for the same file share one load
+    std::vector<LoadingSource> &loadingSources = _loads[key];
+
+    if (loadingSources.empty())
+        LoadHandler::addLoad(key, filename);
+
+    loadingSources.push_back(LoadingSource(_session, handle));
+    return newSource->getHandle();
+}
+
+// private
+int AudioHandler::_createStreamingSource(AudioStream *stream)
+{
+    ALuint handle;
+
+    if (!_sourceTable->reserve(handle))
+    {
+        oas::Logger::warnf("AudioHandler - Session %u has too many sound sources!", _session);
+        delete stream;
+        return -1;
+    }
+
+    AudioSource *newSource = new AudioSource(stream, _session, handle);
+
+    if (!newSource->isValid())
+    {
+        _sourceTable->remove(handle);
+        delete newSource;
+        return -1;
+    }
+
+    _sourceTable->set(handle, newSource);
+    newSource->setRolloffFactor(_defaultRolloff);
+    newSource->setReferenceDistance(_defaultReferenceDistance);
+    _setRecentlyModifiedAudioUnit(newSource);
+    return newSource->getHandle();
+}
+
+// public
+int AudioHandler::createSourceForContent(const std::string& hash)
+{
+    std::string filename = ContentIndex::getFileForHash(hash);
+
+    if (filename.empty())
+        return -1;
+
+    return AudioHandler::createSource(filename);
+}
+
 // public
 int AudioHandler::createSource(ALint waveShape, ALfloat frequency, ALfloat phase, ALfloat duration)
 {
-    // First, a new buffer must be created with the specified waveform.
-    AudioBuffer *newBuffer = new AudioBuffer(waveShape, frequency, phase, duration);
+    // Sources with the same waveform share a buffer, like sources for the same file
+    std::string key = AudioBuffer::getWaveformFilename(waveShape, frequency, phase, duration);
+    AudioBuffer *buffer = _bufferCache.find(key);
 
-    // Check if buffer created successfully
-    if (!newBuffer->isValid())
+    // If there is none yet, a new buffer must be created with the specified waveform.
+    if (!buffer)
     {
-        delete newBuffer;
+        buffer = new AudioBuffer(waveShape, frequency, phase, duration);
+
+        // Check if buffer created successfully
+        if (!buffer->isValid())
+        {
+            delete buffer;
+            return -1;
+        }
+
+        _bufferCache.insert(key, buffer);
+    }
+
+    ALuint handle;
+
+    if (!_sourceTable->reserve(handle))
+    {
+        oas::Logger::warnf("AudioHandler - Session %u has too many sound sources!", _session);
         return -1;
     }
 
-    // Create a new source with the new buffer
-    AudioSource *newSource = new AudioSource(newBuffer->getHandle());
+    // Create a new source with the buffer
+    AudioSource *newSource = new AudioSource(buffer->getHandle(), _session, handle);
 
     // If new source created successfully
     if (newSource->isValid())
     {
-        // Add buffer to the buffer map
-        _bufferMap.insert(BufferPair(newBuffer->getFilename().c_str(), newBuffer));
-        // Add source to the sourcemap
-        _sourceMap.insert(SourcePair(newSource->getHandle(), newSource));
-        _recentSource = newSource;
+        // Add source to the source table
+        _sourceTable->set(handle, newSource);
+        _bufferCache.addReference(buffer->getHandle());
         _setRecentlyModifiedAudioUnit(newSource);
         return newSource->getHandle();
     }
     else
     {
-        delete newBuffer;
+        _sourceTable->remove(handle);
         delete newSource;
         return -1;
     }
@@ -320,31 +907,32 @@ void AudioHandler::deleteSource(const ALuint sourceHandle)
 	 * prevent access to invalid memory.
 	 */
 
-    // Find the source in the map, and if found, queue it up for deletion
-    SourceMapIterator iterator = AudioHandler::_sourceMap.find(sourceHandle);
+    // Take the source out of the table, and if found, queue it up for deletion
+    AudioSource *source = AudioHandler::_sourceTable->remove(sourceHandle);
 
     _clearRecentlyModifiedAudioUnit();
 
-    if (AudioHandler::_sourceMap.end() != iterator)
+    if (source)
     {
-        if (iterator->second)
+        _removeActiveSource(source);
+
+        // Let the source know that it is to be deleted
+        // Note that the AudioSource is not explicitly deleted yet - only the internal state
+        // is notified that it is to be deleted
+        if (!source->deleteSource())
         {
-            // Let the source know that it is to be deleted
-            // Note that the AudioSource is not explicitly deleted yet - only the internal state
-        	// is notified that it is to be deleted
-            if (!iterator->second->deleteSource())
-            {
-                oas::Logger::warnf("AudioHandler: Deletion of sound source failed!");
-            }
-            else
-            {
-                // Update the recently modified source
-                _setRecentlyModifiedAudioUnit(iterator->second);
-            }
-            // Push the pointer to the source onto the lazy deletion queue
-            _lazyDeletionQueue.push(iterator->second);
+            oas::Logger::warnf("AudioHandler: Deletion of sound source failed!");
+        }
+        else
+        {
+            // Update the recently modified source
+            _setRecentlyModifiedAudioUnit(source);
         }
-        _sourceMap.erase(iterator);
+
+        // The buffer stays cached, unless it is the least recently used one over the budget
+        _bufferCache.removeReference(source->getBuffer());
+        // Push the pointer to the source onto the lazy deletion queue
+        _lazyDeletionQueue.push(source);
     }
 
     _processLazyDeletionQueue();
@@ -356,6 +944,8 @@ void AudioHandler::deleteSource(AudioSource *source)
     if (!source)
         return;
 
+    _removeActiveSource(source);
+
     if (!source->deleteSource())
     {
         oas::Logger::warnf("AudioHandler:: Failed to delete the given audio source!");
@@ -364,6 +954,8 @@ void AudioHandler::deleteSource(AudioSource *source)
     {
         _setRecentlyModifiedAudioUnit(source);
     }
+
+    _bufferCache.removeReference(source->getBuffer());
     _lazyDeletionQueue.push(source);
 
     _processLazyDeletionQueue();
@@ -371,8 +963,14 @@ void AudioHandler::deleteSource(AudioSource *source)
 
 void AudioHandler::_processLazyDeletionQueue()
 {
-    // If the lazy deletion queue hits a size greater than 100, remove an entry
-    if (_lazyDeletionQueue.size() > 100)
+    // Sources released along with their session must stay valid until they have been reported
+    // as updated. Until then, nothing is deleted.
+    if (!_releasedSources.empty())
+        return;
+
+    // If the lazy deletion queue hits a size greater than 100, remove entries until it does not.
+    // A released session may have left many more than one behind.
+    while (_lazyDeletionQueue.size() > 100)
     {
         // Delete the Source at the head of the queue
         delete _lazyDeletionQueue.front();
@@ -392,6 +990,12 @@ void AudioHandler::playSource(const ALuint sourceHandle)
     {
         if (source->play())
             _setRecentlyModifiedAudioUnit(source);
+
+        _addActiveSource(source);
+
+        // Take a free voice right away. If there is none, the source plays without one until the
+        // voices are assigned again.
+        source->_acquireVoice();
     }
 }
 
@@ -446,6 +1050,8 @@ void AudioHandler::setSourcePlaybackPosition(const ALuint sourceHandle, const AL
     {
         if (source->setPlaybackPosition(seconds))
             _setRecentlyModifiedAudioUnit(source);
+
+        _addActiveSource(source);
     }
 
 }
@@ -577,6 +1183,8 @@ void AudioHandler::setSourceFade(const ALuint sourceHandle, const ALfloat fadeTo
 	{
 		if (source->setFade(fadeToGainValue, durationInSeconds))
 			_setRecentlyModifiedAudioUnit(source);
+
+		_addActiveSource(source);
 	}
 }
 
@@ -630,6 +1238,7 @@ int AudioHandler::getSourceState(const ALuint sourceHandle)
         source->update(true);
         state = source->getState();
         _setRecentlyModifiedAudioUnit(source);
+        _addActiveSource(source);
     }
 
     return state;
@@ -699,12 +1308,19 @@ void AudioHandler::setGlobalRenderingParameter(const ALuint whichParameter, ALfl
 
 // private constructor
 AudioHandler::AudioHandler() :
-        _recentSource(NULL),
+        _streamThreshold(DEFAULT_STREAM_THRESHOLD * 1024UL * 1024UL),
+        _preloadCount(0),
+        _session(0),
+        _activeSources(NULL),
+        _voiceTransferCount(0),
         _recentlyModifiedAudioUnit(NULL),
         _device(NULL),
         _context(NULL),
         _defaultRolloff(1),
-        _defaultReferenceDistance(1)
+        _defaultReferenceDistance(1),
+        _alDeferUpdatesSOFT(NULL),
+        _alProcessUpdatesSOFT(NULL),
+        _isDeferringUpdates(false)
 {
-
+    _sourceTable = &_sessionSourceMap[_session];
 }
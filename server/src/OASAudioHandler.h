@@ -7,13 +7,21 @@
 #define _OAS_AUDIO_HANDLER_H_
 
 #include <map>
+#include <set>
+#include <vector>
 #include <iostream>
 #include <cmath>
 #include <queue>
+#include <algorithm>
+#include <functional>
 #include <AL/alut.h>
 #include "OASAudioSource.h"
+#include "OASSourceTable.h"
 #include "OASAudioListener.h"
 #include "OASAudioBuffer.h"
+#include "OASBufferCache.h"
+#include "OASLoadHandler.h"
+#include "OASContentIndex.h"
 #include "OASLogger.h"
 
 namespace oas
@@ -24,17 +32,28 @@ namespace oas
  * units.
  */
 
-// Buffer Map types
-typedef std::map<std::string, AudioBuffer*>     BufferMap;
-typedef BufferMap::iterator                     BufferMapIterator;
-typedef BufferMap::const_iterator               BufferMapConstIterator;
-typedef std::pair<std::string, AudioBuffer*>    BufferPair;
+// Session Source Map types. Each client session has its own handle namespace.
+typedef std::map<unsigned int, SourceTable>     SessionSourceMap;
+typedef SessionSourceMap::iterator              SessionSourceMapIterator;
 
-// Source Map types
-typedef std::map<ALuint, AudioSource*>          SourceMap;
-typedef SourceMap::iterator                     SourceMapIterator;
-typedef SourceMap::const_iterator               SourceMapConstIterator;
-typedef std::pair<ALuint, AudioSource*>         SourcePair;
+// Sound sources that wait for a file to be loaded, by session and handle, under the buffer's key
+typedef std::pair<unsigned int, ALuint>                     LoadingSource;
+typedef std::map<std::string, std::vector<LoadingSource> >  LoadMap;
+typedef LoadMap::iterator                                   LoadMapIterator;
+
+// Sound sources ranked by audibility, when there are more of them playing than voices
+typedef std::pair<float, AudioSource*>          VoiceCandidate;
+
+// Seconds between two rankings of the sound sources that compete for voices
+#define VOICE_ASSIGNMENT_INTERVAL   0.05
+
+// Sources that have a voice count as this much louder when ranked, so that sources of about the
+// same audibility do not keep taking the voice from each other
+#define VOICE_HYSTERESIS            1.25
+
+// Entry points of the AL_SOFT_deferred_updates extension
+typedef void (*DeferUpdatesFunction)(void);
+typedef void (*ProcessUpdatesFunction)(void);
 
 class AudioHandler
 {
@@ -65,12 +84,63 @@ public:
     bool initialize(std::string const& deviceString);
     void release();
 
+    /**
+     * @brief Deletes the sources of every session, and puts the listener and the global rendering
+     *        parameters back to their defaults, so that the next client starts from a clean
+     *        slate. Unlike release(), the device, the context, the buffers and the loads that are
+     *        still running are all kept.
+     */
+    void reset();
+
+    /**
+     * @brief Select the client session whose handle namespace is used by all of the following
+     *        calls that create or look up sources. Session 0 is used when no client is involved.
+     */
+    void setSession(unsigned int session);
+
+    /**
+     * @brief Deletes every source that belongs to the given session. Buffers are not deleted.
+     */
+    void releaseSession(unsigned int session);
+
     /**
      * @brief Gets the buffer that is associated with the file pointed to by filename. 
-     *        Creates a new buffer if necessary.
+     *        Creates a new buffer if necessary. Files with the same contents share a buffer.
      */
     ALuint getBuffer(const std::string& filename);
 
+    /**
+     * @brief Set the number of bytes that buffers which are not used by any source may take up,
+     *        before the least recently used of them are deleted
+     */
+    void setBufferCacheSize(unsigned long bytes);
+
+    /**
+     * @brief Get the buffer cache, for its statistics
+     */
+    const BufferCache& getBufferCache() const;
+
+    /**
+     * @brief Set the size, in bytes, from which PCM WAVE files are streamed from disk while they
+     *        play, instead of being loaded into a buffer. With 0, no file is streamed.
+     */
+    void setStreamThreshold(unsigned long bytes);
+
+    /**
+     * @brief Load a sound file into a buffer ahead of time, so that sources for it are created
+     *        right away. The file is loaded in the background, if the load handler is enabled.
+     *        Preloaded buffers are not in use, so they are unloaded like any other unused buffer
+     *        once the buffer cache is over its budget. Files that would be streamed are skipped.
+     * @retval True The file is loaded, or is being loaded
+     * @retval False The file does not exist, or could not be loaded
+     */
+    bool preloadBuffer(const std::string& filename);
+
+    /**
+     * @brief Check whether any file is still being loaded in the background
+     */
+    bool isLoading() const;
+
     /**
      * @brief Create a new source based on the input buffer
      * @retval Unique handle for the created source, or -1 on error
@@ -78,11 +148,20 @@ public:
     int createSource(const ALuint buffer);
 
     /**
-     * @brief Create a new source with the audio file that is pointed to by filename
+     * @brief Create a new source with the audio file that is pointed to by filename. Files at or
+     *        above the stream threshold are streamed, if they can be. Files that are not loaded yet
+     *        are loaded in the background, if the load handler is enabled, and the source is in the
+     *        loading state until then.
      * @retval Unique handle for the created source, or -1 on error
      */
     int createSource(const std::string& filename);
 
+    /**
+     * @brief Create a new source with the cached audio file that has the given content hash
+     * @retval Unique handle for the created source, or -1 if no such file is cached
+     */
+    int createSourceForContent(const std::string& hash);
+
     /**
      * @brief Create a new source based on the specified waveform.
      * @param waveShape Sine        -> waveShape = 1
@@ -110,13 +189,43 @@ public:
     /**
      * @brief Retrieve copies of all updated sources inside the given queue
      * @param sources
+     * @return true if any source is still playing or fading, and needs to be updated again
      */
-    void populateQueueWithUpdatedSources(std::queue <const AudioUnit*> &sources);
+    bool populateQueueWithUpdatedSources(std::queue <const AudioUnit*> &sources);
 
     /**
      * @brief Updates sources without retrieving copies of them
+     * @return true if any source is still playing or fading, and needs to be updated again
+     */
+    bool updateSources();
+
+    /**
+     * @brief Hold back all following changes to sources and the listener from the mixer, until
+     *        processUpdates() is called. Uses AL_SOFT_deferred_updates if it is available, and
+     *        suspends the context otherwise.
+     */
+    void deferUpdates();
+
+    /**
+     * @brief Hand all changes made since deferUpdates() to the mixer at once
      */
-    void updateSources();
+    void processUpdates();
+
+    /**
+     * @brief Returns true between calls to deferUpdates() and processUpdates()
+     */
+    bool isDeferringUpdates() const;
+
+    /**
+     * @brief Get the number of source and listener updates that were dropped because they
+     *        would not have changed anything
+     */
+    unsigned long getUnchangedUpdateCount() const;
+
+    /**
+     * @brief Get the number of times that a playing source lost its voice to a more audible one
+     */
+    unsigned long getVoiceTransferCount() const;
 
     /**
      * @note:
@@ -283,11 +392,47 @@ private:
     void _clearRecentlyModifiedAudioUnit();
     void _setRecentlyModifiedAudioUnit(const AudioUnit*);
     void _processLazyDeletionQueue();
-
-    BufferMap _bufferMap;
-    SourceMap _sourceMap;
-
-    AudioSource* _recentSource;
+    void _initializeDeferredUpdates();
+    void _addActiveSource(AudioSource *source);
+    void _removeActiveSource(AudioSource *source);
+    void _assignVoices();
+    int _createStreamingSource(AudioStream *stream);
+    int _createLoadingSource(const std::string& key, const std::string& filename);
+    void _finishLoads(std::queue<const AudioUnit*> *updatedSources);
+    std::string _getBufferKey(const std::string& filename);
+
+    // Buffers are shared by the sources of all sessions
+    BufferCache _bufferCache;
+
+    // Files of at least this many bytes are streamed, instead of being loaded into a buffer
+    unsigned long _streamThreshold;
+
+    // Files that are being loaded in the background, and the sources that wait for them
+    LoadMap _loads;
+
+    // Files that are being preloaded, how many were preloaded along with them, and since when
+    std::set<std::string> _preloads;
+    unsigned int _preloadCount;
+    Time _preloadStart;
+    SessionSourceMap _sessionSourceMap;
+
+    // The source table of the currently selected session
+    SourceTable *_sourceTable;
+    unsigned int _session;
+
+    // Sources deleted by releaseSession(), that have not been reported as updated yet
+    std::queue<const AudioUnit*> _releasedSources;
+
+    // Sources that are playing or fading, linked through the sources themselves, so that
+    // updates do not have to visit idle sources. Sources join when they start playing or fading,
+    // and leave at the first update that finds them done.
+    AudioSource *_activeSources;
+
+    // Only the most audible of the active sources have voices. The others play without being
+    // heard, until they become audible enough to take a voice from another source.
+    std::vector<VoiceCandidate> _voiceCandidates;
+    Time _nextVoiceAssignment;
+    unsigned long _voiceTransferCount;
 
     const AudioUnit *_recentlyModifiedAudioUnit;
 
@@ -299,6 +444,10 @@ private:
 
     ALfloat _defaultRolloff;
     ALfloat _defaultReferenceDistance;
+
+    DeferUpdatesFunction _alDeferUpdatesSOFT;
+    ProcessUpdatesFunction _alProcessUpdatesSOFT;
+    bool _isDeferringUpdates;
 };
 
 }
@@ -29,6 +29,13 @@ bool AudioListener::setGain(ALfloat gain)
 {
     if (isValid())
     {
+        // Nothing to tell OpenAL if the value is unchanged
+        if (gain == _gain)
+        {
+            _unchangedUpdates++;
+            return true;
+        }
+
         _clearError();
 
         alListenerf(AL_GAIN, gain);
@@ -47,6 +54,12 @@ bool AudioListener::setPosition(ALfloat x, ALfloat y, ALfloat z)
 {
     if (isValid())
     {
+        if (x == _positionX && y == _positionY && z == _positionZ)
+        {
+            _unchangedUpdates++;
+            return true;
+        }
+
         _clearError();
 
         alListener3f(AL_POSITION, x, y, z);
@@ -66,6 +79,12 @@ bool AudioListener::setVelocity(ALfloat x, ALfloat y, ALfloat z)
 {
     if (isValid())
     {
+        if (x == _velocityX && y == _velocityY && z == _velocityZ)
+        {
+            _unchangedUpdates++;
+            return true;
+        }
+
         _clearError();
 
         alListener3f(AL_VELOCITY, x, y, z);
@@ -86,6 +105,13 @@ bool AudioListener::setOrientation(ALfloat atX, ALfloat atY, ALfloat atZ,
 {
     if (isValid())
     {
+        if (atX == _orientation[0] && atY == _orientation[1] && atZ == _orientation[2]
+            && upX == _orientation[3] && upY == _orientation[4] && upZ == _orientation[5])
+        {
+            _unchangedUpdates++;
+            return true;
+        }
+
         _clearError();
 
         ALfloat orientation[6] = {atX, atY, atZ, upX, upY, upZ};
@@ -143,6 +169,11 @@ bool AudioListener::setDopplerFactor(ALfloat doppler)
     return false;
 }
 
+unsigned long AudioListener::getUnchangedUpdateCount() const
+{
+    return _unchangedUpdates;
+}
+
 float AudioListener::getOrientationLookAtX() const
 {
     return _orientation[0];
@@ -283,6 +314,7 @@ void AudioListener::_init()
     _orientation[4] = 1.0;
     _orientation[5] = 0.0;
 
+    _unchangedUpdates = 0;
     _isValid = true;
 }
 
@@ -113,6 +113,12 @@ public:
      */
     static int getIndexCount();
 
+    /**
+     * @brief Get the number of updates that were not passed on to OpenAL, because they did not
+     *        change anything
+     */
+    unsigned long getUnchangedUpdateCount() const;
+
     ~AudioListener();
 
 protected:
@@ -140,6 +146,8 @@ private:
 
     ALfloat _speedOfSound;
     ALfloat _dopplerFactor;
+
+    unsigned long _unchangedUpdates;
 };
 }
 
@@ -4,28 +4,61 @@
 using namespace oas;
 
 // Statics
-ALuint AudioSource::_nextHandle = 0;
+unsigned long AudioSource::_unchangedUpdates = 0;
 
 
-AudioSource::AudioSource(ALuint buffer)
+AudioSource::AudioSource(ALuint buffer, unsigned int session, ALuint handle)
 {
     // Set values to default
     _init();
+    _session = session;
+    _handle = handle;
 
-    // Clear OpenAL error state
-    _clearError();
+    // The source starts out without a voice. It gets one from the audio handler when it is played.
+    if (!alIsBuffer(buffer))
+    {
+        oas::Logger::errorf("Sound source %d can not use buffer %u", _handle, buffer);
+        return;
+    }
 
-    // Generate source
-    alGenSources(1, &_id);
-    // Bind buffer to source
-    alSourcei(_id, AL_BUFFER, buffer);
     _buffer = buffer;
+    _state = ST_INITIAL;
+    _isValid = true;
+    _readDuration();
+}
 
-    _isValid = _wasOperationSuccessful();
+AudioSource::AudioSource(unsigned int session, ALuint handle)
+{
+    // Set values to default
+    _init();
+    _session = session;
+    _handle = handle;
+    _state = ST_LOADING;
+    _isValid = true;
+}
 
-    // Update the state of the audio source
-    if (isValid())
-        update(true);
+AudioSource::AudioSource(AudioStream *stream, unsigned int session, ALuint handle)
+{
+    // Set values to default
+    _init();
+    _session = session;
+    _handle = handle;
+    _stream = stream;
+
+    if (!_stream->isValid())
+    {
+        oas::Logger::errorf("Sound source %d can not stream \"%s\"", _handle,
+                            _stream->getFilename().c_str());
+        return;
+    }
+
+    _state = ST_INITIAL;
+    _isValid = true;
+    _duration = _stream->getDuration();
+
+    // Reading starts right away, so that the first blocks are ready when the source is played
+    StreamHandler::addStream(_stream);
+    StreamHandler::wake();
 }
 
 AudioSource::AudioSource()
@@ -36,17 +69,20 @@ AudioSource::AudioSource()
 AudioSource::~AudioSource()
 {
     _state = ST_UNKNOWN;
-    if (isValid() && alIsSource(_id))
+    if (hasVoice())
     {
-        alDeleteSources(1, &_id);
+        _releaseToPool();
     }
+
+    _releaseStream();
 }
 
 // private
 void AudioSource::_init()
 {
     _id = AL_NONE;
-    _handle = this->_generateNextHandle();
+    _handle = 0;
+    _session = 0;
     _buffer = AL_NONE;
     _positionX = _positionY = _positionZ = 0.0;
     _velocityX = _velocityY = _velocityZ = 0.0;
@@ -54,26 +90,343 @@ void AudioSource::_init()
     _gain = 1.0;
     _pitch = 1.0;
     _rolloff = 1.0;
+    _referenceDistance = 1.0;
     _isValid = false;
     _isLooping = false;
     _isDirectional = false;
+    _hasCone = false;
     _fadeDuration = 0;
     _fadeFinalGain = -1;
     _fadeEndTime.reset();
     _fadeStartTime.reset();
     _fadeGainDiff = 0;
     _state = ST_UNKNOWN;
+    _stream = NULL;
+    _streamOffset = 0;
+    _duration = 0;
+    _offset = 0;
+    _offsetTime.reset();
     _coneInnerAngle = 45.0;
     _coneOuterAngle = 180.0;
     _coneOuterGain = 0.0;
+    _previousActive = _nextActive = NULL;
+    _isInActiveList = false;
 }
 
 // private
-ALuint AudioSource::_generateNextHandle()
+void AudioSource::_readDuration()
 {
-    _nextHandle++;
+    ALint size = 0, frequency = 0, channels = 0, bits = 0;
+
+    alGetBufferi(_buffer, AL_SIZE, &size);
+    alGetBufferi(_buffer, AL_FREQUENCY, &frequency);
+    alGetBufferi(_buffer, AL_CHANNELS, &channels);
+    alGetBufferi(_buffer, AL_BITS, &bits);
 
-    return _nextHandle - 1;
+    if (0 < frequency && 0 < channels && 8 <= bits)
+        _duration = (double) size / (channels * (bits / 8)) / frequency;
+}
+
+// private
+void AudioSource::_deferOperation(PlaybackOperation operation, ALfloat seconds)
+{
+    DeferredOperation deferredOperation;
+
+    deferredOperation.operation = operation;
+    deferredOperation.seconds = seconds;
+    _deferredOperations.push_back(deferredOperation);
+}
+
+// private
+bool AudioSource::_acquireVoice()
+{
+    if (hasVoice())
+        return true;
+
+    // Only playing sources need a voice. A source that played past its end without one will be
+    // found stopped by the next update.
+    double offset = _getPlaybackOffset();
+
+    if (!isValid() || ST_PLAYING != _state || (!_isLooping && offset >= _duration))
+        return false;
+
+    if (!SourcePool::acquire(_id))
+    {
+        _id = AL_NONE;
+        return false;
+    }
+
+    _clearError();
+
+    // The buffers of a stream are generated once, and kept until the source is deleted
+    if (_stream && _streamBuffers.empty())
+    {
+        _streamBuffers.resize(STREAM_BLOCK_COUNT);
+        alGenBuffers(STREAM_BLOCK_COUNT, &_streamBuffers[0]);
+
+        if (!_wasOperationSuccessful())
+        {
+            _streamBuffers.clear();
+            SourcePool::recycle(_id);
+            _id = AL_NONE;
+            return false;
+        }
+    }
+
+    if (!_stream)
+        alSourcei(_id, AL_BUFFER, _buffer);
+
+    // Pass on every property that differs from the defaults of OpenAL, which the source from the
+    // pool has
+    if (_positionX || _positionY || _positionZ)
+        alSource3f(_id, AL_POSITION, _positionX, _positionY, _positionZ);
+    if (_velocityX || _velocityY || _velocityZ)
+        alSource3f(_id, AL_VELOCITY, _velocityX, _velocityY, _velocityZ);
+    if (_directionX || _directionY || _directionZ)
+        alSource3f(_id, AL_DIRECTION, _directionX, _directionY, _directionZ);
+    if (1.0 != _gain)
+        alSourcef(_id, AL_GAIN, _gain);
+    if (1.0 != _pitch)
+        alSourcef(_id, AL_PITCH, _pitch);
+    // A stream loops by reading the file from the beginning again, so its source never loops
+    if (_isLooping && !_stream)
+        alSourcei(_id, AL_LOOPING, AL_TRUE);
+    if (1.0 != _rolloff)
+        alSourcef(_id, AL_ROLLOFF_FACTOR, _rolloff);
+    if (1.0 != _referenceDistance)
+        alSourcef(_id, AL_REFERENCE_DISTANCE, _referenceDistance);
+
+    if (_hasCone)
+    {
+        alSourcef(_id, AL_CONE_INNER_ANGLE, _coneInnerAngle);
+        alSourcef(_id, AL_CONE_OUTER_ANGLE, _coneOuterAngle);
+        alSourcef(_id, AL_CONE_OUTER_GAIN, _coneOuterGain);
+    }
+
+    // Resume where the source would be, had it been playing all along. A stream starts playing
+    // as soon as the blocks from there have been read.
+    if (_stream)
+    {
+        _restartStream(offset);
+        _feedStream();
+    }
+    else
+    {
+        if (0 < offset)
+            alSourcef(_id, AL_SEC_OFFSET, offset);
+
+        alSourcePlay(_id);
+    }
+
+    if (!_wasOperationSuccessful())
+    {
+        _releaseToPool();
+        _id = AL_NONE;
+        return false;
+    }
+
+    return true;
+}
+
+// private
+void AudioSource::_releaseVoice()
+{
+    if (!hasVoice())
+        return;
+
+    // Remember where playback is, so that it carries on from there without a voice
+    ALint alState = AL_INITIAL;
+
+    if (_stream)
+        _unqueueStreamBuffers();
+
+    alGetSourcei(_id, AL_SOURCE_STATE, &alState);
+
+    // A source that was found stopped by its last update already starts from the beginning
+    if ((AL_PLAYING == alState || AL_PAUSED == alState) && ST_STOPPED != _state)
+    {
+        ALfloat offset = 0;
+        alGetSourcef(_id, AL_SEC_OFFSET, &offset);
+
+        // The offset of a stream only counts the buffers that are still queued
+        if (_stream)
+        {
+            double streamOffset = _streamOffset + offset;
+
+            if (_isLooping && 0 < _duration)
+                streamOffset = fmod(streamOffset, _duration);
+
+            _setPlaybackOffset(streamOffset);
+        }
+        else
+        {
+            _setPlaybackOffset(offset);
+        }
+    }
+    else if (_stream && ST_PLAYING == _state && !_stream->isFinished())
+    {
+        // The stream could not be read fast enough, and every queued buffer has been played
+        _setPlaybackOffset(_streamOffset);
+    }
+    else if (ST_PLAYING == _state)
+    {
+        // The source reached its end since the last update
+        _state = ST_STOPPED;
+        _setPlaybackOffset(0);
+    }
+
+    _releaseToPool();
+    _id = AL_NONE;
+
+    // Returning the source to the pool detached every buffer of the stream
+    _freeStreamBuffers = _streamBuffers;
+}
+
+// private
+double AudioSource::_getPlaybackOffset() const
+{
+    if (ST_PLAYING != _state || hasVoice())
+        return _offset;
+
+    // Without a voice, a playing source moves ahead in real time, scaled by its pitch
+    Time now;
+    now.update(Time::OAS_CLOCK_MONOTONIC);
+
+    double offset = _offset + (now - _offsetTime).asDouble() * _pitch;
+
+    if (_isLooping && 0 < _duration)
+        offset = fmod(offset, _duration);
+
+    return offset;
+}
+
+// private
+void AudioSource::_setPlaybackOffset(double seconds)
+{
+    _offset = seconds;
+    _offsetTime.update(Time::OAS_CLOCK_MONOTONIC);
+}
+
+// private
+void AudioSource::_feedStream()
+{
+    _unqueueStreamBuffers();
+
+    // Buffers that have finished playing are filled with the next blocks of the stream
+    bool didQueue = false;
+
+    while (!_freeStreamBuffers.empty() && _stream->takeBlock(_streamBlock))
+    {
+        ALuint buffer = _freeStreamBuffers.back();
+        _freeStreamBuffers.pop_back();
+
+        alBufferData(buffer, _stream->getFormat(), &_streamBlock[0], _streamBlock.size(),
+                     _stream->getFrequency());
+        alSourceQueueBuffers(_id, 1, &buffer);
+        didQueue = true;
+    }
+
+    if (didQueue)
+        StreamHandler::wake();
+
+    // Start playing once the first blocks are queued, and again if the stream could not be read
+    // fast enough and the source ran out of buffers
+    if (ST_PLAYING == _state && _freeStreamBuffers.size() < _streamBuffers.size())
+    {
+        ALint alState = AL_INITIAL;
+        alGetSourcei(_id, AL_SOURCE_STATE, &alState);
+
+        if (AL_PLAYING != alState)
+            alSourcePlay(_id);
+    }
+}
+
+// private
+void AudioSource::_unqueueStreamBuffers()
+{
+    ALint processed = 0;
+    alGetSourcei(_id, AL_BUFFERS_PROCESSED, &processed);
+
+    for (; 0 < processed; processed--)
+    {
+        ALuint buffer = AL_NONE;
+        ALint size = 0;
+
+        alSourceUnqueueBuffers(_id, 1, &buffer);
+        alGetBufferi(buffer, AL_SIZE, &size);
+
+        _streamOffset += (double) size / _stream->getBytesPerSecond();
+        _freeStreamBuffers.push_back(buffer);
+    }
+
+    if (_isLooping && 0 < _duration && _streamOffset >= _duration)
+        _streamOffset = fmod(_streamOffset, _duration);
+}
+
+// private
+void AudioSource::_restartStream(double seconds)
+{
+    _stream->seek(seconds);
+    _streamOffset = seconds;
+
+    // Rewinding the source lets every queued buffer be detached at once
+    if (hasVoice())
+    {
+        alSourceRewind(_id);
+        alSourcei(_id, AL_BUFFER, AL_NONE);
+        _freeStreamBuffers = _streamBuffers;
+    }
+
+    StreamHandler::wake();
+}
+
+// private
+void AudioSource::_releaseStream()
+{
+    if (!_stream)
+        return;
+
+    // The stream handler deletes the stream once it is no longer reading it
+    StreamHandler::removeStream(_stream);
+    _stream = NULL;
+
+    if (!_streamBuffers.empty())
+        alDeleteBuffers(_streamBuffers.size(), &_streamBuffers[0]);
+
+    _streamBuffers.clear();
+    _freeStreamBuffers.clear();
+}
+
+// private
+void AudioSource::_releaseToPool()
+{
+    // Only the properties that differ from the defaults of OpenAL have to be restored, which
+    // usually leaves just a few
+    if (_positionX || _positionY || _positionZ)
+        alSource3f(_id, AL_POSITION, 0, 0, 0);
+    if (_velocityX || _velocityY || _velocityZ)
+        alSource3f(_id, AL_VELOCITY, 0, 0, 0);
+    if (_directionX || _directionY || _directionZ)
+        alSource3f(_id, AL_DIRECTION, 0, 0, 0);
+    if (1.0 != _gain)
+        alSourcef(_id, AL_GAIN, 1);
+    if (1.0 != _pitch)
+        alSourcef(_id, AL_PITCH, 1);
+    if (_isLooping && !_stream)
+        alSourcei(_id, AL_LOOPING, AL_FALSE);
+    if (1.0 != _rolloff)
+        alSourcef(_id, AL_ROLLOFF_FACTOR, 1);
+    if (1.0 != _referenceDistance)
+        alSourcef(_id, AL_REFERENCE_DISTANCE, 1);
+
+    if (_hasCone)
+    {
+        alSourcef(_id, AL_CONE_INNER_ANGLE, 360);
+        alSourcef(_id, AL_CONE_OUTER_ANGLE, 360);
+        alSourcef(_id, AL_CONE_OUTER_GAIN, 0);
+    }
+
+    SourcePool::recycle(_id);
 }
 
 // private
@@ -155,9 +508,42 @@ bool AudioSource::_needsFade()
 }
 
 // static, public
-void AudioSource::resetSources()
+unsigned long AudioSource::getUnchangedUpdateCount()
 {
-    _nextHandle = 0;
+    return _unchangedUpdates;
+}
+
+bool AudioSource::finishLoading(ALuint buffer)
+{
+    if (!isValid() || ST_LOADING != _state || !alIsBuffer(buffer))
+        return false;
+
+    _buffer = buffer;
+    _state = ST_INITIAL;
+    _readDuration();
+
+    // Everything but playback was applied as it arrived, because the source has no voice yet
+    for (unsigned int i = 0; i < _deferredOperations.size(); i++)
+    {
+        switch (_deferredOperations[i].operation)
+        {
+            case OP_PLAY:
+                play();
+                break;
+            case OP_STOP:
+                stop();
+                break;
+            case OP_PAUSE:
+                pause();
+                break;
+            case OP_SEEK:
+                setPlaybackPosition(_deferredOperations[i].seconds);
+                break;
+        }
+    }
+
+    _deferredOperations.clear();
+    return true;
 }
 
 bool AudioSource::update(bool forceUpdate)
@@ -173,8 +559,24 @@ bool AudioSource::update(bool forceUpdate)
     if (!forceUpdate && _state != ST_PLAYING && !_needsFade())
         return false;
 
-    // Retrieve state information from OpenAL
-    alGetSourcei(this->_id, AL_SOURCE_STATE, &alState);
+    // Without a voice, the source stops once its playback position passes the end
+    if (!hasVoice())
+        alState = (ST_PLAYING == _state && !_isLooping && _getPlaybackOffset() >= _duration)
+                  ? AL_STOPPED : AL_NONE;
+    // A stream is topped up, and only stops once every block of it has been played. The
+    // OpenAL source also stops when it runs out of buffers before the next block is read.
+    else if (_stream)
+    {
+        if (ST_PLAYING == _state)
+            _feedStream();
+
+        alState = (ST_PLAYING == _state && _stream->isFinished()
+                   && _freeStreamBuffers.size() == _streamBuffers.size())
+                  ? AL_STOPPED : AL_NONE;
+    }
+    // Else, retrieve state information from OpenAL
+    else
+        alGetSourcei(this->_id, AL_SOURCE_STATE, &alState);
 
     switch (alState)
     {
@@ -190,11 +592,18 @@ bool AudioSource::update(bool forceUpdate)
         case AL_PAUSED:
             newState = ST_PAUSED;
             break;
+        case AL_NONE:
+            newState = _state;
+            break;
         default:
             newState = ST_UNKNOWN;
             break;
     }
 
+    // A source that played to its end starts from the beginning next time
+    if (ST_PLAYING == _state && ST_STOPPED == newState)
+        _setPlaybackOffset(0);
+
     bool didFade = _checkIncrementalFade();
 
     // If the new state is the same as the old state, return false
@@ -209,6 +618,62 @@ bool AudioSource::update(bool forceUpdate)
     }
 }
 
+bool AudioSource::needsUpdates()
+{
+    return (isValid() && (ST_PLAYING == _state || _needsFade()));
+}
+
+bool AudioSource::hasVoice() const
+{
+    return (AL_NONE != _id);
+}
+
+float AudioSource::getAudibility(const AudioListener *listener) const
+{
+    if (!isValid() || ST_PLAYING != _state)
+        return 0;
+
+    float toListenerX = listener->getPositionX() - _positionX;
+    float toListenerY = listener->getPositionY() - _positionY;
+    float toListenerZ = listener->getPositionZ() - _positionZ;
+    float distance = sqrt(toListenerX * toListenerX + toListenerY * toListenerY
+                          + toListenerZ * toListenerZ);
+    float audibility = _gain;
+
+    // Inverse distance, clamped at the reference distance. This is the default model of OpenAL.
+    if (distance > _referenceDistance)
+    {
+        float attenuation = _referenceDistance + _rolloff * (distance - _referenceDistance);
+
+        if (0 < attenuation)
+            audibility *= _referenceDistance / attenuation;
+    }
+
+    // Directional sources are quieter outside of their inner cone
+    if (_isDirectional && 0 < distance)
+    {
+        float directionLength = sqrt(_directionX * _directionX + _directionY * _directionY
+                                     + _directionZ * _directionZ);
+        float cosine = (_directionX * toListenerX + _directionY * toListenerY
+                        + _directionZ * toListenerZ) / (directionLength * distance);
+
+        if (cosine > 1)
+            cosine = 1;
+        else if (cosine < -1)
+            cosine = -1;
+
+        float angle = acos(cosine) * 360.0 / M_PI;
+
+        if (angle >= _coneOuterAngle)
+            audibility *= _coneOuterGain;
+        else if (angle > _coneInnerAngle)
+            audibility *= 1 + (_coneOuterGain - 1) * (angle - _coneInnerAngle)
+                              / (_coneOuterAngle - _coneInnerAngle);
+    }
+
+    return audibility;
+}
+
 bool AudioSource::isDirectional() const
 {
     return _isDirectional;
@@ -224,13 +689,29 @@ ALuint AudioSource::getHandle() const
     return _handle;
 }
 
+unsigned int AudioSource::getSession() const
+{
+    return _session;
+}
+
 ALuint AudioSource::getBuffer() const
 {
     return _buffer;
 }
 
+bool AudioSource::isStreaming() const
+{
+    return (NULL != _stream);
+}
+
 bool AudioSource::play()
 {
+    if (isValid() && ST_LOADING == _state)
+    {
+        _deferOperation(OP_PLAY);
+        return true;
+    }
+
     if (isValid())
     {
         // Clear OpenAL error state
@@ -243,6 +724,25 @@ bool AudioSource::play()
         if (_state == ST_PLAYING)
             return true;
 
+        // Without a voice, playback starts from the stored position
+        if (!hasVoice())
+        {
+            _setPlaybackOffset(_offset);
+            _state = ST_PLAYING;
+            return true;
+        }
+
+        // A stream that is not paused is queued up again from the position that playback starts at
+        if (_stream)
+        {
+            if (ST_PAUSED != _state)
+                _restartStream(_offset);
+
+            _state = ST_PLAYING;
+            _feedStream();
+            return _wasOperationSuccessful();
+        }
+
         alSourcePlay(_id);
 
         // Change state and return true iff operation successful
@@ -258,8 +758,21 @@ bool AudioSource::play()
 
 bool AudioSource::stop()
 {
+    if (isValid() && ST_LOADING == _state)
+    {
+        _deferOperation(OP_STOP);
+        return true;
+    }
+
     if (isValid())
     {
+        if (!hasVoice())
+        {
+            _setPlaybackOffset(0);
+            _state = ST_STOPPED;
+            return true;
+        }
+
         // Clear OpenAL error state
         _clearError();
 
@@ -268,6 +781,11 @@ bool AudioSource::stop()
         // Change state and return true iff operation successful
         if (_wasOperationSuccessful())
         {
+            // The beginning of the stream is read again, ready for the next time it is played
+            if (_stream)
+                _restartStream(0);
+
+            _setPlaybackOffset(0);
             _state = ST_STOPPED;
             return true;
         }
@@ -278,8 +796,25 @@ bool AudioSource::stop()
 
 bool AudioSource::pause()
 {
+    if (isValid() && ST_LOADING == _state)
+    {
+        _deferOperation(OP_PAUSE);
+        return true;
+    }
+
     if (isValid())
     {
+        if (!hasVoice())
+        {
+            // Like OpenAL, only a playing source can be paused
+            if (ST_PLAYING == _state)
+            {
+                _setPlaybackOffset(_getPlaybackOffset());
+                _state = ST_PAUSED;
+            }
+            return true;
+        }
+
         // Clear OpenAL error state
         _clearError();
 
@@ -298,17 +833,41 @@ bool AudioSource::pause()
 
 bool AudioSource::setPlaybackPosition(ALfloat seconds)
 {
-    if (isValid() && seconds >= 0)
+    // The length of the sound is not known yet, so the position is checked once it is
+    if (isValid() && ST_LOADING == _state)
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alSourcef(_id, AL_SEC_OFFSET, seconds);
+        _deferOperation(OP_SEEK, seconds);
+        return true;
+    }
 
-        if (_wasOperationSuccessful())
+    if (isValid() && seconds >= 0 && seconds <= _duration)
+    {
+        if (hasVoice())
         {
-            return true;
+            // Clear OpenAL error state
+            _clearError();
+
+            // A stream is read and queued again from the new position
+            if (_stream)
+            {
+                _restartStream(seconds);
+
+                if (ST_PLAYING == _state)
+                    _feedStream();
+            }
+            else
+            {
+                alSourcef(_id, AL_SEC_OFFSET, seconds);
+            }
+
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        // Also kept for when the source is stopped, because OpenAL does not report the position
+        // of sources that are not playing
+        _setPlaybackOffset(seconds);
+        return true;
     }
 
     return false;
@@ -319,18 +878,28 @@ bool AudioSource::setPosition(ALfloat x, ALfloat y, ALfloat z)
 {
     if (isValid())
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alSource3f(_id, AL_POSITION, x, y, z);
-
-        if (_wasOperationSuccessful())
+        // Nothing to tell OpenAL if the value is unchanged
+        if (x == _positionX && y == _positionY && z == _positionZ)
         {
-            _positionX = x;
-            _positionY = y;
-            _positionZ = z;
+            _unchangedUpdates++;
             return true;
         }
+
+        if (hasVoice())
+        {
+            // Clear OpenAL error state
+            _clearError();
+
+            alSource3f(_id, AL_POSITION, x, y, z);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+
+        _positionX = x;
+        _positionY = y;
+        _positionZ = z;
+        return true;
     }
 
     return false;
@@ -338,18 +907,27 @@ bool AudioSource::setPosition(ALfloat x, ALfloat y, ALfloat z)
 
 bool AudioSource::setGain(ALfloat gain)
 {
-    if (isValid())
+    if (isValid() && gain >= 0)
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alSourcef(_id, AL_GAIN, gain);
-
-        if (_wasOperationSuccessful())
+        if (gain == _gain)
         {
-            _gain = gain;
+            _unchangedUpdates++;
             return true;
         }
+
+        if (hasVoice())
+        {
+            // Clear OpenAL error state
+            _clearError();
+
+            alSourcef(_id, AL_GAIN, gain);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+
+        _gain = gain;
+        return true;
     }
 
     return false;
@@ -383,16 +961,28 @@ bool AudioSource::setLoop(ALint isLoop)
 {
     if (isValid())
     {
-        // Clear OpenAL error state
-        _clearError();
+        // Blocks that were already read past the end still play once
+        if (_stream)
+            _stream->setLooping(isLoop != 0);
 
-        alSourcei(_id, AL_LOOPING, (isLoop != 0) ? AL_TRUE : AL_FALSE);
+        if (hasVoice() && !_stream)
+        {
+            // Clear OpenAL error state
+            _clearError();
 
-        if (_wasOperationSuccessful())
+            alSourcei(_id, AL_LOOPING, (isLoop != 0) ? AL_TRUE : AL_FALSE);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+        // The position so far was reached with the old setting
+        else if (!hasVoice())
         {
-            _isLooping = ((isLoop != 0) ? AL_TRUE : AL_FALSE);
-            return true;
+            _setPlaybackOffset(_getPlaybackOffset());
         }
+
+        _isLooping = ((isLoop != 0) ? AL_TRUE : AL_FALSE);
+        return true;
     }
 
     return false;
@@ -402,18 +992,27 @@ bool AudioSource::setVelocity(ALfloat x, ALfloat y, ALfloat z)
 {
     if (isValid())
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alSource3f(_id, AL_VELOCITY, x, y, z);
-
-        if (_wasOperationSuccessful())
+        if (x == _velocityX && y == _velocityY && z == _velocityZ)
         {
-            _velocityX = x;
-            _velocityY = y;
-            _velocityZ = z;
+            _unchangedUpdates++;
             return true;
         }
+
+        if (hasVoice())
+        {
+            // Clear OpenAL error state
+            _clearError();
+
+            alSource3f(_id, AL_VELOCITY, x, y, z);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+
+        _velocityX = x;
+        _velocityY = y;
+        _velocityZ = z;
+        return true;
     }
 
     return false;
@@ -423,35 +1022,48 @@ bool AudioSource::setDirection(ALfloat x, ALfloat y, ALfloat z)
 {
     if (isValid())
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alSource3f(_id, AL_DIRECTION, x, y, z);
+        if (x == _directionX && y == _directionY && z == _directionZ)
+        {
+            _unchangedUpdates++;
+            return true;
+        }
 
-        if (_wasOperationSuccessful())
+        if (hasVoice())
         {
-            _directionX = x;
-            _directionY = y;
-            _directionZ = z;
+            // Clear OpenAL error state
+            _clearError();
 
-            // If zero vector, i.e. no direction, then set source as non-directional
-            if ((x == 0.0) && (y == 0.0) && (z == 0.0))
-            {
-                _isDirectional = false;
-            }
-            // Else, the vector specifies some direction.
-            // Set directional cone properties if they weren't already set
-            else if (!isDirectional())
+            alSource3f(_id, AL_DIRECTION, x, y, z);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+
+        _directionX = x;
+        _directionY = y;
+        _directionZ = z;
+
+        // If zero vector, i.e. no direction, then set source as non-directional
+        if ((x == 0.0) && (y == 0.0) && (z == 0.0))
+        {
+            _isDirectional = false;
+        }
+        // Else, the vector specifies some direction.
+        // Set directional cone properties if they weren't already set
+        else if (!isDirectional())
+        {
+            // Set the inner and outer cone angles
+            if (hasVoice())
             {
-                // Set the inner and outer cone angles
                 alSourcef(_id, AL_CONE_INNER_ANGLE, _coneInnerAngle);
                 alSourcef(_id, AL_CONE_OUTER_ANGLE, _coneOuterAngle);
                 alSourcef(_id, AL_CONE_OUTER_GAIN, _coneOuterGain);
-                _isDirectional = true;
             }
-
-            return true;
+            _isDirectional = true;
+            _hasCone = true;
         }
+
+        return true;
     }
 
     return false;
@@ -459,18 +1071,32 @@ bool AudioSource::setDirection(ALfloat x, ALfloat y, ALfloat z)
 
 bool AudioSource::setPitch(ALfloat pitchFactor)
 {
-    if (isValid())
+    if (isValid() && pitchFactor > 0)
     {
-        // Clear OpenAL error state
-        _clearError();
+        if (pitchFactor == _pitch)
+        {
+            _unchangedUpdates++;
+            return true;
+        }
 
-        alSourcef(_id, AL_PITCH, pitchFactor);
+        if (hasVoice())
+        {
+            // Clear OpenAL error state
+            _clearError();
 
-        if (_wasOperationSuccessful())
+            alSourcef(_id, AL_PITCH, pitchFactor);
+
+            if (!_wasOperationSuccessful())
+                return false;
+        }
+        // The position so far was reached at the old pitch
+        else
         {
-            _pitch = pitchFactor;
-            return true;
+            _setPlaybackOffset(_getPlaybackOffset());
         }
+
+        _pitch = pitchFactor;
+        return true;
     }
 
     return false;
@@ -479,17 +1105,20 @@ bool AudioSource::setPitch(ALfloat pitchFactor)
 
 bool AudioSource::setRolloffFactor(ALfloat rolloff)
 {
-    if (isValid())
+    if (isValid() && rolloff >= 0)
     {
-        _clearError();
+        if (hasVoice())
+        {
+            _clearError();
 
-        alSourcef(_id, AL_ROLLOFF_FACTOR, rolloff);
+            alSourcef(_id, AL_ROLLOFF_FACTOR, rolloff);
 
-        if (_wasOperationSuccessful())
-        {
-            _rolloff = rolloff;
-            return true;
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        _rolloff = rolloff;
+        return true;
     }
 
     return false;
@@ -497,17 +1126,20 @@ bool AudioSource::setRolloffFactor(ALfloat rolloff)
 
 bool AudioSource::setReferenceDistance(ALfloat referenceDistance)
 {
-    if (isValid())
+    if (isValid() && referenceDistance >= 0)
     {
-        _clearError();
+        if (hasVoice())
+        {
+            _clearError();
 
-        alSourcef(_id, AL_REFERENCE_DISTANCE, referenceDistance);
+            alSourcef(_id, AL_REFERENCE_DISTANCE, referenceDistance);
 
-        if (_wasOperationSuccessful())
-        {
-            _referenceDistance = referenceDistance;
-            return true;
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        _referenceDistance = referenceDistance;
+        return true;
     }
 
     return false;
@@ -515,17 +1147,21 @@ bool AudioSource::setReferenceDistance(ALfloat referenceDistance)
 
 bool AudioSource::setConeInnerAngle(ALfloat innerAngleInDegrees)
 {
-    if (isValid())
+    if (isValid() && innerAngleInDegrees >= 0 && innerAngleInDegrees <= 360)
     {
-        _clearError();
+        if (hasVoice())
+        {
+            _clearError();
 
-        alSourcef(_id, AL_CONE_INNER_ANGLE, innerAngleInDegrees);
+            alSourcef(_id, AL_CONE_INNER_ANGLE, innerAngleInDegrees);
 
-        if (_wasOperationSuccessful())
-        {
-            _coneInnerAngle = innerAngleInDegrees;
-            return true;
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        _coneInnerAngle = innerAngleInDegrees;
+        _hasCone = true;
+        return true;
     }
 
     return false;
@@ -533,17 +1169,21 @@ bool AudioSource::setConeInnerAngle(ALfloat innerAngleInDegrees)
 
 bool AudioSource::setConeOuterAngle(ALfloat outerAngleInDegrees)
 {
-    if (isValid())
+    if (isValid() && outerAngleInDegrees >= 0 && outerAngleInDegrees <= 360)
     {
-        _clearError();
+        if (hasVoice())
+        {
+            _clearError();
 
-        alSourcef(_id, AL_CONE_OUTER_ANGLE, outerAngleInDegrees);
+            alSourcef(_id, AL_CONE_OUTER_ANGLE, outerAngleInDegrees);
 
-        if (_wasOperationSuccessful())
-        {
-            _coneOuterAngle = outerAngleInDegrees;
-            return true;
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        _coneOuterAngle = outerAngleInDegrees;
+        _hasCone = true;
+        return true;
     }
 
     return false;
@@ -551,17 +1191,21 @@ bool AudioSource::setConeOuterAngle(ALfloat outerAngleInDegrees)
 
 bool AudioSource::setConeOuterGain(ALfloat coneOuterGain)
 {
-    if (isValid())
+    if (isValid() && coneOuterGain >= 0 && coneOuterGain <= 1)
     {
-        _clearError();
+        if (hasVoice())
+        {
+            _clearError();
 
-        alSourcef(_id, AL_CONE_OUTER_GAIN, coneOuterGain);
+            alSourcef(_id, AL_CONE_OUTER_GAIN, coneOuterGain);
 
-        if (_wasOperationSuccessful())
-        {
-            _coneOuterGain = coneOuterGain;
-            return true;
+            if (!_wasOperationSuccessful())
+                return false;
         }
+
+        _coneOuterGain = coneOuterGain;
+        _hasCone = true;
+        return true;
     }
 
     return false;
@@ -571,21 +1215,18 @@ bool AudioSource::deleteSource()
 {
     if (isValid())
     {
-        // Clear OpenAL error state
-        _clearError();
-
-        alDeleteSources(1, &_id);
-
-        if (_wasOperationSuccessful())
+        // The OpenAL source goes back to the pool, for the next sound source that needs a voice
+        if (hasVoice())
         {
-            _state = ST_DELETED;
-            this->invalidate();
-            return true;
-        }
-        else
-        {
-        	return false;
+            _releaseToPool();
+            _id = AL_NONE;
         }
+
+        _releaseStream();
+
+        _state = ST_DELETED;
+        this->invalidate();
+        return true;
     }
     else
     {
@@ -680,6 +1321,8 @@ std::string AudioSource::getStringForIndex(int index) const
                 sprintf(buffer, "Paused");
             else if (ST_DELETED == getState())
                 sprintf(buffer, "Deleting");
+            else if (ST_LOADING == getState())
+                sprintf(buffer, "Loading");
             else
                 sprintf(buffer, "Unknown");
             break;
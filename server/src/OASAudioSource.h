@@ -8,17 +8,33 @@
 #define _OAS_AUDIOSOURCE_H_
 
 #include <string>
+#include <vector>
+#include <cmath>
 #include <AL/alut.h>
 #include "OASAudioUnit.h"
+#include "OASAudioListener.h"
 #include "OASTime.h"
+#include "OASSourcePool.h"
+#include "OASAudioStream.h"
+#include "OASStreamHandler.h"
 
 namespace oas
 {
 /**
  * Contains some basic properties and functions useful for modifying sound in OpenAL
+ *
+ * A sound source only holds an OpenAL source, its voice, while the audio handler lets it have one.
+ * Without a voice, the source is virtual: it keeps all of its properties and follows its own
+ * playback position, so that it resumes at the right offset once it gets a voice again.
+ *
+ * A source either plays a buffer that holds all of its sound, or a stream that is read from disk
+ * while it plays. A streaming source queues the blocks of its stream on a few OpenAL buffers of its
+ * own, and fills them again as they finish playing.
  */
 class AudioSource : public AudioUnit
 {
+    friend class AudioHandler;
+
 
 public:
 
@@ -29,6 +45,7 @@ public:
      * PAUSED:  source is paused at a specific point, and playback will resume from here
      * STOPPED: source is stopped and playback will resume from the beginning
      * DELETED: source is in the process of being deleted
+     * LOADING: the file of the source is still being loaded
      */
     enum SourceState
     {
@@ -37,7 +54,8 @@ public:
         ST_PLAYING = 2,
         ST_PAUSED =  3,
         ST_STOPPED = 4,
-        ST_DELETED = 5
+        ST_DELETED = 5,
+        ST_LOADING = 6
     };
 
     /**
@@ -45,11 +63,28 @@ public:
      */
     virtual unsigned int getHandle() const;
 
+    /**
+     * @brief Get the client session that owns this source. Handles are unique within a session.
+     */
+    virtual unsigned int getSession() const;
+
     /**
      * @brief Get the name of the underlying buffer that is attached to this source
      */
     unsigned int getBuffer() const;
 
+    /**
+     * @brief Check whether the source plays a stream, instead of a buffer
+     */
+    bool isStreaming() const;
+
+    /**
+     * @brief Give a loading source the buffer that was loaded for it. Playback commands that were
+     *        received while the source was loading are applied now, in the order they arrived.
+     * @return false if the source is not loading, or the buffer is invalid
+     */
+    bool finishLoading(ALuint buffer);
+
     /**
      * @brief Update the state of the sound source, and perform automated operations (e.g. fade)
      * @param forceUpdate If true, it will force the state to be checked and updated via OpenAL,
@@ -58,6 +93,24 @@ public:
      */
     bool update(bool forceUpdate = false);
 
+    /**
+     * @brief Check whether the source needs to be updated periodically, because it is playing
+     *        or being faded
+     */
+    bool needsUpdates();
+
+    /**
+     * @brief Check whether the source holds an OpenAL source, and can actually be heard
+     */
+    bool hasVoice() const;
+
+    /**
+     * @brief Estimate how loud the source is for the given listener, from its gain, distance,
+     *        rolloff and cone, the same way that OpenAL would. Sources that are not playing
+     *        can not be heard at all.
+     */
+    float getAudibility(const AudioListener *listener) const;
+
     /**
      * @brief Play the source all the way through
      */
@@ -242,9 +295,10 @@ public:
     bool isSoundSource() const;
 
     /**
-     * @brief Resets the handle counter, and any other state applicable to all sources
+     * @brief Get the number of updates, across all sources, that were not passed on to OpenAL
+     *        because they did not change anything
      */
-    static void resetSources();
+    static unsigned long getUnchangedUpdateCount();
 
     /**
      * @brief Get the label for the data entry for the given index
@@ -265,8 +319,27 @@ public:
     /**
      * @brief Creates a new audio source using the specified buffer
      * @param buffer Handle to a buffer that contains sound data
+     * @param session The client session that owns the source
+     * @param handle The handle that the session uses for the source
      */
-    AudioSource(ALuint buffer);
+    AudioSource(ALuint buffer, unsigned int session, ALuint handle);
+
+    /**
+     * @brief Creates a new audio source that plays a stream
+     * @param stream Stream of the sound data. The source takes ownership of it.
+     * @param session The client session that owns the source
+     * @param handle The handle that the session uses for the source
+     */
+    AudioSource(AudioStream *stream, unsigned int session, ALuint handle);
+
+    /**
+     * @brief Creates a new audio source that waits for its buffer to be loaded. Until
+     *        finishLoading() is called, its properties can be set, but playback commands are
+     *        held back.
+     * @param session The client session that owns the source
+     * @param handle The handle that the session uses for the source
+     */
+    AudioSource(unsigned int session, ALuint handle);
 
     AudioSource();
 
@@ -284,28 +357,77 @@ protected:
      */
 
 private:
+
+    enum PlaybackOperation
+    {
+        OP_PLAY,
+        OP_STOP,
+        OP_PAUSE,
+        OP_SEEK
+    };
+
+    // A playback command that was received while the source was loading
+    struct DeferredOperation
+    {
+        PlaybackOperation operation;
+        ALfloat seconds;
+    };
+
     void _init();
-    ALuint _generateNextHandle();
+    void _readDuration();
+    void _deferOperation(PlaybackOperation operation, ALfloat seconds = 0);
     void _clearError();
     bool _wasOperationSuccessful();
     bool _checkIncrementalFade();
     bool _needsFade();
+    bool _acquireVoice();
+    void _releaseVoice();
+    void _releaseToPool();
+    double _getPlaybackOffset() const;
+    void _setPlaybackOffset(double seconds);
+    void _feedStream();
+    void _unqueueStreamBuffers();
+    void _restartStream(double seconds);
+    void _releaseStream();
 
     /*
      * 'id' is used to interact with the OpenAL library, and the values are arbitrary.
      * The 'id' is strictly internal to the source, and no other object needs to know it.
+     * It is AL_NONE while the source has no voice.
      */
     ALuint _id;
 
     /*
-     * 'handle' is used to interact with the client, and the values are guaranteed to
-     * start from 1 and increment by 1 for each source that is generated.
+     * 'handle' is used to interact with the client. It is given out by the SourceTable of the
+     * session, and is only unique within that session.
      */
     ALuint _handle;
+    unsigned int _session;
 
     ALuint _buffer;
     SourceState _state;
 
+    // Stream that is played instead of a buffer, and the OpenAL buffers that its blocks are
+    // queued on. The buffers are only generated once the source first gets a voice.
+    AudioStream *_stream;
+    std::vector<ALuint> _streamBuffers;
+    std::vector<ALuint> _freeStreamBuffers;
+    std::vector<char> _streamBlock;
+
+    // Playback position of the stream, in seconds, at the start of the first queued buffer
+    double _streamOffset;
+
+    // Playback commands to apply once the buffer has been loaded
+    std::vector<DeferredOperation> _deferredOperations;
+
+    // Length of the buffer or stream, in seconds
+    double _duration;
+
+    // Playback position, in seconds, at the given time. It is only kept up to date while the
+    // source has no voice, and is read back from OpenAL when the voice is taken away.
+    double _offset;
+    Time _offsetTime;
+
     ALfloat _directionX, _directionY, _directionZ;
 
     ALfloat _pitch;
@@ -318,6 +440,9 @@ private:
     ALint _isLooping;
     bool _isDirectional;
 
+    // Whether the cone properties differ from the defaults of OpenAL
+    bool _hasCone;
+
     double _fadeFinalGain;
     double _fadeInitialGain;
     double _fadeGainDiff;
@@ -325,7 +450,12 @@ private:
     Time _fadeStartTime;
     Time _fadeEndTime; 	// _fadeEndTime = _fadeStartTime + _fadeDuration
 
-    static ALuint _nextHandle;
+    // Links in the audio handler's list of sources that are playing or fading
+    AudioSource *_previousActive;
+    AudioSource *_nextActive;
+    bool _isInActiveList;
+
+    static unsigned long _unchangedUpdates;
 
 };
 }
@@ -0,0 +1,344 @@
+/**
+ * @file OASAudioStream.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASAudioStream.h"
+
+using namespace oas;
+
+AudioStream::AudioStream(const std::string &filename) :
+    _filename(filename),
+    _fileDescriptor(-1),
+    _isValid(false),
+    _format(AL_NONE),
+    _frequency(0),
+    _frameSize(0),
+    _blockSize(0),
+    _dataOffset(0),
+    _dataSize(0),
+    _position(0),
+    _seekPosition(0),
+    _hasTakenBlocks(false),
+    _generation(0),
+    _isLooping(false),
+    _isAtEnd(false)
+{
+    pthread_mutex_init(&_mutex, NULL);
+
+    FileHandler fileHandler;
+    _fileDescriptor = fileHandler.openFile(filename);
+
+    if (-1 == _fileDescriptor)
+        return;
+
+    if (!_readHeader())
+    {
+        close(_fileDescriptor);
+        _fileDescriptor = -1;
+        return;
+    }
+
+    unsigned int blockFrames = _frequency * STREAM_BLOCK_DURATION;
+
+    _blockSize = (blockFrames ? blockFrames : 1) * _frameSize;
+    _isAtEnd = (0 == _dataSize);
+    _isValid = true;
+}
+
+AudioStream::~AudioStream()
+{
+    if (-1 != _fileDescriptor)
+        close(_fileDescriptor);
+
+    pthread_mutex_destroy(&_mutex);
+}
+
+// private
+bool AudioStream::_readHeader()
+{
+    unsigned char header[12];
+
+    if (12 != pread(_fileDescriptor, header, 12, 0)
+        || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4))
+    {
+        return false;
+    }
+
+    off_t fileSize = lseek(_fileDescriptor, 0, SEEK_END);
+    off_t offset = 12;
+    unsigned int channels = 0, bits = 0;
+    bool hasFormat = false;
+
+    // Walk the chunks up to the sound data, reading the format on the way
+    while (offset + 8 <= fileSize)
+    {
+        unsigned char chunk[24];
+
+        if (8 != pread(_fileDescriptor, chunk, 8, offset))
+            return false;
+
+        uint32_t chunkSize = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16)
+                             | ((uint32_t) chunk[7] << 24);
+
+        if (!memcmp(chunk, "fmt ", 4))
+        {
+            if (16 > chunkSize || 16 != pread(_fileDescriptor, chunk + 8, 16, offset + 8))
+                return false;
+
+            unsigned int formatTag = chunk[8] | (chunk[9] << 8);
+            channels = chunk[10] | (chunk[11] << 8);
+            _frequency = chunk[12] | (chunk[13] << 8) | (chunk[14] << 16) | (chunk[15] << 24);
+            bits = chunk[22] | (chunk[23] << 8);
+
+            // 0xFFFE is the extensible format, which is assumed to hold PCM data as well. If not,
+            // the bit depth will not match any format OpenAL knows.
+            if (1 != formatTag && 0xFFFE != formatTag)
+                return false;
+
+            hasFormat = true;
+        }
+        else if (!memcmp(chunk, "data", 4))
+        {
+            if (!hasFormat)
+                return false;
+
+            _dataOffset = offset + 8;
+            _dataSize = chunkSize;
+
+            // Files that were written while recording may not have the size filled in
+            if (_dataOffset + _dataSize > fileSize)
+                _dataSize = fileSize - _dataOffset;
+
+            break;
+        }
+
+        // Chunks are padded to an even number of bytes
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if (1 == channels && 8 == bits)
+        _format = AL_FORMAT_MONO8;
+    else if (1 == channels && 16 == bits)
+        _format = AL_FORMAT_MONO16;
+    else if (2 == channels && 8 == bits)
+        _format = AL_FORMAT_STEREO8;
+    else if (2 == channels && 16 == bits)
+        _format = AL_FORMAT_STEREO16;
+    else
+        return false;
+
+    if (!_dataOffset || 0 >= _frequency)
+        return false;
+
+    _frameSize = channels * bits / 8;
+    _dataSize -= _dataSize % _frameSize;
+
+    return true;
+}
+
+// public
+bool AudioStream::isValid() const
+{
+    return _isValid;
+}
+
+// public
+const std::string& AudioStream::getFilename() const
+{
+    return _filename;
+}
+
+// public
+ALenum AudioStream::getFormat() const
+{
+    return _format;
+}
+
+// public
+ALsizei AudioStream::getFrequency() const
+{
+    return _frequency;
+}
+
+// public
+double AudioStream::getDuration() const
+{
+    if (!_isValid)
+        return 0;
+
+    return (double) _dataSize / getBytesPerSecond();
+}
+
+// public
+unsigned int AudioStream::getBytesPerSecond() const
+{
+    return _frequency * _frameSize;
+}
+
+// public
+void AudioStream::seek(double seconds)
+{
+    if (!_isValid)
+        return;
+
+    off_t position = (off_t) (seconds * _frequency) * _frameSize;
+
+    if (position > _dataSize)
+        position = _dataSize;
+
+    pthread_mutex_lock(&_mutex);
+
+    // The blocks that were read ahead are still good
+    if (!_hasTakenBlocks && position == _seekPosition)
+    {
+        pthread_mutex_unlock(&_mutex);
+        return;
+    }
+
+    if (position == _dataSize && _isLooping)
+        position = 0;
+
+    while (!_blocks.empty())
+    {
+        _recycleBlock(_blocks.front());
+        _blocks.pop_front();
+    }
+
+    _position = _seekPosition = position;
+    _hasTakenBlocks = false;
+    _isAtEnd = (position == _dataSize);
+    _generation++;
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+// public
+void AudioStream::setLooping(bool isLooping)
+{
+    pthread_mutex_lock(&_mutex);
+
+    // A stream that already ended goes on from the beginning
+    if (isLooping && _isAtEnd && _isValid && _dataSize)
+    {
+        _position = 0;
+        _isAtEnd = false;
+    }
+
+    _isLooping = isLooping;
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+// public
+bool AudioStream::takeBlock(std::vector<char> &data)
+{
+    pthread_mutex_lock(&_mutex);
+
+    if (_blocks.empty())
+    {
+        pthread_mutex_unlock(&_mutex);
+        return false;
+    }
+
+    data.swap(_blocks.front());
+
+    // The block now holds what the caller had, which is usually the memory of an earlier block
+    _recycleBlock(_blocks.front());
+    _blocks.pop_front();
+    _hasTakenBlocks = true;
+
+    pthread_mutex_unlock(&_mutex);
+    return true;
+}
+
+// public
+bool AudioStream::isFinished()
+{
+    pthread_mutex_lock(&_mutex);
+    bool isFinished = (_isAtEnd && _blocks.empty());
+    pthread_mutex_unlock(&_mutex);
+
+    return isFinished;
+}
+
+// private
+void AudioStream::_recycleBlock(std::vector<char> &block)
+{
+    // There are never more blocks than STREAM_BLOCK_COUNT in use at once
+    if (!block.capacity() || STREAM_BLOCK_COUNT <= _freeBlocks.size())
+        return;
+
+    _freeBlocks.push_back(std::vector<char>());
+    _freeBlocks.back().swap(block);
+}
+
+// public
+bool AudioStream::decode()
+{
+    pthread_mutex_lock(&_mutex);
+
+    if (!_isValid || _isAtEnd || STREAM_BLOCK_COUNT <= _blocks.size())
+    {
+        pthread_mutex_unlock(&_mutex);
+        return false;
+    }
+
+    off_t position = _position;
+    unsigned int generation = _generation;
+
+    // Read into the memory of a block that is not needed anymore, instead of allocating
+    if (_readBlock.capacity() < _blockSize && !_freeBlocks.empty())
+    {
+        _readBlock.swap(_freeBlocks.back());
+        _freeBlocks.pop_back();
+    }
+
+    pthread_mutex_unlock(&_mutex);
+
+    // The file is read without holding the lock, so that the server thread never waits for the disk
+    off_t size = _dataSize - position;
+
+    if (size > _blockSize)
+        size = _blockSize;
+
+    _readBlock.resize(size);
+    ssize_t count = pread(_fileDescriptor, &_readBlock[0], size, _dataOffset + position);
+
+    if (0 < count)
+        _readBlock.resize(count - count % _frameSize);
+
+    pthread_mutex_lock(&_mutex);
+
+    // The block is of no use if the stream was moved meanwhile, but the next one might be
+    if (generation != _generation)
+    {
+        pthread_mutex_unlock(&_mutex);
+        return true;
+    }
+
+    if (0 >= count || _readBlock.empty())
+    {
+        oas::Logger::warnf("AudioStream - Could not read \"%s\" past %ld bytes",
+                           _filename.c_str(), (long) position);
+        _isAtEnd = true;
+    }
+    else
+    {
+        _blocks.push_back(std::vector<char>());
+        _blocks.back().swap(_readBlock);
+        _position += _blocks.back().size();
+
+        if (_position >= _dataSize)
+        {
+            if (_isLooping)
+                _position = 0;
+            else
+                _isAtEnd = true;
+        }
+    }
+
+    pthread_mutex_unlock(&_mutex);
+    return true;
+}
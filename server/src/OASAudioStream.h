@@ -0,0 +1,148 @@
+/**
+ * @file    OASAudioStream.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_AUDIO_STREAM_H_
+#define _OAS_AUDIO_STREAM_H_
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <AL/alut.h>
+
+#include "OASFileHandler.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Seconds of sound in each block that is read from the file, and queued on the OpenAL source
+#define STREAM_BLOCK_DURATION       0.25
+
+// Number of blocks that are read ahead of playback. Also the number of OpenAL buffers that a
+// streaming source queues, so a stream holds at most twice this many blocks in memory.
+#define STREAM_BLOCK_COUNT          4
+
+// Files of at least this many megabytes are streamed, if the configuration does not say
+#define DEFAULT_STREAM_THRESHOLD    16
+
+/**
+ * Reads the sound data of a file from disk in blocks, a little ahead of playback, so that long
+ * files can be played without loading them into a buffer all at once. Only uncompressed PCM WAVE
+ * files can be streamed.
+ *
+ * The blocks are read by the stream handler's thread with decode(), and taken by the server thread
+ * with takeBlock(). Everything else is only called from the server thread.
+ */
+class AudioStream
+{
+public:
+
+    /**
+     * @brief Open the file in the cache, and read its header
+     */
+    AudioStream(const std::string &filename);
+    ~AudioStream();
+
+    /**
+     * @brief Check whether the file could be opened, and holds sound data that can be streamed
+     */
+    bool isValid() const;
+
+    const std::string& getFilename() const;
+
+    /**
+     * @brief Get the OpenAL format and frequency of the sound data
+     */
+    ALenum getFormat() const;
+    ALsizei getFrequency() const;
+
+    /**
+     * @brief Get the length of the sound, in seconds
+     */
+    double getDuration() const;
+
+    /**
+     * @brief Get the number of bytes of sound data that play in one second
+     */
+    unsigned int getBytesPerSecond() const;
+
+    /**
+     * @brief Drop the blocks read so far, and continue reading from the given position, in
+     *        seconds. Does nothing if the stream is already at that position.
+     */
+    void seek(double seconds);
+
+    /**
+     * @brief Set whether reading continues at the beginning once the end of the file is reached
+     */
+    void setLooping(bool isLooping);
+
+    /**
+     * @brief Take the next block, if one has been read
+     * @param data Swapped with the sound data of the block. The memory that data held before is
+     *             kept, and reused for a later block.
+     * @return false if no block is ready
+     */
+    bool takeBlock(std::vector<char> &data);
+
+    /**
+     * @brief Check whether the end of a stream that does not loop was reached, and every block
+     *        has been taken
+     */
+    bool isFinished();
+
+    /**
+     * @brief Read the next block from the file, if there is room for it. Called by the stream
+     *        handler's thread.
+     * @return true if a block was read, and the stream may have room for more
+     */
+    bool decode();
+
+private:
+
+    bool _readHeader();
+    void _recycleBlock(std::vector<char> &block);
+
+    std::string _filename;
+    int _fileDescriptor;
+    bool _isValid;
+
+    ALenum _format;
+    ALsizei _frequency;
+    unsigned int _frameSize;
+    unsigned int _blockSize;
+
+    // Where the sound data begins in the file, and how many bytes of it there are
+    off_t _dataOffset;
+    off_t _dataSize;
+
+    // The block that decode() reads into. Only used by the stream handler's thread.
+    std::vector<char> _readBlock;
+
+    // Everything below is shared with the stream handler's thread
+    pthread_mutex_t _mutex;
+    std::deque< std::vector<char> > _blocks;
+    // Memory of blocks that were taken or thrown away, to be read into again
+    std::vector< std::vector<char> > _freeBlocks;
+
+    // Next byte of the sound data to read
+    off_t _position;
+    // Position that reading started at after the last seek, and whether any block was taken since
+    off_t _seekPosition;
+    bool _hasTakenBlocks;
+    // Counts seeks, so that a block read while seeking is thrown away
+    unsigned int _generation;
+
+    bool _isLooping;
+    bool _isAtEnd;
+};
+
+}
+
+#endif
@@ -43,6 +43,14 @@ public:
      */
     virtual unsigned int getHandle() const = 0;
 
+    /**
+     * @brief Get the client session that this audio unit belongs to, or 0 if it is shared
+     */
+    inline virtual unsigned int getSession() const
+    {
+        return 0;
+    }
+
     /**
      * @brief Get the current gain
      */
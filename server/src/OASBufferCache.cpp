@@ -0,0 +1,182 @@
+/**
+ * @file OASBufferCache.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASBufferCache.h"
+
+using namespace oas;
+
+BufferCache::BufferCache() :
+    _budget(DEFAULT_BUFFER_CACHE_SIZE * 1024UL * 1024UL),
+    _totalSize(0),
+    _hitCount(0),
+    _missCount(0),
+    _evictionCount(0)
+{
+}
+
+BufferCache::~BufferCache()
+{
+    clear();
+}
+
+// public
+AudioBuffer* BufferCache::find(const std::string &key)
+{
+    KeyMap::iterator keyIter = _keys.find(key);
+
+    if (_keys.end() == keyIter)
+    {
+        _missCount++;
+        return NULL;
+    }
+
+    _hitCount++;
+    return _entries[keyIter->second].buffer;
+}
+
+// public
+bool BufferCache::contains(const std::string &key) const
+{
+    return (_keys.end() != _keys.find(key));
+}
+
+// public
+void BufferCache::insert(const std::string &key, AudioBuffer *buffer)
+{
+    Entry entry;
+
+    entry.buffer = buffer;
+    entry.key = key;
+    entry.references = 0;
+    entry.unusedPosition = _unused.insert(_unused.end(), buffer->getHandle());
+
+    _entries[buffer->getHandle()] = entry;
+    _keys[key] = buffer->getHandle();
+    _totalSize += buffer->getSize();
+
+    _evict(buffer->getHandle());
+}
+
+// public
+void BufferCache::addReference(ALuint handle)
+{
+    EntryMap::iterator entryIter = _entries.find(handle);
+
+    if (_entries.end() == entryIter)
+        return;
+
+    if (0 == entryIter->second.references++)
+        _unused.erase(entryIter->second.unusedPosition);
+}
+
+// public
+void BufferCache::removeReference(ALuint handle)
+{
+    EntryMap::iterator entryIter = _entries.find(handle);
+
+    if (_entries.end() == entryIter || 0 == entryIter->second.references)
+        return;
+
+    // The buffer becomes the most recently used of the unused ones
+    if (0 == --entryIter->second.references)
+    {
+        entryIter->second.unusedPosition = _unused.insert(_unused.end(), handle);
+        _evict(AL_NONE);
+    }
+}
+
+// public
+void BufferCache::clear()
+{
+    while (!_entries.empty())
+        _delete(_entries.begin());
+
+    _unused.clear();
+}
+
+// public
+void BufferCache::setBudget(unsigned long bytes)
+{
+    _budget = bytes;
+    _evict(AL_NONE);
+}
+
+// public
+unsigned long BufferCache::getBudget() const
+{
+    return _budget;
+}
+
+// public
+unsigned int BufferCache::getCount() const
+{
+    return _entries.size();
+}
+
+// public
+unsigned long BufferCache::getTotalSize() const
+{
+    return _totalSize;
+}
+
+// public
+unsigned long BufferCache::getHitCount() const
+{
+    return _hitCount;
+}
+
+// public
+unsigned long BufferCache::getMissCount() const
+{
+    return _missCount;
+}
+
+// public
+unsigned long BufferCache::getEvictionCount() const
+{
+    return _evictionCount;
+}
+
+// public
+void BufferCache::logContents() const
+{
+    EntryMap::const_iterator entryIter;
+
+    for (entryIter = _entries.begin(); entryIter != _entries.end(); entryIter++)
+    {
+        oas::Logger::logf("BufferCache - \"%s\": %u bytes, used by %u sound source(s)",
+                          entryIter->second.buffer->getFilename().c_str(),
+                          entryIter->second.buffer->getSize(),
+                          entryIter->second.references);
+    }
+
+    oas::Logger::logf("BufferCache - %u buffers with %lu bytes, of %lu bytes allowed. "
+                      "%lu lookups found a buffer, %lu did not, and %lu buffers were deleted.",
+                      getCount(), _totalSize, _budget, _hitCount, _missCount, _evictionCount);
+}
+
+// private
+void BufferCache::_evict(ALuint keep)
+{
+    while (_totalSize > _budget && !_unused.empty() && _unused.front() != keep)
+    {
+        EntryMap::iterator entryIter = _entries.find(_unused.front());
+
+        _unused.pop_front();
+        _evictionCount++;
+        _delete(entryIter);
+    }
+}
+
+// private
+void BufferCache::_delete(EntryMap::iterator entryIter)
+{
+    _totalSize -= entryIter->second.buffer->getSize();
+    _keys.erase(entryIter->second.key);
+
+    delete entryIter->second.buffer;
+    _entries.erase(entryIter);
+}
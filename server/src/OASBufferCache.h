@@ -0,0 +1,126 @@
+/**
+ * @file    OASBufferCache.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_BUFFER_CACHE_H_
+#define _OAS_BUFFER_CACHE_H_
+
+#include <map>
+#include <list>
+#include <string>
+#include <AL/alut.h>
+
+#include "OASAudioBuffer.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Number of megabytes of sound data that are kept in buffers, if the configuration does not say
+#define DEFAULT_BUFFER_CACHE_SIZE       256
+
+/**
+ * Keeps the sound buffers, by the name of the file (or content hash) they were loaded from.
+ * Every buffer counts the sound sources that use it. Buffers that no sound source uses stay in the
+ * cache, so that the next source for the same file does not have to load it again, until the
+ * buffers take up more than the budget. Then the least recently used of them are deleted. Buffers
+ * that are in use are never deleted, so the budget can be exceeded while they are.
+ */
+class BufferCache
+{
+public:
+
+    /**
+     * @brief Get the buffer with the given key, or NULL if it is not cached
+     */
+    AudioBuffer* find(const std::string &key);
+
+    /**
+     * @brief Check whether a buffer with the given key is cached, without counting a lookup
+     */
+    bool contains(const std::string &key) const;
+
+    /**
+     * @brief Add a new buffer to the cache, which takes ownership of it. The buffer is not in use
+     *        until addReference() is called, but it is never deleted to make room for itself.
+     */
+    void insert(const std::string &key, AudioBuffer *buffer);
+
+    /**
+     * @brief Count one more sound source that uses the buffer with the given handle
+     */
+    void addReference(ALuint handle);
+
+    /**
+     * @brief Count one less sound source that uses the buffer with the given handle. The buffer
+     *        may be deleted right away if the cache is over its budget.
+     */
+    void removeReference(ALuint handle);
+
+    /**
+     * @brief Delete every buffer. No sound source may use any of them anymore.
+     */
+    void clear();
+
+    /**
+     * @brief Set the number of bytes that buffers which are not in use may fill the cache up to
+     */
+    void setBudget(unsigned long bytes);
+    unsigned long getBudget() const;
+
+    /**
+     * @brief Get the number of buffers, and the number of bytes of sound data in them
+     */
+    unsigned int getCount() const;
+    unsigned long getTotalSize() const;
+
+    /**
+     * @brief Get the number of lookups that found a buffer, that did not, and the number of
+     *        buffers deleted to stay within the budget
+     */
+    unsigned long getHitCount() const;
+    unsigned long getMissCount() const;
+    unsigned long getEvictionCount() const;
+
+    /**
+     * @brief Log the size of every buffer, and the number of sound sources that use it
+     */
+    void logContents() const;
+
+    BufferCache();
+    ~BufferCache();
+
+private:
+
+    struct Entry
+    {
+        AudioBuffer *buffer;
+        std::string key;
+        unsigned int references;
+        // Position in the list of unused buffers, if the buffer is not in use
+        std::list<ALuint>::iterator unusedPosition;
+    };
+
+    typedef std::map<ALuint, Entry>         EntryMap;
+    typedef std::map<std::string, ALuint>   KeyMap;
+
+    void _evict(ALuint keep);
+    void _delete(EntryMap::iterator entry);
+
+    EntryMap _entries;
+    KeyMap _keys;
+
+    // Buffers that no sound source uses, least recently used first
+    std::list<ALuint> _unused;
+
+    unsigned long _budget;
+    unsigned long _totalSize;
+    unsigned long _hitCount;
+    unsigned long _missCount;
+    unsigned long _evictionCount;
+};
+
+}
+
+#endif
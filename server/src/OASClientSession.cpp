@@ -0,0 +1,170 @@
+/**
+ * @file OASClientSession.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASClientSession.h"
+
+using namespace oas;
+
+ClientSession::ClientSession(unsigned int id, int connection, const std::string& address) :
+    _id(id),
+    _connection(connection),
+    _address(address),
+    _receiveStart(0),
+    _receiveEnd(0),
+    _isAwaitingResponse(false),
+    _isBinaryProtocol(false),
+    _datagramKey(0),
+    _transferKey(0),
+    _isTransferConnection(false),
+    _isReceivingFile(false),
+    _isLocal(false),
+    _ring(NULL),
+    _lastDatagramSequence(0),
+    _hasReceivedDatagram(false),
+    _watchedEvents(0)
+{
+    pthread_mutex_init(&_outMutex, NULL);
+}
+
+ClientSession::~ClientSession()
+{
+    pthread_mutex_lock(&_outMutex);
+    while (!_outgoingResponses.empty())
+    {
+        delete[] _outgoingResponses.front().first;
+        _outgoingResponses.pop();
+    }
+    pthread_mutex_unlock(&_outMutex);
+
+    pthread_mutex_destroy(&_outMutex);
+
+    delete _ring;
+}
+
+// public
+unsigned int ClientSession::getID() const
+{
+    return _id;
+}
+
+// public
+int ClientSession::getConnection() const
+{
+    return _connection;
+}
+
+// public
+const std::string& ClientSession::getAddress() const
+{
+    return _address;
+}
+
+// public
+void ClientSession::addOutgoingResponse(const char *response, bool isTagged)
+{
+    // If null or empty string, do nothing
+    if (!response || !*response)
+    {
+        return;
+    }
+
+    // create a copy of the response to put into the queue
+    char *newString = new char[strlen(response) + 1];
+    strcpy(newString, response);
+
+    pthread_mutex_lock(&_outMutex);
+    _outgoingResponses.push(std::make_pair(newString, isTagged));
+    pthread_mutex_unlock(&_outMutex);
+}
+
+// public
+char* ClientSession::getNextOutgoingResponse(bool &isTagged)
+{
+    char *retval = NULL;
+
+    pthread_mutex_lock(&_outMutex);
+    if (!_outgoingResponses.empty())
+    {
+        retval = _outgoingResponses.front().first;
+        isTagged = _outgoingResponses.front().second;
+        _outgoingResponses.pop();
+    }
+    pthread_mutex_unlock(&_outMutex);
+
+    return retval;
+}
+
+// private
+unsigned int ClientSession::_prepareReceiveSpace()
+{
+    // Everything has been consumed, so start over from the beginning
+    if (_receiveStart == _receiveEnd)
+    {
+        _receiveStart = _receiveEnd = 0;
+    }
+    // Else if the end of the buffer is running out of space, move the unconsumed bytes (normally
+    // no more than one partial frame) back to the start
+    else if (MAX_RECEIVE_BUFFER_SIZE - _receiveEnd < MAX_TRANSMIT_BUFFER_SIZE && 0 < _receiveStart)
+    {
+        memmove(_receiveBuf, _receiveBuf + _receiveStart, _receiveEnd - _receiveStart);
+        _receiveEnd -= _receiveStart;
+        _receiveStart = 0;
+    }
+
+    return MAX_RECEIVE_BUFFER_SIZE - _receiveEnd;
+}
+
+// private
+char* ClientSession::_receiveSpace()
+{
+    return _receiveBuf + _receiveEnd;
+}
+
+// private
+void ClientSession::_received(unsigned int amount)
+{
+    _receiveEnd += amount;
+}
+
+// private
+bool ClientSession::_nextFrame(char*& frame, unsigned int& length) const
+{
+    const char *pStart = _receiveBuf + _receiveStart;
+    const char *pEnd = _receiveBuf + _receiveEnd;
+
+    for (const char *pChar = pStart; pChar < pEnd; pChar++)
+    {
+        if ('\0' == *pChar || '\n' == *pChar)
+        {
+            frame = const_cast<char*>(pStart);
+            length = pChar - pStart;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// private
+char* ClientSession::_unconsumedData()
+{
+    return _receiveBuf + _receiveStart;
+}
+
+// private
+unsigned int ClientSession::_unconsumedBytes() const
+{
+    return _receiveEnd - _receiveStart;
+}
+
+// private
+void ClientSession::_consume(unsigned int amount)
+{
+    if (amount > _receiveEnd - _receiveStart)
+        amount = _receiveEnd - _receiveStart;
+
+    _receiveStart += amount;
+}
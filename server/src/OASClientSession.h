@@ -0,0 +1,151 @@
+/**
+ * @file    OASClientSession.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_CLIENT_SESSION_H_
+#define _OAS_CLIENT_SESSION_H_
+
+#include <string>
+#include <queue>
+#include <utility>
+#include <cstring>
+#include <pthread.h>
+
+#include "OASMessage.h"
+#include "OASSharedMemoryRing.h"
+
+namespace oas
+{
+
+#define MAX_TRANSMIT_BUFFER_SIZE    MAX_MESSAGE_SIZE
+#define MAX_RECEIVE_BUFFER_SIZE     (MAX_TRANSMIT_BUFFER_SIZE * 4)
+
+// Largest batch that is guaranteed to fit in the receive buffer along with the message that
+// starts it. Larger batches are applied one message at a time.
+#define MAX_BATCH_SIZE              (MAX_RECEIVE_BUFFER_SIZE - MAX_TRANSMIT_BUFFER_SIZE)
+
+/**
+ * Holds the per-connection state for one connected client: its read buffer, its handle
+ * namespace identifier, and its queue of responses waiting to be written back.
+ */
+class ClientSession
+{
+public:
+
+    friend class SocketHandler;
+    friend class TransferHandler;
+
+    /**
+     * @brief Get the unique identifier of this session. Identifiers are never reused while
+     *        the server is running, and are used to separate the handle namespace of each client.
+     */
+    unsigned int getID() const;
+
+    /**
+     * @brief Get the socket descriptor for the connection to the client
+     */
+    int getConnection() const;
+
+    /**
+     * @brief Get the address of the client, in presentation format
+     */
+    const std::string& getAddress() const;
+
+    /**
+     * @brief Queue up a response to be written to the client. A copy of the response is made.
+     *        Safe to call from any thread.
+     * @param isTagged True if the response answers a request that carried a sequence number.
+     *                 The session does not stop reading while waiting for tagged responses.
+     */
+    void addOutgoingResponse(const char *response, bool isTagged = false);
+
+    /**
+     * @brief Retrieve the next queued response, or NULL if there are none. The caller is
+     *        responsible for freeing the returned string with delete[].
+     *        Safe to call from any thread.
+     */
+    char* getNextOutgoingResponse(bool &isTagged);
+
+    ClientSession(unsigned int id, int connection, const std::string& address);
+    ~ClientSession();
+
+private:
+    ClientSession();
+
+    unsigned int _id;
+    int _connection;
+    std::string _address;
+
+    // Receive buffer. The bytes in [_receiveStart, _receiveEnd) have been read from the socket,
+    // but not consumed yet. Only accessed by the socket thread.
+    char _receiveBuf[MAX_RECEIVE_BUFFER_SIZE];
+    unsigned int _receiveStart;
+    unsigned int _receiveEnd;
+
+    // True while a message without a sequence number that needs a response is queued, but the
+    // response has not been written. Parsing stops meanwhile, so that responses stay in order.
+    bool _isAwaitingResponse;
+
+    // True once the client has switched to the binary protocol with PROT
+    bool _isBinaryProtocol;
+
+    // Datagrams for this session must carry this key. 0 until the client opens the channel.
+    unsigned int _datagramKey;
+
+    // Connections attached to this session with ATCH must give this key. 0 until the client
+    // asks for one with XFER.
+    unsigned int _transferKey;
+
+    // True once this connection has been attached to another session, to send files over
+    bool _isTransferConnection;
+
+    // True while a transfer worker receives a file sent over this connection. The socket thread
+    // leaves the session alone until the worker hands it back.
+    bool _isReceivingFile;
+
+    // True if the client connected through the Unix domain socket, from the same machine
+    bool _isLocal;
+
+    // Once the client has asked for it with SHMR, messages are read from this ring instead of
+    // from the connection. NULL until then.
+    SharedMemoryRing *_ring;
+
+    // Sequence number of the newest datagram received. Older datagrams are dropped.
+    unsigned int _lastDatagramSequence;
+    bool _hasReceivedDatagram;
+
+    // The epoll events currently being watched for this connection
+    unsigned int _watchedEvents;
+
+    // Response data that could not be written to the socket in one go. Only accessed by the
+    // socket thread.
+    std::string _pendingWrite;
+
+    std::queue<std::pair<char*, bool> > _outgoingResponses;
+    pthread_mutex_t _outMutex;
+
+    /**
+     * @brief Make room at the end of the receive buffer for another read. The unconsumed bytes
+     *        are only moved back to the start of the buffer when the end is running out of space.
+     * @return The number of bytes that can be read into _receiveSpace()
+     */
+    unsigned int _prepareReceiveSpace();
+    char* _receiveSpace();
+    void _received(unsigned int amount);
+
+    /**
+     * @brief Find the next complete frame in the receive buffer. Frames are terminated by a
+     *        null character or a newline, and the terminator is not part of the frame.
+     * @return true if a complete frame was found, false if more data is needed
+     */
+    bool _nextFrame(char*& frame, unsigned int& length) const;
+
+    char* _unconsumedData();
+    unsigned int _unconsumedBytes() const;
+    void _consume(unsigned int amount);
+};
+
+}
+
+#endif
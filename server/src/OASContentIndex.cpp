@@ -0,0 +1,278 @@
+/**
+ * @file OASContentIndex.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASContentIndex.h"
+
+using namespace oas;
+
+// Statics
+std::string             ContentIndex::_cacheDirectoryPath;
+std::string             ContentIndex::_indexPath;
+ContentIndex::StringMap ContentIndex::_filesByHash;
+ContentIndex::StringMap ContentIndex::_hashesByFile;
+pthread_mutex_t         ContentIndex::_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// SHA-256 constants, from FIPS 180-4
+static const uint32_t hashInitialState[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t hashRoundConstants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotateRight(uint32_t value, unsigned int count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+
+// static, public
+bool ContentIndex::initialize(const std::string &cacheDirectoryPath)
+{
+    std::string contentDirectoryPath = cacheDirectoryPath + "/" + CONTENT_DIRECTORY;
+
+    if (0 != mkdir(contentDirectoryPath.c_str(), 0755) && EEXIST != errno)
+    {
+        oas::Logger::errorf("ContentIndex - Could not create directory \"%s\"! %s",
+                            contentDirectoryPath.c_str(), strerror(errno));
+        return false;
+    }
+
+    pthread_mutex_lock(&_mutex);
+
+    _cacheDirectoryPath = cacheDirectoryPath;
+    _indexPath = cacheDirectoryPath + "/" + CONTENT_INDEX_FILENAME;
+    _filesByHash.clear();
+    _hashesByFile.clear();
+
+    std::ifstream indexIn(_indexPath.c_str());
+    std::string hash, filename;
+
+    // Each line holds a hash, a space, and the rest of the line is the filename
+    while (indexIn >> hash && std::getline(indexIn, filename))
+    {
+        if (filename.size() > 1 && isValidHash(hash))
+            _add(hash, filename.substr(1));
+    }
+
+    oas::Logger::logf("ContentIndex initialized with %u cached files.",
+                      (unsigned int) _hashesByFile.size());
+
+    pthread_mutex_unlock(&_mutex);
+    return true;
+}
+
+// static, public
+bool ContentIndex::isValidHash(const std::string &hash)
+{
+    if (CONTENT_HASH_LENGTH != hash.size())
+        return false;
+
+    for (unsigned int i = 0; i < hash.size(); i++)
+    {
+        if (!isdigit(hash[i]) && !(hash[i] >= 'a' && hash[i] <= 'f'))
+            return false;
+    }
+
+    return true;
+}
+
+// static, public
+std::string ContentIndex::getFileForHash(const std::string &hash)
+{
+    std::string filename;
+
+    pthread_mutex_lock(&_mutex);
+    StringMap::const_iterator iterator = _filesByHash.find(hash);
+    if (_filesByHash.end() != iterator)
+        filename = iterator->second;
+    pthread_mutex_unlock(&_mutex);
+
+    // The file may have been removed from the cache by hand
+    if (!filename.empty())
+    {
+        struct stat fileInfo;
+        std::string filePath = _cacheDirectoryPath + "/" + filename;
+
+        if (0 != stat(filePath.c_str(), &fileInfo))
+            filename.clear();
+    }
+
+    return filename;
+}
+
+// static, public
+std::string ContentIndex::getHashForFile(const std::string &filename)
+{
+    std::string hash;
+
+    pthread_mutex_lock(&_mutex);
+    StringMap::const_iterator iterator = _hashesByFile.find(filename);
+    if (_hashesByFile.end() != iterator)
+        hash = iterator->second;
+    pthread_mutex_unlock(&_mutex);
+
+    return hash;
+}
+
+// static, public
+std::string ContentIndex::getContentFilename(const std::string &hash)
+{
+    return std::string(CONTENT_DIRECTORY) + "/" + hash;
+}
+
+// static, public
+void ContentIndex::addFile(const std::string &hash, const std::string &filename)
+{
+    pthread_mutex_lock(&_mutex);
+
+    _add(hash, filename);
+
+    std::ofstream indexOut(_indexPath.c_str(), std::ios::out | std::ios::app);
+    indexOut << hash << " " << filename << "\n";
+
+    if (!indexOut.good())
+        oas::Logger::warnf("ContentIndex - Could not update \"%s\"", _indexPath.c_str());
+
+    pthread_mutex_unlock(&_mutex);
+}
+
+// static, public
+void ContentIndex::beginHash(ContentHash &hash)
+{
+    memcpy(hash.state, hashInitialState, sizeof(hash.state));
+    hash.length = 0;
+}
+
+// static, public
+void ContentIndex::updateHash(ContentHash &hash, const char *data, unsigned int size)
+{
+    const unsigned char *pos = (const unsigned char *) data;
+    unsigned int used = hash.length % CONTENT_HASH_BLOCK_SIZE;
+
+    hash.length += size;
+
+    // Fill up the block that is left over from the last update first
+    if (used)
+    {
+        unsigned int amount = CONTENT_HASH_BLOCK_SIZE - used;
+
+        if (size < amount)
+        {
+            memcpy(hash.block + used, pos, size);
+            return;
+        }
+
+        memcpy(hash.block + used, pos, amount);
+        ContentIndex::_hashBlock(hash.state, hash.block);
+        pos += amount;
+        size -= amount;
+    }
+
+    // Whole blocks are hashed straight from the data
+    for (; size >= CONTENT_HASH_BLOCK_SIZE; pos += CONTENT_HASH_BLOCK_SIZE, size -= CONTENT_HASH_BLOCK_SIZE)
+        ContentIndex::_hashBlock(hash.state, pos);
+
+    memcpy(hash.block, pos, size);
+}
+
+// static, public
+std::string ContentIndex::finishHash(ContentHash &hash)
+{
+    uint64_t bitLength = hash.length * 8;
+    unsigned int used = hash.length % CONTENT_HASH_BLOCK_SIZE;
+
+    // Pad with a single 1 bit and then 0 bits, up to the length in the last 8 bytes of a block
+    hash.block[used++] = 0x80;
+
+    if (CONTENT_HASH_BLOCK_SIZE - 8 < used)
+    {
+        memset(hash.block + used, 0, CONTENT_HASH_BLOCK_SIZE - used);
+        ContentIndex::_hashBlock(hash.state, hash.block);
+        used = 0;
+    }
+
+    memset(hash.block + used, 0, CONTENT_HASH_BLOCK_SIZE - 8 - used);
+
+    for (unsigned int i = 0; i < 8; i++)
+        hash.block[CONTENT_HASH_BLOCK_SIZE - 1 - i] = (unsigned char) (bitLength >> (8 * i));
+
+    ContentIndex::_hashBlock(hash.state, hash.block);
+
+    char buf[CONTENT_HASH_LENGTH + 1];
+
+    for (unsigned int i = 0; i < 8; i++)
+        snprintf(buf + 8 * i, 9, "%08x", hash.state[i]);
+
+    return std::string(buf);
+}
+
+// static, private
+void ContentIndex::_add(const std::string &hash, const std::string &filename)
+{
+    // The file was overwritten with different contents. Forget the old ones.
+    StringMap::iterator previous = _hashesByFile.find(filename);
+
+    if (_hashesByFile.end() != previous && previous->second != hash)
+    {
+        StringMap::iterator stale = _filesByHash.find(previous->second);
+
+        if (_filesByHash.end() != stale && stale->second == filename)
+            _filesByHash.erase(stale);
+    }
+
+    _hashesByFile[filename] = hash;
+    _filesByHash[hash] = filename;
+}
+
+// static, private
+void ContentIndex::_hashBlock(uint32_t state[8], const unsigned char *block)
+{
+    uint32_t schedule[64];
+    uint32_t a, b, c, d, e, f, g, h;
+
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        schedule[i] = ((uint32_t) block[4 * i] << 24) | ((uint32_t) block[4 * i + 1] << 16)
+                      | ((uint32_t) block[4 * i + 2] << 8) | (uint32_t) block[4 * i + 3];
+    }
+
+    for (unsigned int i = 16; i < 64; i++)
+    {
+        uint32_t s0 = rotateRight(schedule[i - 15], 7) ^ rotateRight(schedule[i - 15], 18)
+                      ^ (schedule[i - 15] >> 3);
+        uint32_t s1 = rotateRight(schedule[i - 2], 17) ^ rotateRight(schedule[i - 2], 19)
+                      ^ (schedule[i - 2] >> 10);
+
+        schedule[i] = schedule[i - 16] + s0 + schedule[i - 7] + s1;
+    }
+
+    a = state[0]; b = state[1]; c = state[2]; d = state[3];
+    e = state[4]; f = state[5]; g = state[6]; h = state[7];
+
+    for (unsigned int i = 0; i < 64; i++)
+    {
+        uint32_t t1 = h + (rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25))
+                      + ((e & f) ^ (~e & g)) + hashRoundConstants[i] + schedule[i];
+        uint32_t t2 = (rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22))
+                      + ((a & b) ^ (a & c) ^ (b & c));
+
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
@@ -0,0 +1,123 @@
+/**
+ * @file    OASContentIndex.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_CONTENT_INDEX_H_
+#define _OAS_CONTENT_INDEX_H_
+
+#include <string>
+#include <map>
+#include <fstream>
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "OASFileHandler.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Name of the index file, inside the cache directory
+#define CONTENT_INDEX_FILENAME      "content_index"
+
+// Files that are uploaded by content are cached in this subdirectory, named after their hash
+#define CONTENT_DIRECTORY           "content"
+
+// Content hashes are SHA-256 hashes, written out as lower case hexadecimal digits. Files are
+// reused by hash alone, so the hash has to be one that nobody can find collisions for.
+#define CONTENT_HASH_LENGTH         64
+#define CONTENT_HASH_BLOCK_SIZE     64
+
+/**
+ * The state of a content hash that is being computed, see ContentIndex::beginHash()
+ */
+struct ContentHash
+{
+    uint32_t state[8];
+    unsigned char block[CONTENT_HASH_BLOCK_SIZE];
+    uint64_t length;
+};
+
+/**
+ * Keeps track of the content hash of each file in the cache, so that clients can find a cached
+ * file by its contents instead of its name, and only upload files that the server does not have.
+ * Files with the same contents have the same hash, regardless of their names.
+ *
+ * The index is kept on disk in the cache directory, so it survives restarts of the server. It is
+ * an append-only list of "<hash> <filename>" lines, where later lines override earlier ones.
+ *
+ * Safe to call from any thread.
+ */
+class ContentIndex
+{
+public:
+
+    /**
+     * @brief Load the index from the cache directory, and create the directory for files that
+     *        are uploaded by content. FileHandler must be initialized first.
+     */
+    static bool initialize(const std::string &cacheDirectoryPath);
+
+    /**
+     * @brief Check that a hash from a client is well formed, so that it can safely be used as
+     *        a filename
+     */
+    static bool isValidHash(const std::string &hash);
+
+    /**
+     * @brief Get the name of a cached file with the given hash
+     * @return The filename, relative to the cache directory, or an empty string if no file with
+     *         the hash is cached
+     */
+    static std::string getFileForHash(const std::string &hash);
+
+    /**
+     * @brief Get the hash of a cached file
+     * @return The hash, or an empty string if the file was not added to the index
+     */
+    static std::string getHashForFile(const std::string &filename);
+
+    /**
+     * @brief Get the name that a file uploaded by content is cached under
+     */
+    static std::string getContentFilename(const std::string &hash);
+
+    /**
+     * @brief Record the hash of a file that was just written to the cache. Replaces whatever
+     *        was recorded for the same filename before.
+     */
+    static void addFile(const std::string &hash, const std::string &filename);
+
+    /**
+     * @brief Functions to compute a content hash incrementally. Start with beginHash(), pass
+     *        all of the data through updateHash(), and get the result from finishHash(), after
+     *        which the state can not be updated any more.
+     */
+    static void beginHash(ContentHash &hash);
+    static void updateHash(ContentHash &hash, const char *data, unsigned int size);
+    static std::string finishHash(ContentHash &hash);
+
+private:
+
+    typedef std::map<std::string, std::string> StringMap;
+
+    static std::string _cacheDirectoryPath;
+    static std::string _indexPath;
+
+    // hash -> filename, and filename -> hash
+    static StringMap _filesByHash;
+    static StringMap _hashesByFile;
+
+    static pthread_mutex_t _mutex;
+
+    static void _add(const std::string &hash, const std::string &filename);
+    static void _hashBlock(uint32_t state[8], const unsigned char *block);
+};
+
+}
+
+#endif
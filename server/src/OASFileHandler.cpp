@@ -52,62 +52,138 @@ bool FileHandler::doesFileExist(const std::string& filePath)
 
 bool FileHandler::writeFile(const std::string& filename, const char *data, unsigned int size)
 {
-    std::string fileOutPath = FileHandler::_cacheDirectoryPath + "/" + filename;
-    std::ofstream fileOut (fileOutPath.c_str(), std::ios::out | std::ios::binary);
+    std::string tempPath;
+    int fileDescriptor = createTemporaryFile(filename, tempPath);
 
-    if (!fileOut.is_open() || fileOut.bad())
+    if (-1 == fileDescriptor)
+        return false;
+
+    if (!writeToFile(fileDescriptor, data, size))
     {
-        oas::Logger::errorf("FileHandler - Could not create file \"%s\"!",
-                            fileOutPath.c_str());
-        fileOut.close();
+        discardTemporaryFile(fileDescriptor, tempPath);
         return false;
     }
 
-    fileOut.write(data, size);
+    return commitTemporaryFile(fileDescriptor, tempPath, filename);
+}
+
+int FileHandler::createTemporaryFile(const std::string& filename, std::string& tempPath)
+{
+    // The temporary file must be on the same file system as the cache, for rename() to work
+    std::string pathTemplate = FileHandler::_cacheDirectoryPath + "/" + filename + ".partXXXXXX";
+    char path[MAX_PATH_SIZE];
 
-    if (fileOut.bad())
+    if (pathTemplate.size() >= MAX_PATH_SIZE)
     {
-        oas::Logger::errorf("FileHandler - Writing to file \"%s\" failed. Data may be corrupted.",
-                            fileOutPath.c_str());
-        fileOut.close();
-        return false;
+        oas::Logger::errorf("FileHandler - The path for \"%s\" is too long!", filename.c_str());
+        return -1;
     }
 
-    fileOut.close();
-    return true;
+    strcpy(path, pathTemplate.c_str());
+
+    int fileDescriptor = mkstemp(path);
+
+    if (-1 == fileDescriptor)
+    {
+        oas::Logger::errorf("FileHandler - Could not create a temporary file for \"%s\"! %s",
+                            filename.c_str(), strerror(errno));
+        return -1;
+    }
+
+    // mkstemp() only gives the owner access. Make it readable like any other cached file.
+    fchmod(fileDescriptor, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+
+    tempPath = path;
+    return fileDescriptor;
 }
 
-void* FileHandler::readFile(const std::string& filename, int& fileSize)
+bool FileHandler::writeToFile(int fileDescriptor, const char *data, unsigned int size)
 {
-    std::string filePath;
-    struct stat fileInfo;
-    char *data;
+    while (size > 0)
+    {
+        ssize_t amountWritten = write(fileDescriptor, data, size);
 
-    // Create string to hold the cache directory plus the filename
-    filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
+        if (-1 == amountWritten)
+        {
+            if (EINTR == errno)
+                continue;
 
-    // Locate the file and gather information using stat()
-    if (0 != stat(filePath.c_str(), &fileInfo)) // stat returns 0 on success
-    {
-        oas::Logger::warnf("FileHandler - Could not access \"%s\"", filePath.c_str());
-        return NULL;
+            oas::Logger::errorf("FileHandler - Writing to file failed! %s", strerror(errno));
+            return false;
+        }
+
+        data += amountWritten;
+        size -= amountWritten;
     }
 
-    data = new char[fileInfo.st_size];
+    return true;
+}
 
-    std::ifstream fileIn(filePath.c_str(), std::ios::in | std::ios::binary);
-    fileIn.read(data, fileInfo.st_size);
+bool FileHandler::commitTemporaryFile(int fileDescriptor, const std::string& tempPath,
+                                      const std::string& filename)
+{
+    std::string filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
 
-    if (fileIn.bad())
+    if (0 != close(fileDescriptor))
     {
-        oas::Logger::errorf("FileHandler - Failed to read \"%s\" from disk.",
-                            filePath.c_str());
-        delete[] data;
-        return NULL;
+        oas::Logger::errorf("FileHandler - Writing to file \"%s\" failed. %s",
+                            tempPath.c_str(), strerror(errno));
+        unlink(tempPath.c_str());
+        return false;
+    }
+
+    if (0 != rename(tempPath.c_str(), filePath.c_str()))
+    {
+        oas::Logger::errorf("FileHandler - Could not move \"%s\" to \"%s\"! %s",
+                            tempPath.c_str(), filePath.c_str(), strerror(errno));
+        unlink(tempPath.c_str());
+        return false;
     }
 
-    fileSize = fileInfo.st_size;
-    return data;
+    return true;
+}
+
+void FileHandler::discardTemporaryFile(int fileDescriptor, const std::string& tempPath)
+{
+    close(fileDescriptor);
+    unlink(tempPath.c_str());
+}
+
+bool FileHandler::readFile(const std::string& filename, MappedFile& file)
+{
+    // Create string to hold the cache directory plus the filename
+    std::string filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
+
+    return file.map(filePath);
+}
+
+off_t FileHandler::getFileSize(const std::string& filename)
+{
+    std::string filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
+    struct stat fileInfo;
+
+    if (0 != stat(filePath.c_str(), &fileInfo))
+        return -1;
+
+    return fileInfo.st_size;
+}
+
+bool FileHandler::getFileInfo(const std::string& filename, struct stat& fileInfo)
+{
+    std::string filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
+
+    return (0 == stat(filePath.c_str(), &fileInfo));
+}
+
+int FileHandler::openFile(const std::string& filename)
+{
+    std::string filePath = FileHandler::_cacheDirectoryPath + "/" + filename;
+    int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+
+    if (-1 == fileDescriptor)
+        oas::Logger::warnf("FileHandler - Could not open \"%s\"", filePath.c_str());
+
+    return fileDescriptor;
 }
 
 bool FileHandler::loadXML(const std::string& filename, const std::string& root)
@@ -199,6 +275,38 @@ bool FileHandler::findXML(const char *name, const char *attr, const char *value,
     }
 }
 
+bool FileHandler::findAllXML(const char *parent, const char *name, std::vector<std::string>& output)
+{
+    if (!this->_root)
+    {
+        oas::Logger::errorf("FileHandler - No valid XML file initialized!");
+        return false;
+    }
+
+    mxml_node_t *parentNode = mxmlFindElement(this->_root,
+                                              this->_root,
+                                              parent,
+                                              NULL,
+                                              NULL,
+                                              MXML_DESCEND_FIRST);
+
+    if (!parentNode)
+        return false;
+
+    mxml_node_t *node = mxmlFindElement(parentNode, parentNode, name, NULL, NULL,
+                                        MXML_DESCEND_FIRST);
+
+    while (node)
+    {
+        if (node->child && node->child->value.opaque)
+            output.push_back(node->child->value.opaque);
+
+        node = mxmlFindElement(node, parentNode, name, NULL, NULL, MXML_NO_DESCEND);
+    }
+
+    return true;
+}
+
 FileHandler::FileHandler()
 {
     this->_tree = NULL;
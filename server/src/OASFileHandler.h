@@ -9,13 +9,19 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 #include <limits.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
 #include <mxml.h>
 #include "OASLogger.h"
+#include "OASMappedFile.h"
 
 /**
  * Although these max sizes are somewhat arbitrary, they should still prevent overflow.
@@ -61,13 +67,70 @@ public:
     bool writeFile(const std::string& filename, const char *data, unsigned int size);
 
     /**
-     * @brief Reads data from file, allocates space for it on the heap
+     * @brief Creates an empty temporary file in the same directory that filename will be
+     *        cached in, so that a file can be written in pieces without replacing the cached
+     *        copy until it is complete
+     * @param filename Name of the file that the temporary file will become
+     * @param tempPath Will contain the path of the temporary file
+     * @return Descriptor of the temporary file, open for writing
+     * @retval -1 on failure
+     */
+    int createTemporaryFile(const std::string& filename, std::string& tempPath);
+
+    /**
+     * @brief Writes all of data to a descriptor, retrying partial writes
+     * @retval True Write was successful
+     * @retval False Write failed
+     */
+    bool writeToFile(int fileDescriptor, const char *data, unsigned int size);
+
+    /**
+     * @brief Closes a temporary file and atomically renames it to filename in the cache,
+     *        replacing any existing file. The temporary file is removed on failure.
+     * @retval True The file is now cached as filename
+     * @retval False Closing or renaming failed
+     */
+    bool commitTemporaryFile(int fileDescriptor, const std::string& tempPath,
+                             const std::string& filename);
+
+    /**
+     * @brief Closes and removes a temporary file that will not be committed
+     */
+    void discardTemporaryFile(int fileDescriptor, const std::string& tempPath);
+
+    /**
+     * @brief Maps a file in the cache into memory, read-only
      * @param filename Name of file to read
-     * @param fileSize Will contain the size in bytes of the file that is read.
-     * @return Pointer to allocated data. The caller needs to free it when finished
-     * @retval NULL on failure
+     * @param file Will hold the contents of the file, until it is released or goes out of scope
+     * @retval True The file was read
+     * @retval False The file could not be read, or is empty
      */
-    void* readFile(const std::string& filename, int& fileSize);
+    bool readFile(const std::string& filename, MappedFile& file);
+
+    /**
+     * @brief Gets the size of a file in the cache
+     * @param filename Name of file to check
+     * @return Size of the file in bytes
+     * @retval -1 on failure
+     */
+    off_t getFileSize(const std::string& filename);
+
+    /**
+     * @brief Gets the size, modification time and other information of a file in the cache
+     * @param filename Name of file to check
+     * @param fileInfo Will contain the information, as returned by stat()
+     * @retval True The file exists
+     * @retval False The file does not exist or cannot be accessed
+     */
+    bool getFileInfo(const std::string& filename, struct stat& fileInfo);
+
+    /**
+     * @brief Opens a file in the cache for reading, for files that are read in pieces
+     * @param filename Name of file to open
+     * @return Descriptor of the file. The caller needs to close it when finished
+     * @retval -1 on failure
+     */
+    int openFile(const std::string& filename);
 
     /**
      * @brief Loads an XML file for parsing
@@ -94,6 +157,17 @@ public:
      */
     bool findXML(const char *name, const char *attr, const char *value, std::string& output);
 
+    /**
+     * @brief Looks up every element with the given name inside an element of the currently
+     *        loaded XML file
+     * @param parent Name of the element that contains the elements
+     * @param name Name of the elements
+     * @param output The contents of each element that was found are appended to this
+     * @retval True The parent element was found
+     * @retval False Parent element not found
+     */
+    bool findAllXML(const char *parent, const char *name, std::vector<std::string>& output);
+
     /**
      * @brief 
      */
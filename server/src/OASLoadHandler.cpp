@@ -0,0 +1,173 @@
+/**
+ * @file OASLoadHandler.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASLoadHandler.h"
+
+using namespace oas;
+
+// Statics
+std::vector<pthread_t>              LoadHandler::_workers;
+std::queue<LoadHandler::Load>       LoadHandler::_loads;
+pthread_mutex_t                     LoadHandler::_loadsMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t                      LoadHandler::_loadsCondition = PTHREAD_COND_INITIALIZER;
+std::queue<LoadHandler::Load>       LoadHandler::_finishedLoads;
+pthread_mutex_t                     LoadHandler::_finishedLoadsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+// static, public
+bool LoadHandler::initialize(unsigned int numWorkers)
+{
+    // Thread attribute variable
+    pthread_attr_t threadAttr;
+
+    pthread_attr_init(&threadAttr);
+    pthread_attr_setdetachstate(&threadAttr, PTHREAD_CREATE_JOINABLE);
+
+    for (unsigned int i = 0; i < numWorkers; i++)
+    {
+        pthread_t worker;
+
+        if (pthread_create(&worker, &threadAttr, &LoadHandler::_workerLoop, NULL))
+        {
+            oas::Logger::errorf("LoadHandler - Failed to create a worker thread.");
+            pthread_attr_destroy(&threadAttr);
+            return false;
+        }
+
+        LoadHandler::_workers.push_back(worker);
+    }
+
+    pthread_attr_destroy(&threadAttr);
+
+    if (numWorkers)
+        oas::Logger::logf("LoadHandler initialized with up to %u parallel loads...", numWorkers);
+    else
+        oas::Logger::logf("LoadHandler - Sound files are loaded by the server thread.");
+
+    return true;
+}
+
+// static, public
+void LoadHandler::terminate()
+{
+    for (unsigned int i = 0; i < LoadHandler::_workers.size(); i++)
+        pthread_cancel(LoadHandler::_workers[i]);
+
+    for (unsigned int i = 0; i < LoadHandler::_workers.size(); i++)
+        pthread_join(LoadHandler::_workers[i], NULL);
+
+    LoadHandler::_workers.clear();
+
+    // Nobody is going to take the loads that finished in the meantime
+    Load load;
+
+    while (LoadHandler::takeFinishedLoad(load))
+        delete load.sound;
+}
+
+// static, public
+bool LoadHandler::isEnabled()
+{
+    return !LoadHandler::_workers.empty();
+}
+
+// static, public
+void LoadHandler::addLoad(const std::string &key, const std::string &filename)
+{
+    Load load;
+    load.key = key;
+    load.filename = filename;
+    load.sound = NULL;
+    load.duration = 0;
+
+    pthread_mutex_lock(&LoadHandler::_loadsMutex);
+    LoadHandler::_loads.push(load);
+    pthread_cond_signal(&LoadHandler::_loadsCondition);
+    pthread_mutex_unlock(&LoadHandler::_loadsMutex);
+}
+
+// static, public
+bool LoadHandler::takeFinishedLoad(Load &load)
+{
+    pthread_mutex_lock(&LoadHandler::_finishedLoadsMutex);
+
+    bool hasLoad = !LoadHandler::_finishedLoads.empty();
+
+    if (hasLoad)
+    {
+        load = LoadHandler::_finishedLoads.front();
+        LoadHandler::_finishedLoads.pop();
+    }
+
+    pthread_mutex_unlock(&LoadHandler::_finishedLoadsMutex);
+
+    return hasLoad;
+}
+
+// static, private
+void* LoadHandler::_workerLoop(void *)
+{
+    int cancelState;
+
+    while (1)
+    {
+        Load load;
+
+        pthread_mutex_lock(&LoadHandler::_loadsMutex);
+
+        // A worker that is cancelled while waiting holds the lock again, and must give it back
+        pthread_cleanup_push(&LoadHandler::_unlockLoads, NULL);
+
+        while (LoadHandler::_loads.empty())
+        {
+            pthread_cond_wait(&LoadHandler::_loadsCondition,
+                              &LoadHandler::_loadsMutex);
+        }
+
+        load = LoadHandler::_loads.front();
+        LoadHandler::_loads.pop();
+
+        pthread_cleanup_pop(1);
+
+        // A load is never cut short by cancellation, which would leak the sound data and leave
+        // the temporary file of its decoded copy behind. terminate() waits for it instead.
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+
+        LoadHandler::_load(load);
+
+        pthread_mutex_lock(&LoadHandler::_finishedLoadsMutex);
+        LoadHandler::_finishedLoads.push(load);
+        pthread_mutex_unlock(&LoadHandler::_finishedLoadsMutex);
+
+        pthread_setcancelstate(cancelState, NULL);
+    }
+
+    return NULL;
+}
+
+// static, private
+void LoadHandler::_unlockLoads(void *)
+{
+    pthread_mutex_unlock(&LoadHandler::_loadsMutex);
+}
+
+// static, private
+void LoadHandler::_load(Load &load)
+{
+    Time start, end;
+
+    start.update(Time::OAS_CLOCK_MONOTONIC);
+
+    load.sound = new PCMCache::Sound();
+
+    if (!PCMCache::load(load.filename, *load.sound))
+    {
+        delete load.sound;
+        load.sound = NULL;
+    }
+
+    end.update(Time::OAS_CLOCK_MONOTONIC);
+    load.duration = (end - start).asDouble();
+}
@@ -0,0 +1,100 @@
+/**
+ * @file    OASLoadHandler.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_LOAD_HANDLER_H_
+#define _OAS_LOAD_HANDLER_H_
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <cstdlib>
+#include <pthread.h>
+#include <AL/alut.h>
+
+#include "OASPCMCache.h"
+#include "OASLogger.h"
+#include "OASTime.h"
+
+namespace oas
+{
+
+// Number of sound files that can be loaded at the same time, if the configuration does not say
+#define DEFAULT_MAX_PARALLEL_LOADS  2
+
+/**
+ * Loads sound files in the background. A pool of worker threads reads each file from the cache
+ * and decodes it into PCM data, so that the server thread, which also applies every position
+ * update, never waits for the disk or the decoder. Files that were decoded before are mapped from
+ * their decoded copies instead. The decoded data is handed back to the server thread, which creates
+ * the OpenAL buffer from it.
+ */
+class LoadHandler
+{
+public:
+
+    /**
+     * A file that was loaded, or failed to load
+     */
+    struct Load
+    {
+        // Name the load was requested under, and the file in the cache that was loaded
+        std::string key;
+        std::string filename;
+
+        // Decoded sound data, or NULL if the file could not be loaded
+        PCMCache::Sound *sound;
+
+        // Seconds spent reading and decoding the file
+        double duration;
+    };
+
+    /**
+     * @brief Start the worker threads.
+     * @param numWorkers Number of files that can be loaded at the same time. With 0, files are
+     *                   loaded by the server thread when they are needed.
+     */
+    static bool initialize(unsigned int numWorkers);
+    static void terminate();
+
+    /**
+     * @brief Check whether files are loaded in the background
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Queue up a file to be loaded by the next free worker
+     * @param key Name that the finished load is returned with
+     * @param filename Name of the file in the cache
+     */
+    static void addLoad(const std::string &key, const std::string &filename);
+
+    /**
+     * @brief Take the next load that has finished. The caller needs to delete its sound.
+     * @return false if no load has finished
+     */
+    static bool takeFinishedLoad(Load &load);
+
+private:
+
+    static std::vector<pthread_t> _workers;
+
+    static std::queue<Load> _loads;
+    static pthread_mutex_t _loadsMutex;
+    static pthread_cond_t _loadsCondition;
+
+    static std::queue<Load> _finishedLoads;
+    static pthread_mutex_t _finishedLoadsMutex;
+
+    static void* _workerLoop(void *parameter);
+    static void _unlockLoads(void *parameter);
+    static void _load(Load &load);
+
+    LoadHandler();
+    ~LoadHandler();
+};
+
+}
+
+#endif
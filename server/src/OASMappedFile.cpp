@@ -0,0 +1,138 @@
+/**
+ * @file OASMappedFile.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASMappedFile.h"
+
+// The logger includes the file handler, which needs this class first
+#include "OASLogger.h"
+
+using namespace oas;
+
+MappedFile::MappedFile() :
+    _data(NULL),
+    _size(0),
+    _isMapped(false)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+// public
+bool MappedFile::map(const std::string &filePath)
+{
+    struct stat fileInfo;
+
+    release();
+
+    int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+
+    if (-1 == fileDescriptor)
+    {
+        oas::Logger::warnf("MappedFile - Could not access \"%s\"", filePath.c_str());
+        return false;
+    }
+
+    if (0 != fstat(fileDescriptor, &fileInfo))
+    {
+        oas::Logger::warnf("MappedFile - Could not access \"%s\"", filePath.c_str());
+        close(fileDescriptor);
+        return false;
+    }
+
+    // A mapping cannot be empty
+    if (0 >= fileInfo.st_size)
+    {
+        oas::Logger::warnf("MappedFile - \"%s\" is empty", filePath.c_str());
+        close(fileDescriptor);
+        return false;
+    }
+
+    _size = fileInfo.st_size;
+
+    void *data = mmap(NULL, _size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+
+    if (MAP_FAILED == data)
+    {
+        // Some file systems cannot be mapped
+        bool isRead = _readIntoMemory(fileDescriptor, filePath);
+        close(fileDescriptor);
+        return isRead;
+    }
+
+    // The mapping stays valid without the descriptor
+    close(fileDescriptor);
+
+    _data = data;
+    _isMapped = true;
+
+    // The file is read once from start to end, so read ahead of the reader aggressively, and start
+    // reading right away. Neither is required for the mapping to work.
+    madvise(_data, _size, MADV_SEQUENTIAL);
+    madvise(_data, _size, MADV_WILLNEED);
+
+    return true;
+}
+
+// private
+bool MappedFile::_readIntoMemory(int fileDescriptor, const std::string &filePath)
+{
+    char *data = new char[_size];
+    size_t position = 0;
+
+    while (position < _size)
+    {
+        ssize_t count = pread(fileDescriptor, data + position, _size - position, position);
+
+        if (-1 == count && EINTR == errno)
+            continue;
+
+        if (0 >= count)
+        {
+            oas::Logger::errorf("MappedFile - Failed to read \"%s\" from disk.", filePath.c_str());
+            delete[] data;
+            _size = 0;
+            return false;
+        }
+
+        position += count;
+    }
+
+    _data = data;
+    _isMapped = false;
+
+    return true;
+}
+
+// public
+void MappedFile::release()
+{
+    if (_data)
+    {
+        if (_isMapped)
+            munmap(_data, _size);
+        else
+            delete[] (char *) _data;
+    }
+
+    _data = NULL;
+    _size = 0;
+    _isMapped = false;
+}
+
+// public
+const void* MappedFile::getData() const
+{
+    return _data;
+}
+
+// public
+size_t MappedFile::getSize() const
+{
+    return _size;
+}
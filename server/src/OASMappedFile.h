@@ -0,0 +1,76 @@
+/**
+ * @file    OASMappedFile.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_MAPPED_FILE_H_
+#define _OAS_MAPPED_FILE_H_
+
+#include <string>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+
+namespace oas
+{
+
+/**
+ * The contents of a file, mapped read-only into memory. The pages are read in by the kernel as
+ * they are touched, straight from the page cache, so the file is never copied into a buffer of
+ * its own. The mapping is released when the object goes out of scope.
+ *
+ * Files in the cache are only ever replaced by renaming a new file over them, so a mapping keeps
+ * seeing the old contents, and is never cut short underneath its reader.
+ */
+class MappedFile
+{
+public:
+
+    /**
+     * @brief Map the whole file at filePath, releasing whatever was mapped before. If the file
+     *        cannot be mapped, it is read into memory instead.
+     * @retval True The contents of the file are available through getData()
+     * @retval False The file could not be opened or read, or is empty
+     */
+    bool map(const std::string &filePath);
+
+    /**
+     * @brief Unmap the file
+     */
+    void release();
+
+    /**
+     * @brief Get the contents of the file, or NULL if nothing is mapped
+     */
+    const void* getData() const;
+
+    /**
+     * @brief Get the size of the file in bytes
+     */
+    size_t getSize() const;
+
+    MappedFile();
+    ~MappedFile();
+
+private:
+
+    void *_data;
+    size_t _size;
+
+    // False if the contents were read into memory from new[], because mmap() failed
+    bool _isMapped;
+
+    bool _readIntoMemory(int fileDescriptor, const std::string &filePath);
+
+    // A mapping has exactly one owner
+    MappedFile(const MappedFile &other);
+    MappedFile& operator=(const MappedFile &other);
+};
+
+}
+
+#endif
@@ -8,6 +8,8 @@
 
 using namespace oas;
 
+bool Message::_keepOriginalString = false;
+
 Message::Message()
 {
     _init();
@@ -28,6 +30,9 @@ Message::Message(const Message& other)
     _errorType = other.getError();
     _filename = other.getFilename();
     _originalString = other.getOriginalString();
+    _sessionID = other.getSessionID();
+    _hasSequenceNumber = other.hasSequenceNumber();
+    _sequenceNumber = other.getSequenceNumber();
 
     for (int i = 0; i < MAX_NUMBER_FLOAT_PARAM; i++)
     {
@@ -35,17 +40,58 @@ Message::Message(const Message& other)
     }
 }
 
+// Copies everything, like the assignment the compiler would have declared
+Message& Message::operator=(const Message& other)
+{
+    if (this == &other)
+        return *this;
+
+    _mtype = other._mtype;
+    _handle = other._handle;
+    _filename = other._filename;
+    _iParam = other._iParam;
+    _needsResponse = other._needsResponse;
+    _errorType = other._errorType;
+    _originalString = other._originalString;
+    _sessionID = other._sessionID;
+    _hasSequenceNumber = other._hasSequenceNumber;
+    _sequenceNumber = other._sequenceNumber;
+
+    for (int i = 0; i < MAX_NUMBER_FLOAT_PARAM; i++)
+    {
+        _fParams[i] = other._fParams[i];
+    }
+
+    start = other.start;
+    added = other.added;
+    retrieved = other.retrieved;
+    processed = other.processed;
+
+    return *this;
+}
+
 Message::~Message()
 {
 
 }
 
+// public
+void Message::clear()
+{
+    _init();
+    _filename.clear();
+    _originalString.clear();
+}
+
 // private
 void Message::_init()
 {
     _mtype = Message::MT_UNKNOWN;
     _handle = AL_NONE;
     _iParam = 0;
+    _sessionID = 0;
+    _hasSequenceNumber = false;
+    _sequenceNumber = 0;
     gettimeofday(&start, NULL);
 
     for (int i = 0; i < MAX_NUMBER_FLOAT_PARAM; i++)
@@ -57,148 +103,263 @@ void Message::_init()
     _errorType = MERROR_NONE;
 }
 
+// Powers of ten that are exactly representable as a double
+static const double kExactPowersOfTen[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define MAX_EXACT_POWER_OF_TEN      22
+#define MAX_EXACT_DOUBLE_MANTISSA   (1ULL << 53)
+
+static inline bool isTokenDelimiter(char c)
+{
+    return ' ' == c || ',' == c || ';' == c || '\n' == c || '\r' == c || '\t' == c;
+}
+
 // private
-bool Message::_parseStringGetString(char* string, char*& pEnd, char*& result)
+bool Message::_nextToken(const char*& pos, const char *end)
 {
-    char *pChar;
+    // Skip over the delimiters that separate tokens
+    while (pos < end && isTokenDelimiter(*pos))
+        pos++;
 
-    pChar = strtok(string, " ,;\n\r\t");
-    if (!pChar)
+    // A null character marks the end of the message
+    if (pos >= end || !*pos)
     {
         _errorType = MERROR_INCOMPLETE_MESSAGE;
         return false;
     }
-    _errorType = MERROR_NONE;
-    pEnd = pChar + strlen(pChar);
-    result = pChar;
 
     return true;
 }
 
-//private
-bool Message::_parseStringGetLong(char *string, char*& pEnd, long& result)
+// private
+const char* Message::_tokenEnd(const char *pos, const char *end) const
 {
-    char *pChar, *endp;
-    long res;
-    
-    pChar = strtok(string, " ,;\n\r\t");
-    if (!pChar)
-    {
-        _errorType = MERROR_INCOMPLETE_MESSAGE;
+    while (pos < end && *pos && !isTokenDelimiter(*pos))
+        pos++;
+
+    return pos;
+}
+
+// private
+bool Message::_parseTokenLong(const char*& pos, const char *end, long& result)
+{
+    if (!_nextToken(pos, end))
         return false;
-    }
 
-    pEnd = pChar + strlen(pChar);
+    const char *pChar = pos;
+    const char *pEnd = _tokenEnd(pos, end);
+    bool isNegative = false;
+    unsigned long value = 0;
 
-    res = strtol(pChar, &endp, 10);
-    if (*endp)
+    if ('-' == *pChar || '+' == *pChar)
+    {
+        isNegative = ('-' == *pChar);
+        pChar++;
+    }
+
+    // There must be at least one digit, and nothing but digits
+    if (pChar == pEnd)
     {
         _errorType = MERROR_BAD_FORMAT;
         return false;
     }
-    
+
+    for (; pChar < pEnd; pChar++)
+    {
+        unsigned int digit = (unsigned int) (*pChar - '0');
+
+        if (digit > 9 || value > ((unsigned long) LONG_MAX - digit) / 10)
+        {
+            _errorType = MERROR_BAD_FORMAT;
+            return false;
+        }
+
+        value = value * 10 + digit;
+    }
+
     _errorType = MERROR_NONE;
-    result = res;
+    result = isNegative ? -((long) value) : (long) value;
+    pos = pEnd;
 
     return true;
 }
 
 // private
-bool Message::_parseStringGetFloat(char *string, char*& pEnd, ALfloat& result)
+bool Message::_parseTokenFloat(const char*& pos, const char *end, ALfloat& result)
 {
-    char *pChar, *endp;
-    ALfloat res;
+    if (!_nextToken(pos, end))
+        return false;
+
+    const char *pChar = pos;
+    const char *pEnd = _tokenEnd(pos, end);
+    bool isNegative = false;
+    unsigned long long mantissa = 0;
+    int numDigits = 0, numSignificantDigits = 0, exponent = 0;
 
-    pChar = strtok(string, " ,;\n\r\t");
-    if (!pChar)
+    if ('-' == *pChar || '+' == *pChar)
     {
-        _errorType = MERROR_INCOMPLETE_MESSAGE;
-        return false;
+        isNegative = ('-' == *pChar);
+        pChar++;
     }
 
-    pEnd = pChar + strlen(pChar);
+    // Integer part. Leading zeros are not significant.
+    for (; pChar < pEnd && isdigit(*pChar); pChar++, numDigits++)
+    {
+        if (mantissa || '0' != *pChar)
+        {
+            mantissa = mantissa * 10 + (*pChar - '0');
+            numSignificantDigits++;
+        }
+    }
 
-    res = (ALfloat) strtod(pChar, &endp);
-    
-    if (*endp)
+    // Fractional part
+    if (pChar < pEnd && '.' == *pChar)
     {
-        _errorType = MERROR_BAD_FORMAT;
-        return false;
+        for (pChar++; pChar < pEnd && isdigit(*pChar); pChar++, numDigits++)
+        {
+            if (mantissa || '0' != *pChar)
+            {
+                mantissa = mantissa * 10 + (*pChar - '0');
+                numSignificantDigits++;
+            }
+            exponent--;
+        }
     }
 
-    _errorType = MERROR_NONE;
-    result = res;
+    // Exponent
+    if (numDigits && pChar < pEnd && ('e' == *pChar || 'E' == *pChar))
+    {
+        const char *pExponent = pChar + 1;
+        bool isExponentNegative = false;
+        int exponentValue = 0;
 
-    return true;
-}
+        if (pExponent < pEnd && ('-' == *pExponent || '+' == *pExponent))
+        {
+            isExponentNegative = ('-' == *pExponent);
+            pExponent++;
+        }
 
-// private
-bool Message::_validateParseAmounts(char *startBuf, char *pEnd, const int maxParseAmount, int& totalParsed)
-{
-    int amountParsed = pEnd - startBuf;
+        if (pExponent < pEnd && isdigit(*pExponent))
+        {
+            for (; pExponent < pEnd && isdigit(*pExponent); pExponent++)
+            {
+                if (exponentValue < 10000)
+                    exponentValue = exponentValue * 10 + (*pExponent - '0');
+            }
+            exponent += isExponentNegative ? -exponentValue : exponentValue;
+            pChar = pExponent;
+        }
+    }
 
-    if ( maxParseAmount < amountParsed)
+    // Fast path: the whole token is a plain decimal number whose mantissa and power of ten are
+    // both exact in a double, so a single multiply or divide gives the correctly rounded value
+    if (numDigits && pChar == pEnd && numSignificantDigits <= 19
+        && mantissa <= MAX_EXACT_DOUBLE_MANTISSA
+        && exponent >= -MAX_EXACT_POWER_OF_TEN && exponent <= MAX_EXACT_POWER_OF_TEN)
     {
-        _errorType = MERROR_INCOMPLETE_MESSAGE;
+        double value = (double) mantissa;
+
+        if (exponent < 0)
+            value /= kExactPowersOfTen[-exponent];
+        else
+            value *= kExactPowersOfTen[exponent];
+
+        _errorType = MERROR_NONE;
+        result = (ALfloat) (isNegative ? -value : value);
+        pos = pEnd;
+
+        return true;
+    }
+
+    // Slow path for anything else: long mantissas, large exponents, and the forms that only
+    // strtod() understands. strtod() needs a null terminated copy of the token.
+    char numberBuf[MAX_NUMERIC_TOKEN_SIZE];
+    int length = pEnd - pos;
+    char *endp;
+
+    if (length >= MAX_NUMERIC_TOKEN_SIZE)
+    {
+        _errorType = MERROR_BAD_FORMAT;
         return false;
     }
-    else
+
+    memcpy(numberBuf, pos, length);
+    numberBuf[length] = '\0';
+
+    double value = strtod(numberBuf, &endp);
+
+    if (endp == numberBuf || *endp)
     {
-        totalParsed = amountParsed;
-        return true;
+        _errorType = MERROR_BAD_FORMAT;
+        return false;
     }
+
+    _errorType = MERROR_NONE;
+    result = (ALfloat) value;
+    pos = pEnd;
+
+    return true;
 }
 
 // private
-bool Message::_parseHandleParameter(char *startBuf, char*& pEnd, const int maxParseAmount, int& totalParsed)
+bool Message::_parseHandleParameter(const char*& pos, const char *end)
 {
     long longVal;
-    
-    if (_parseStringGetLong(NULL, pEnd, longVal) 
-        && _validateParseAmounts(startBuf, pEnd, maxParseAmount, totalParsed))
+
+    if (_parseTokenLong(pos, end, longVal))
     {
         _handle = (ALuint) longVal;
         return true;
     }
-   
+
     return false;
 }
 
 // private
-bool Message::_parseFilenameParameter(char *startBuf, char*& pEnd, const int maxParseAmount, int& totalParsed)
+bool Message::_parseFilenameParameter(const char*& pos, const char *end)
 {
-    char *pChar;
-    
-    if (_parseStringGetString(NULL, pEnd, pChar)
-        && _validateParseAmounts(startBuf, pEnd, maxParseAmount, totalParsed))
-    {
-        if (pChar)
-        {
-            // Skip over any leading non-alphanumeric characters in the filename
-            // i.e. converts "./directory/file" to "directory/file"
-            while (*pChar && !isalnum(*pChar))
-                pChar++;
-                
-            char *locateSlash = strrchr(pChar, '/');
+    if (!_nextToken(pos, end))
+        return false;
 
-            if (locateSlash)
-                pChar = locateSlash + 1;
+    const char *pEnd = _tokenEnd(pos, end);
 
-        }
-        _filename = pChar;
-        return true;
+    _setFilename(pos, pEnd);
+    _errorType = MERROR_NONE;
+    pos = pEnd;
+
+    return true;
+}
+
+// private
+void Message::_setFilename(const char *start, const char *end)
+{
+    const char *pChar = start;
+
+    // Skip over any leading non-alphanumeric characters in the filename
+    // i.e. converts "./directory/file" to "directory/file"
+    while (pChar < end && !isalnum(*pChar))
+        pChar++;
+
+    // Then drop the directory components
+    for (const char *pSlash = pChar; pSlash < end; pSlash++)
+    {
+        if ('/' == *pSlash)
+            pChar = pSlash + 1;
     }
 
-    return false;  
+    _filename.assign(pChar, end - pChar);
 }
 
 // private
-bool Message::_parseIntegerParameter(char *startBuf, char*& pEnd, const int maxParseAmount, int& totalParsed)
+bool Message::_parseIntegerParameter(const char*& pos, const char *end)
 {
     long longVal;
-    
-    if (_parseStringGetLong(NULL, pEnd, longVal)
-        && _validateParseAmounts(startBuf, pEnd, maxParseAmount, totalParsed))
+
+    if (_parseTokenLong(pos, end, longVal))
     {
         _iParam = longVal;
         return true;
@@ -208,23 +369,41 @@ bool Message::_parseIntegerParameter(char *startBuf, char*& pEnd, const int maxP
 }
 
 // private
-bool Message::_parseFloatParameter(char *startBuf, char*& pEnd, const int maxParseAmount, int& totalParsed, unsigned int index)
+bool Message::_parseFloatParameter(const char*& pos, const char *end, unsigned int index)
 {
-    if (index < 0 || index > MAX_NUMBER_FLOAT_PARAM)
+    if (index >= MAX_NUMBER_FLOAT_PARAM)
     {
         _errorType = MERROR_BAD_FORMAT;
         return false;
     }
 
-    ALfloat floatVal;
+    return _parseTokenFloat(pos, end, _fParams[index]);
+}
 
-    if (_parseStringGetFloat(NULL, pEnd, floatVal)
-        && _validateParseAmounts(startBuf, pEnd, maxParseAmount, totalParsed))
+// private
+bool Message::_parseFloatParameters(const char*& pos, const char *end, unsigned int first,
+                                    unsigned int count)
+{
+    for (unsigned int i = first; i < first + count; i++)
     {
-        _fParams[index] = floatVal;
-        return true;
+        if (!_parseFloatParameter(pos, end, i))
+            return false;
     }
 
+    return true;
+}
+
+// private
+bool Message::_parseOptionalFloatParameter(const char*& pos, const char *end, unsigned int index)
+{
+    const char *pStart = pos;
+
+    if (_parseFloatParameter(pos, end, index))
+        return true;
+
+    // The parameter is absent. This is not an error, and nothing is consumed.
+    pos = pStart;
+    _errorType = MERROR_NONE;
     return false;
 }
 
@@ -237,390 +416,711 @@ Message::MessageError Message::parseString(char*& messageString, const int maxPa
         return _errorType;
     }
 
-    char tokenBuf[MAX_MESSAGE_SIZE + 1];
-    char *pType, *pEnd, *pChar;
+    const char *end = messageString + (maxParseAmount - totalParsed);
     bool isSuccess = false;
 
-//    totalParsed = 0;
     _errorType = MERROR_NONE;
 
-    // Skip any leading non-alphabetic characters
-    while (*messageString && !isalpha(*messageString) && totalParsed < maxParseAmount)
+    // Skip any leading characters that cannot start a message
+    while (messageString < end && !isalpha(*messageString) && '@' != *messageString)
     {
-        *messageString = '\0';
         messageString++;
         totalParsed++;
     }
 
     // Check if the above loop skipped over the whole string
-    if (!*messageString || totalParsed == maxParseAmount)
+    if (messageString >= end)
     {
         _errorType = MERROR_EMPTY_MESSAGE;
         return _errorType;
     }
 
-    // Replace all newline/carriage returns with a blank space
-    // This kludge FLTK browser text rendering of newline/carriage returns
-    for (pChar = messageString; *pChar; pChar++)
+    const char *start = messageString;
+    const char *pos;
+
+    // An optional sequence number comes before the message type
+    if ('@' == *start)
     {
-        if (*pChar == '\n' || *pChar == '\r')
+        long sequenceNumber;
+
+        pos = start + 1;
+        if (!_parseTokenLong(pos, end, sequenceNumber) || !_nextToken(pos, end))
         {
-            *pChar = ' ';
+            return _errorType;
         }
+
+        _hasSequenceNumber = true;
+        _sequenceNumber = (unsigned int) sequenceNumber;
+        start = pos;
     }
 
-    this->_originalString = std::string(messageString);
+    pos = _tokenEnd(start, end);
 
-    // Copy the original string into a buffer
-    strncpy(tokenBuf, messageString, MAX_MESSAGE_SIZE);
-    tokenBuf[MAX_MESSAGE_SIZE] = '\0';
-    
-    // Get the first token: message type
-    // Parse, and then make sure we aren't parsing more than we should be
-    if (!_parseStringGetString(tokenBuf, pEnd, pType)
-        || !_validateParseAmounts(tokenBuf, pEnd, maxParseAmount, totalParsed))
-    { 
-        // Fail immediately if errors occur at this point
+    // The message type is always exactly four characters
+    if (4 != pos - start)
+    {
+        _errorType = (pos == end && pos - start < 4) ? MERROR_INCOMPLETE_MESSAGE
+                                                     : MERROR_UNKNOWN_MESSAGE_TYPE;
         return _errorType;
     }
-   
 
     // Parse the rest of the message based on the message type
-
-    // GHDL
-    if (0 == strcmp(pType, M_GET_HANDLE))
+    switch (MESSAGE_OPCODE(start[0], start[1], start[2], start[3]))
     {
-        // Set message type
-        _mtype = Message::MT_GHDL_FN;
-        
-        // We need to send a response after processing this message
-        _needsResponse = true;
+        // GHDL
+        case MESSAGE_OPCODE('G', 'H', 'D', 'L'):
+            // Set message type
+            _mtype = Message::MT_GHDL_FN;
+
+            // We need to send a response after processing this message
+            _needsResponse = true;
+
+            // Parse token: the filename
+            isSuccess = _parseFilenameParameter(pos, end);
+            break;
+
+        // RHDL
+        case MESSAGE_OPCODE('R', 'H', 'D', 'L'):
+            // Set message type
+            _mtype = Message::MT_RHDL_HL;
+
+            // Parse token: the handle
+            isSuccess = _parseHandleParameter(pos, end);
+            break;
+
+        // PTFI
+        case MESSAGE_OPCODE('P', 'T', 'F', 'I'):
+            // Set message type
+            _mtype = Message::MT_PTFI_FN_1I;
+
+            // Parse tokens: the filename and the filesize
+            isSuccess =    _parseFilenameParameter(pos, end)
+                        && _parseIntegerParameter(pos, end);
+            break;
+
+        // PLAY
+        case MESSAGE_OPCODE('P', 'L', 'A', 'Y'):
+            // Set message type
+            _mtype = Message::MT_PLAY_HL;
+
+            // Parse token: the handle
+            isSuccess = _parseHandleParameter(pos, end);
+            break;
+
+        // STOP
+        case MESSAGE_OPCODE('S', 'T', 'O', 'P'):
+            // Set message type
+            _mtype = Message::MT_STOP_HL;
+
+            // Parse token: the handle
+            isSuccess = _parseHandleParameter(pos, end);
+            break;
+
+        // PAUS
+        case MESSAGE_OPCODE('P', 'A', 'U', 'S'):
+            // Set message type
+            _mtype = Message::MT_PAUS_HL;
+
+            // Parse token: the handle
+            isSuccess = _parseHandleParameter(pos, end);
+            break;
+
+        // SSEC
+        case MESSAGE_OPCODE('S', 'S', 'E', 'C'):
+            _mtype = Message::MT_SSEC_HL_1F;
+
+            // Parse tokens: the handle and the playback position value
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // SSPO
+        case MESSAGE_OPCODE('S', 'S', 'P', 'O'):
+            // Set message type
+            _mtype = Message::MT_SSPO_HL_3F;
+
+            // Parse tokens: the handle, and 3 ALfloats
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameters(pos, end, 0, 3);
+            break;
+
+        // SSVO
+        case MESSAGE_OPCODE('S', 'S', 'V', 'O'):
+            // Set message type
+            _mtype = Message::MT_SSVO_HL_1F;
+
+            // Parse tokens: the handle, and 1 ALfloat
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // SSLP
+        case MESSAGE_OPCODE('S', 'S', 'L', 'P'):
+            // Set message type
+            _mtype = Message::MT_SSLP_HL_1I;
+
+            // Parse tokens: the handle, and 1 integer
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseIntegerParameter(pos, end);
+            break;
+
+        // SSVE
+        case MESSAGE_OPCODE('S', 'S', 'V', 'E'):
+            // Set message type to the simpler SSVE message version, with only 1 ALfloat parameter
+            _mtype = Message::MT_SSVE_HL_1F;
+
+            // Parse the minimum # of tokens: the handle, and 1 ALfloat
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+
+            // If there's more parameters, then SSVE message is used with a vector
+            if (isSuccess && _parseOptionalFloatParameter(pos, end, 1))
+            {
+                isSuccess = _parseFloatParameter(pos, end, 2);
+                // Update message type accordingly
+                _mtype = Message::MT_SSVE_HL_3F;
+            }
+            // Else, parsing failed OR we're done parsing the simpler SSVE message version
+            break;
+
+        // SSDI
+        case MESSAGE_OPCODE('S', 'S', 'D', 'I'):
+            // Set message type to the simpler SSDI message version, with only 1 ALfloat parameter
+            _mtype = Message::MT_SSDI_HL_1F;
+
+            // Determine which type of SSDI message it is by parsing halfway through
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+
+            // If there's more parameters, then SSDI message is used with a vector
+            if (isSuccess && _parseOptionalFloatParameter(pos, end, 1))
+            {
+                isSuccess = _parseFloatParameter(pos, end, 2);
+                // Update message type accordingly
+                _mtype = Message::MT_SSDI_HL_3F;
+            }
+            // Else, parsing failed OR we're done parsing the simpler SSDI message version
+            break;
+
+        // SSDV
+        case MESSAGE_OPCODE('S', 'S', 'D', 'V'):
+            // Set message type
+            _mtype = Message::MT_SSDV_HL_1F_1F;
+
+            // Parse tokens: the handle, and 2 ALfloats
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameters(pos, end, 0, 2);
+            break;
+
+        // SSDR
+        case MESSAGE_OPCODE('S', 'S', 'D', 'R'):
+            // Set message type
+            _mtype = Message::MT_SSDR_HL_1F;
+
+            // Parse tokens: the handle, and 1 ALfloat
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // SSRV
+        case MESSAGE_OPCODE('S', 'S', 'R', 'V'):
+            // Set message type to SSRV directional
+            _mtype = Message::MT_SSRV_HL_1F_1F;
+
+            // Determine which type of SSRV message it is by parsing halfway through
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameters(pos, end, 0, 2);
+
+            // If there's more parameters, then SSRV used with vector params
+            if (isSuccess && _parseOptionalFloatParameter(pos, end, 2))
+            {
+                isSuccess = _parseFloatParameter(pos, end, 3);
+                // Update the message type accordingly
+                _mtype = Message::MT_SSRV_HL_3F_1F;
+            }
+            // Else, parsing failed or SSRV was directional and we're done
+            break;
+
+        // SPIT
+        case MESSAGE_OPCODE('S', 'P', 'I', 'T'):
+            // Set message type to SPIT
+            _mtype = Message::MT_SPIT_HL_1F;
+
+            // Parse tokens: The handle and the pitch factor
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // FADE
+        case MESSAGE_OPCODE('F', 'A', 'D', 'E'):
+            // Set message type to FADE
+            _mtype = Message::MT_FADE_HL_1F_1F;
+
+            // Parse tokens: the handle, the final gain value, and the duration in seconds over which the fade should occur
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseFloatParameters(pos, end, 0, 2);
+            break;
+
+        // SPAR
+        case MESSAGE_OPCODE('S', 'P', 'A', 'R'):
+            // Set message type to SPAR
+            _mtype = Message::MT_SPAR_HL_1I_1F;
+
+            // Parse tokens: The handle, the parameter, and the value
+            isSuccess =    _parseHandleParameter(pos, end)
+                        && _parseIntegerParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // WAVE
+        case MESSAGE_OPCODE('W', 'A', 'V', 'E'):
+            // Set message type to WAVE
+            _mtype = Message::MT_WAVE_1I_3F;
+
+            // Parse tokens: Wave type, frequency, phase, and duration
+            isSuccess =    _parseIntegerParameter(pos, end)
+                        && _parseFloatParameters(pos, end, 0, 3);
+            _needsResponse = true;
+            break;
+
+        // STAT
+        case MESSAGE_OPCODE('S', 'T', 'A', 'T'):
+            // Set the message type to STAT
+            _mtype = Message::MT_STAT_HL;
+
+            // Parse tokens: the handle
+            isSuccess = _parseHandleParameter(pos, end);
+            // This message requires a response from the server
+            _needsResponse = true;
+            break;
+
+        // SLPO
+        case MESSAGE_OPCODE('S', 'L', 'P', 'O'):
+            // Set message type to SLPO
+            _mtype = Message::MT_SLPO_3F;
+
+            // Parse tokens: x, y, z of the listener's position
+            isSuccess = _parseFloatParameters(pos, end, 0, 3);
+            break;
+
+        // SLVE
+        case MESSAGE_OPCODE('S', 'L', 'V', 'E'):
+            // Set message type to SLVE
+            _mtype = Message::MT_SLVE_3F;
+
+            // Parse tokens: x, y, z of the listener's velocity
+            isSuccess = _parseFloatParameters(pos, end, 0, 3);
+            break;
+
+        // GAIN
+        case MESSAGE_OPCODE('G', 'A', 'I', 'N'):
+            // Set message type to GAIN
+            _mtype = Message::MT_GAIN_1F;
+
+            // Parse tokens: gain
+            isSuccess = _parseFloatParameter(pos, end, 0);
+            break;
+
+        // SLOR
+        case MESSAGE_OPCODE('S', 'L', 'O', 'R'):
+            // Set message type to SLOR
+            _mtype = Message::MT_SLOR_3F_3F;
+
+            // Parse tokens: x, y, z of "At" vector, and x, y, z of "Up" vector
+            isSuccess = _parseFloatParameters(pos, end, 0, 6);
+            break;
+
+        // PARA
+        case MESSAGE_OPCODE('P', 'A', 'R', 'A'):
+            // Set message type to PARA
+            _mtype = Message::MT_PARA_1I_1F;
+
+            // Parse tokens: the parameter specifier, and the desired value
+            isSuccess =    _parseIntegerParameter(pos, end)
+                        && _parseFloatParameter(pos, end, 0);
+            break;
+
+        // SYNC
+        case MESSAGE_OPCODE('S', 'Y', 'N', 'C'):
+            // Set message type
+            _mtype = Message::MT_SYNC;
+
+            // We need to send a response after processing this message
+            _needsResponse = true;
+
+            isSuccess = true;
+            break;
+
+        // QUIT
+        case MESSAGE_OPCODE('Q', 'U', 'I', 'T'):
+            // Set message type
+            _mtype = Message::MT_QUIT;
+
+            isSuccess = true;
+            break;
+
+        // PROT
+        case MESSAGE_OPCODE('P', 'R', 'O', 'T'):
+            // Set message type
+            _mtype = Message::MT_PROT_1I;
+
+            // The server responds with the protocol that is in use from now on
+            _needsResponse = true;
+
+            // Parse token: the protocol to switch to
+            isSuccess = _parseIntegerParameter(pos, end);
+            break;
+
+        // BTCH
+        case MESSAGE_OPCODE('B', 'T', 'C', 'H'):
+            // Set message type
+            _mtype = Message::MT_BTCH_1I;
+
+            // Parse token: the number of bytes in the batch, after this message
+            isSuccess = _parseIntegerParameter(pos, end);
+            break;
+
+        // DGRM
+        case MESSAGE_OPCODE('D', 'G', 'R', 'M'):
+            // Set message type
+            _mtype = Message::MT_DGRM;
+
+            // The server responds with the details of the datagram channel
+            _needsResponse = true;
+
+            isSuccess = true;
+            break;
+
+        // GHDC
+        case MESSAGE_OPCODE('G', 'H', 'D', 'C'):
+            // Set message type
+            _mtype = Message::MT_GHDC_FN;
+
+            // We need to send a response after processing this message
+            _needsResponse = true;
+
+            // Parse token: the content hash, which is kept as the filename
+            isSuccess = _parseFilenameParameter(pos, end);
+            break;
+
+        // PTFC
+        case MESSAGE_OPCODE('P', 'T', 'F', 'C'):
+            // Set message type
+            _mtype = Message::MT_PTFC_FN_1I;
+
+            // Parse tokens: the content hash and the filesize
+            isSuccess =    _parseFilenameParameter(pos, end)
+                        && _parseIntegerParameter(pos, end);
+            break;
+
+        // XFER
+        case MESSAGE_OPCODE('X', 'F', 'E', 'R'):
+            // Set message type
+            _mtype = Message::MT_XFER;
+
+            // The server responds with the key for attaching transfer connections
+            _needsResponse = true;
+
+            isSuccess = true;
+            break;
+
+        // ATCH
+        case MESSAGE_OPCODE('A', 'T', 'C', 'H'):
+            // Set message type
+            _mtype = Message::MT_ATCH_1I;
+
+            // Parse token: the key from the response to XFER
+            isSuccess = _parseIntegerParameter(pos, end);
+            break;
+
+        // SHMR
+        case MESSAGE_OPCODE('S', 'H', 'M', 'R'):
+            // Set message type
+            _mtype = Message::MT_SHMR;
+
+            // The server responds with the capacity of the ring, along with its descriptors
+            _needsResponse = true;
+
+            isSuccess = true;
+            break;
 
-        // Parse token: the filename
-        isSuccess = _parseFilenameParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
-    }
-    // RHDL
-    else if (0 == strcmp(pType, M_RELEASE_HANDLE))
-    {
-        // Set message type
-        _mtype = Message::MT_RHDL_HL;
+        // BUFS
+        case MESSAGE_OPCODE('B', 'U', 'F', 'S'):
+            // Set message type
+            _mtype = Message::MT_BUFS;
+
+            // The server responds with the statistics of the buffer cache
+            _needsResponse = true;
+
+            isSuccess = true;
+            break;
+
+        // PRLD
+        case MESSAGE_OPCODE('P', 'R', 'L', 'D'):
+            // Set message type
+            _mtype = Message::MT_PRLD_FN;
+
+            // Parse token: the filename
+            isSuccess = _parseFilenameParameter(pos, end);
+            break;
 
-        // Parse token: the handle 
-        isSuccess = _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
+        // Unknown message type
+        default:
+            _mtype = Message::MT_UNKNOWN;
+            _errorType = MERROR_UNKNOWN_MESSAGE_TYPE;
+            isSuccess = false;
+            break;
     }
-    // PTFI
-    else if (0 == strcmp(pType, M_PREPARE_FILE_TRANSFER))
-    {
-        // Set message type
-        _mtype = Message::MT_PTFI_FN_1I;
 
-        // Parse tokens: the filename and the filesize
-        isSuccess =    _parseFilenameParameter(tokenBuf, pEnd, maxParseAmount, totalParsed) 
-                    && _parseIntegerParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
-    }    
-    // PLAY
-    else if (0 == strcmp(pType, M_PLAY))
+    // If parsing was not successful, return the error that was encountered
+    if (!isSuccess)
     {
-        // Set message type
-        _mtype = Message::MT_PLAY_HL;
-        
-        // Parse token: the handle
-        isSuccess = _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
+        return _errorType;
     }
-    // STOP
-    else if (0 == strcmp(pType, M_STOP))
+
+    if (Message::_keepOriginalString)
     {
-        // Set message type
-        _mtype = Message::MT_STOP_HL;
-        
-        // Parse token: the handle
-        isSuccess = _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
+        _originalString.assign(messageString, pos - messageString);
     }
-    // PAUS
-    else if (0 == strcmp(pType, M_PAUSE))
-    {
-        // Set message type
-        _mtype = Message::MT_PAUS_HL;
 
-        // Parse token: the handle
-        isSuccess = _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
-    }
-    // SSEC
-    else if (0 == strcmp(pType, M_SET_SOUND_PLAYBACK_POSITION_SECONDS))
-    {
-        _mtype = Message::MT_SSEC_HL_1F;
+    // Parsing was successful. Advance the message string by the amount that was parsed
+    totalParsed += pos - messageString;
+    messageString += pos - messageString;
 
-        // Parse tokens: the handle and the playback position value
-        isSuccess = _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // SSPO
-    else if (0 == strcmp(pType, M_SET_SOUND_POSITION))
+    // Skip any terminating characters, up to the start of the next message or its sequence tag
+    while (messageString < end && !isalpha(*messageString) && '@' != *messageString)
     {
-        // Set message type
-        _mtype = Message::MT_SSPO_HL_3F;
-
-        // Parse tokens: the handle, and 3 ALfloats
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
+        messageString++;
+        totalParsed++;
     }
-    // SSVO
-    else if (0 == strcmp(pType, M_SET_SOUND_GAIN))
-    {
-        // Set message type
-        _mtype = Message::MT_SSVO_HL_1F;
 
-        // Parse tokens: the handle, and 1 ALfloat
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // SSLP
-    else if (0 == strcmp(pType, M_SET_SOUND_LOOP))
-    {
-        // Set message type
-        _mtype = Message::MT_SSLP_HL_1I;
+    return MERROR_NONE;
+}
 
-        // Parse tokens: the handle, and 1 integer
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseIntegerParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
-    }
-    // SSVE
-    else if (0 == strcmp(pType, M_SET_SOUND_VELOCITY))
-    {
-        // Set message type to the simpler SSVE message version, with only 1 ALfloat parameter
-        _mtype = Message::MT_SSVE_HL_1F;
+Message::MessageError Message::parseBinary(const char *data, const unsigned int available, unsigned int& consumed)
+{
+    const unsigned char *header = (const unsigned char *) data;
+    unsigned int numIntegers = 0, numFloats = 0, altNumFloats = 0;
+    MessageType altType = MT_UNKNOWN;
+    bool usesHandle = true, usesFilename = false;
 
-        // Parse the minimum # of tokens: the handle, and 1 ALfloat
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
+    consumed = 0;
+    _errorType = MERROR_NONE;
 
-        // If there's more parameters, then SSVE message is used with a vector
-        if (isSuccess
-            && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1))
-        {
-            isSuccess = _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
-            // Update message type accordingly
-            _mtype = Message::MT_SSVE_HL_3F;
-        }
-        // Else, parsing failed OR we're done parsing the simpler SSVE message version
-    }
-    // SSDI
-    else if (0 == strcmp(pType, M_SET_SOUND_DIRECTION))
+    if (!data || available < BINARY_HEADER_SIZE)
     {
-        // Set message type to the simpler SSDI message version, with only 1 ALfloat parameter
-        _mtype = Message::MT_SSDI_HL_1F;
+        _errorType = MERROR_INCOMPLETE_MESSAGE;
+        return _errorType;
+    }
 
-        // Determine which type of SSDI message it is by parsing halfway through
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
+    unsigned int length = readLittleEndian16(header + 8);
+    unsigned int flags = readLittleEndian16(header + 10);
 
-        // If there's more parameters, then SSDI message is used with a vector
-        if (isSuccess
-            && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1))
-        {
-            isSuccess = _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
-            // Update message type accordingly
-            _mtype = Message::MT_SSDI_HL_3F;
-        }
-        // Else, parsing failed OR we're done parsing the simpler SSDI message version
-    }
-    // SSDV
-    else if (0 == strcmp(pType, M_SET_SOUND_DIRECTION_AND_GAIN))
+    if (MAX_BINARY_PAYLOAD_SIZE < length)
     {
-        // Set message type
-        _mtype = Message::MT_SSDV_HL_1F_1F;
-
-        // Parse tokens: the handle, and 2 ALfloats
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1);
+        _errorType = MERROR_OVERSIZED_MESSAGE;
+        return _errorType;
     }
-    // SSDR
-    else if (0 == strcmp(pType, M_SET_SOUND_DIRECTION_RELATIVE))
-    {
-        // Set message type
-        _mtype = Message::MT_SSDR_HL_1F;
 
-        // Parse tokens: the handle, and 1 ALfloat
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // SSRV
-    else if (0 == strcmp(pType, M_SET_SOUND_DIRECTION_AND_GAIN_RELATIVE))
+    if (available < BINARY_HEADER_SIZE + length)
     {
-        // Set message type to SSRV directional
-        _mtype = Message::MT_SSRV_HL_1F_1F;
+        _errorType = MERROR_INCOMPLETE_MESSAGE;
+        return _errorType;
+    }
 
-        // Determine which type of SSRV message it is by parsing halfway through
-        isSuccess =    _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1);
+    // From here on, the whole message is consumed, even if it turns out to be malformed
+    consumed = BINARY_HEADER_SIZE + length;
 
-        // If there's more parameters, then SSRV used with vector params
-        if (isSuccess
-            && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2))
-        {
-            isSuccess = _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 3);
-            // Update the message type accordingly
-            _mtype = Message::MT_SSRV_HL_3F_1F;
-        }
-        // Else, parsing failed or SSRV was directional and we're done
-    }
-    // SPIT
-    else if (0 == strcmp(pType, M_SET_SOUND_PITCH))
-    {
-        // Set message type to SPIT
-        _mtype = Message::MT_SPIT_HL_1F;
+    const unsigned char *pos = header + BINARY_HEADER_SIZE;
+    const unsigned char *end = pos + length;
 
-        // Parse tokens: The handle and the pitch factor
-        isSuccess =     _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // FADE
-    else if (0 == strcmp(pType, M_FADE_SOUND))
+    // Determine the layout of the payload from the message type. Messages with two forms have
+    // an alternate type, which is used if the payload has the alternate number of floats.
+    switch (MESSAGE_OPCODE(header[0], header[1], header[2], header[3]))
     {
-        // Set message type to FADE
-        _mtype = Message::MT_FADE_HL_1F_1F;
-
-        // Parse tokens: the handle, the final gain value, and the duration in seconds over which the fade should occur
-        isSuccess =     _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1);
+        case MESSAGE_OPCODE('G', 'H', 'D', 'L'):
+            _mtype = MT_GHDL_FN;        usesHandle = false;     usesFilename = true;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('R', 'H', 'D', 'L'):
+            _mtype = MT_RHDL_HL;
+            break;
+        case MESSAGE_OPCODE('P', 'T', 'F', 'I'):
+            _mtype = MT_PTFI_FN_1I;     usesHandle = false;     usesFilename = true;
+            numIntegers = 1;
+            break;
+        case MESSAGE_OPCODE('P', 'L', 'A', 'Y'):
+            _mtype = MT_PLAY_HL;
+            break;
+        case MESSAGE_OPCODE('S', 'T', 'O', 'P'):
+            _mtype = MT_STOP_HL;
+            break;
+        case MESSAGE_OPCODE('P', 'A', 'U', 'S'):
+            _mtype = MT_PAUS_HL;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'E', 'C'):
+            _mtype = MT_SSEC_HL_1F;     numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'P', 'O'):
+            _mtype = MT_SSPO_HL_3F;     numFloats = 3;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'V', 'O'):
+            _mtype = MT_SSVO_HL_1F;     numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'L', 'P'):
+            _mtype = MT_SSLP_HL_1I;     numIntegers = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'V', 'E'):
+            _mtype = MT_SSVE_HL_1F;     numFloats = 1;
+            altType = MT_SSVE_HL_3F;    altNumFloats = 3;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'D', 'I'):
+            _mtype = MT_SSDI_HL_1F;     numFloats = 1;
+            altType = MT_SSDI_HL_3F;    altNumFloats = 3;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'D', 'V'):
+            _mtype = MT_SSDV_HL_1F_1F;  numFloats = 2;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'D', 'R'):
+            _mtype = MT_SSDR_HL_1F;     numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'S', 'R', 'V'):
+            _mtype = MT_SSRV_HL_1F_1F;  numFloats = 2;
+            altType = MT_SSRV_HL_3F_1F; altNumFloats = 4;
+            break;
+        case MESSAGE_OPCODE('S', 'P', 'I', 'T'):
+            _mtype = MT_SPIT_HL_1F;     numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('F', 'A', 'D', 'E'):
+            _mtype = MT_FADE_HL_1F_1F;  numFloats = 2;
+            break;
+        case MESSAGE_OPCODE('S', 'P', 'A', 'R'):
+            _mtype = MT_SPAR_HL_1I_1F;  numIntegers = 1;        numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('W', 'A', 'V', 'E'):
+            _mtype = MT_WAVE_1I_3F;     usesHandle = false;     numIntegers = 1;    numFloats = 3;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('S', 'T', 'A', 'T'):
+            _mtype = MT_STAT_HL;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('S', 'L', 'P', 'O'):
+            _mtype = MT_SLPO_3F;        usesHandle = false;     numFloats = 3;
+            break;
+        case MESSAGE_OPCODE('S', 'L', 'V', 'E'):
+            _mtype = MT_SLVE_3F;        usesHandle = false;     numFloats = 3;
+            break;
+        case MESSAGE_OPCODE('G', 'A', 'I', 'N'):
+            _mtype = MT_GAIN_1F;        usesHandle = false;     numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'L', 'O', 'R'):
+            _mtype = MT_SLOR_3F_3F;     usesHandle = false;     numFloats = 6;
+            break;
+        case MESSAGE_OPCODE('P', 'A', 'R', 'A'):
+            _mtype = MT_PARA_1I_1F;     usesHandle = false;     numIntegers = 1;    numFloats = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'Y', 'N', 'C'):
+            _mtype = MT_SYNC;           usesHandle = false;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('Q', 'U', 'I', 'T'):
+            _mtype = MT_QUIT;           usesHandle = false;
+            break;
+        case MESSAGE_OPCODE('P', 'R', 'O', 'T'):
+            _mtype = MT_PROT_1I;        usesHandle = false;     numIntegers = 1;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('B', 'T', 'C', 'H'):
+            _mtype = MT_BTCH_1I;        usesHandle = false;     numIntegers = 1;
+            break;
+        case MESSAGE_OPCODE('D', 'G', 'R', 'M'):
+            _mtype = MT_DGRM;           usesHandle = false;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('G', 'H', 'D', 'C'):
+            _mtype = MT_GHDC_FN;        usesHandle = false;     usesFilename = true;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('P', 'T', 'F', 'C'):
+            _mtype = MT_PTFC_FN_1I;     usesHandle = false;     usesFilename = true;
+            numIntegers = 1;
+            break;
+        case MESSAGE_OPCODE('X', 'F', 'E', 'R'):
+            _mtype = MT_XFER;           usesHandle = false;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('A', 'T', 'C', 'H'):
+            _mtype = MT_ATCH_1I;        usesHandle = false;     numIntegers = 1;
+            break;
+        case MESSAGE_OPCODE('S', 'H', 'M', 'R'):
+            _mtype = MT_SHMR;           usesHandle = false;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('B', 'U', 'F', 'S'):
+            _mtype = MT_BUFS;           usesHandle = false;
+            _needsResponse = true;
+            break;
+        case MESSAGE_OPCODE('P', 'R', 'L', 'D'):
+            _mtype = MT_PRLD_FN;        usesHandle = false;     usesFilename = true;
+            break;
+        default:
+            _mtype = MT_UNKNOWN;
+            _errorType = MERROR_UNKNOWN_MESSAGE_TYPE;
+            return _errorType;
     }
-    // SPAR
-    else if (0 == strcmp(pType, M_SET_SOUND_PARAMETERS))
-    {
-        // Set message type to SPAR
-        _mtype = Message::MT_SPAR_HL_1I_1F;
 
-        // Parse tokens: The handle, the parameter, and the value
-        isSuccess =     _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    &&  _parseIntegerParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // WAVE
-    else if (0 == strcmp(pType, M_GENERATE_SOUND_FROM_WAVEFORM))
+    if (flags & BINARY_FLAG_SEQUENCE_NUMBER)
     {
-        // Set message type to WAVE
-        _mtype = Message::MT_WAVE_1I_3F;
+        if (end - pos < 4)
+        {
+            _errorType = MERROR_BAD_FORMAT;
+            return _errorType;
+        }
 
-        // Parse tokens: Wave type, frequency, phase, and duration
-        isSuccess =     _parseIntegerParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
-        _needsResponse = true;
+        _hasSequenceNumber = true;
+        _sequenceNumber = readLittleEndian32(pos);
+        pos += 4;
     }
-    // STAT
-    else if (0 == strcmp(pType, M_GET_SOUND_STATE))
-    {
-        // Set the message type to STAT
-        _mtype = Message::MT_STAT_HL;
 
-        // Parse tokens: the handle
-        isSuccess =     _parseHandleParameter(tokenBuf, pEnd, maxParseAmount, totalParsed);
-        // This message requires a response from the server
-        _needsResponse = true;
-    }
-    // SLPO
-    else if (0 == strcmp(pType, M_SET_LISTENER_POSITION))
-    {
-        // Set message type to SLPO
-        _mtype = Message::MT_SLPO_3F;
+    unsigned int fixedSize = 4 * (numIntegers + numFloats);
 
-        // Parse tokens: x, y, z of the listener's position
-        isSuccess =     _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
-    }
-    // SLVE
-    else if (0 == strcmp(pType, M_SET_LISTENER_VELOCITY))
+    // Use the alternate form if the payload is sized for it
+    if (MT_UNKNOWN != altType && (unsigned int) (end - pos) == 4 * (numIntegers + altNumFloats))
     {
-        // Set message type to SLVE
-        _mtype = Message::MT_SLVE_3F;
-
-        // Parse tokens: x, y, z of the listener's velocity
-        isSuccess =     _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2);
+        _mtype = altType;
+        numFloats = altNumFloats;
+        fixedSize = 4 * (numIntegers + numFloats);
     }
-    // GAIN
-    else if (0 == strcmp(pType, M_SET_LISTENER_GAIN))
-    {
-        // Set message type to GAIN
-        _mtype = Message::MT_GAIN_1F;
 
-        // Parse tokens: gain
-        isSuccess =     _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // SLOR
-    else if (0 == strcmp(pType, M_SET_LISTENER_ORIENTATION))
+    // Everything but the filename has a fixed size, and a filename cannot be empty
+    if ((!usesFilename && (unsigned int) (end - pos) != fixedSize)
+        || (usesFilename && (unsigned int) (end - pos) <= fixedSize))
     {
-        // Set message type to SLOR
-        _mtype = Message::MT_SLOR_3F_3F;
-
-        // Parse tokens: x, y, z of "At" vector, and x, y, z of "Up" vector
-        isSuccess =     _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 1)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 2)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 3)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 4)
-                    &&  _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 5);
+        _errorType = MERROR_BAD_FORMAT;
+        return _errorType;
     }
-    // PARA
-    else if (0 == strcmp(pType, M_SET_PARAMETERS))
-    {
-        // Set message type to PARA
-        _mtype = Message::MT_PARA_1I_1F;
 
-        // Parse tokens: the parameter specifier, and the desired value
-        isSuccess =     _parseIntegerParameter(tokenBuf, pEnd, maxParseAmount, totalParsed)
-                    && _parseFloatParameter(tokenBuf, pEnd, maxParseAmount, totalParsed, 0);
-    }
-    // SYNC
-    else if (0 == strcmp(pType, M_SYNC))
+    if (usesHandle)
     {
-        // Set message type
-        _mtype = Message::MT_SYNC;
-
-        // We need to send a response after processing this message
-        _needsResponse = true;
-
-        isSuccess = true;
+        _handle = (ALuint) readLittleEndian32(header + 4);
     }
-    // QUIT
-    else if (0 == strcmp(pType, M_QUIT))
-    {
-        // Set message type
-        _mtype = Message::MT_QUIT;
 
-        isSuccess = true;
-    }
-    // Unknown message type
-    else
+    if (numIntegers)
     {
-        _mtype = Message::MT_UNKNOWN;
-        _errorType = MERROR_UNKNOWN_MESSAGE_TYPE;
-        isSuccess = false;
+        _iParam = (int) readLittleEndian32(pos);
+        pos += 4;
     }
 
-    // If parsing was not successful, return the error that was encountered
-    if (!isSuccess)
+    for (unsigned int i = 0; i < numFloats; i++, pos += 4)
     {
-        return _errorType;
+        unsigned int bits = readLittleEndian32(pos);
+        memcpy(&_fParams[i], &bits, sizeof(ALfloat));
     }
 
-    // Parsing was successful. Advance the message string by the amount that was parsed
-    messageString = messageString + totalParsed;
-
-    // Skip any terminating non-alphabetic characters
-    while (!isalpha(*messageString) && totalParsed < maxParseAmount)
+    if (usesFilename)
     {
-        *messageString = '\0';
-        messageString++;
-        totalParsed++;
+        _setFilename((const char *) pos, (const char *) end);
     }
 
     return MERROR_NONE;
@@ -690,3 +1190,35 @@ const std::string& Message::getOriginalString() const
 {
     return _originalString;
 }
+
+void Message::setSessionID(unsigned int sessionID)
+{
+    _sessionID = sessionID;
+}
+
+unsigned int Message::getSessionID() const
+{
+    return _sessionID;
+}
+
+bool Message::hasSequenceNumber() const
+{
+    return _hasSequenceNumber;
+}
+
+unsigned int Message::getSequenceNumber() const
+{
+    return _sequenceNumber;
+}
+
+// static, public
+void Message::setKeepOriginalString(bool keep)
+{
+    Message::_keepOriginalString = keep;
+}
+
+// static, public
+bool Message::keepsOriginalString()
+{
+    return Message::_keepOriginalString;
+}
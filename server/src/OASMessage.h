@@ -10,6 +10,8 @@
 #include <string>
 #include <cstring>
 #include <cctype>
+#include <climits>
+#include <cstdlib>
 #include <AL/alut.h>
 #include <sys/time.h>
 #include "OASLogger.h"
@@ -48,6 +50,60 @@ namespace oas
 #define M_SET_PARAMETERS                            "PARA"
 #define M_SYNC                                      "SYNC"
 #define M_QUIT                                      "QUIT"
+#define M_SET_PROTOCOL                              "PROT"
+#define M_BATCH                                     "BTCH"
+#define M_OPEN_DATAGRAM_CHANNEL                     "DGRM"
+#define M_GET_HANDLE_FOR_CONTENT                    "GHDC"
+#define M_PREPARE_CONTENT_TRANSFER                  "PTFC"
+#define M_OPEN_TRANSFER_CHANNEL                     "XFER"
+#define M_ATTACH_TRANSFER_CONNECTION                "ATCH"
+#define M_OPEN_SHARED_MEMORY_CHANNEL                "SHMR"
+#define M_PRELOAD                                   "PRLD"
+
+// Packs the four characters of a message type string into an integer, so that the parser can
+// dispatch on the message type with a single switch instead of comparing strings
+#define MESSAGE_OPCODE(a, b, c, d)  (  ((unsigned int) (unsigned char) (a))         \
+                                     | ((unsigned int) (unsigned char) (b) << 8)    \
+                                     | ((unsigned int) (unsigned char) (c) << 16)   \
+                                     | ((unsigned int) (unsigned char) (d) << 24))
+
+// Longest numeric token that is handed to the slow path of the float parser
+#define MAX_NUMERIC_TOKEN_SIZE    64
+
+// Wire protocols that a client can switch between with the PROT message
+#define PROTOCOL_TEXT       0
+#define PROTOCOL_BINARY     1
+
+/* Binary protocol. Each message is a fixed size header, followed by a payload.
+ *  Header:
+ *      char[4]     message type, e.g. "SSPO"
+ *      uint32      handle, or 0 for messages that do not take one
+ *      uint16      payload length, in bytes
+ *      uint16      flags
+ *  Payload:
+ *      uint32      sequence number, only if BINARY_FLAG_SEQUENCE_NUMBER is set
+ *      int32[]     integer parameters
+ *      float32[]   floating point parameters
+ *      char[]      filename, for GHDL, PTFI and PRLD, or content hash, for GHDC and PTFC.
+ *                  Not null terminated.
+ * All values are little-endian. Parameters come in the same order as in the text protocol,
+ * except that the filename always comes last.
+ */
+#define BINARY_HEADER_SIZE              12
+#define BINARY_FLAG_SEQUENCE_NUMBER     0x0001
+#define MAX_BINARY_PAYLOAD_SIZE         MAX_MESSAGE_SIZE
+
+// Read 16 and 32 bit values in little-endian byte order, regardless of the host byte order
+static inline unsigned int readLittleEndian16(const unsigned char *data)
+{
+    return (unsigned int) data[0] | ((unsigned int) data[1] << 8);
+}
+
+static inline unsigned int readLittleEndian32(const unsigned char *data)
+{
+    return   (unsigned int) data[0]         | ((unsigned int) data[1] << 8)
+          | ((unsigned int) data[2] << 16)  | ((unsigned int) data[3] << 24);
+}
 
 // Maximum number of float parameters
 #define MAX_NUMBER_FLOAT_PARAM    6
@@ -98,6 +154,18 @@ public:
         MT_PARA_1I_1F,      // Set global sound rendering parameters
         MT_SYNC,
         MT_QUIT,
+        MT_PROT_1I,         // Switch the wire protocol used by the client
+        MT_BTCH_1I,         // Start of a batch: the given number of bytes that follow are applied together
+        MT_BTCH_END,        // End of a batch. Only generated by the server, never parsed.
+        MT_DGRM,            // Open a datagram channel for state updates
+        MT_GHDC_FN,         // Get handle for the file with the given content hash
+        MT_PTFC_FN_1I,      // Prepare for file transmission, with the given content hash & file size
+        MT_XFER,            // Get a key for attaching file transfer connections to the session
+        MT_ATCH_1I,         // Attach this connection to a session for file transfers, with the given key
+        MT_SHMR,            // Get a shared memory ring to write messages into, instead of the connection
+        MT_BUFS,            // Get the statistics of the buffer cache
+        MT_PRLD_FN,         // Load the given file into a buffer ahead of time
+        MT_SHUTDOWN,        // Stop the server thread. Only generated by the server, never parsed.
         MT_UNKNOWN
     };
 
@@ -109,12 +177,35 @@ public:
         MERROR_INCOMPLETE_MESSAGE,     // Message incomplete
         MERROR_BAD_FORMAT,             // Message misformatted
         MERROR_EMPTY_MESSAGE,
-        MERROR_UNKNOWN_MESSAGE_TYPE
-    // Unknown message type
+        MERROR_UNKNOWN_MESSAGE_TYPE,   // Unknown message type
+        MERROR_OVERSIZED_MESSAGE       // Message can never fit in the receive buffer
     };
 
     ALuint getHandle() const;
+
+    /**
+     * @brief Parse the next message out of messageString, in a single pass and without
+     *        copying or modifying the input.
+     * @param messageString Points to the data to parse. On success, it is advanced past the
+     *                      parsed message and any trailing separators.
+     * @param maxParseAmount Total number of bytes available, counted from the same origin as
+     *                       totalParsed
+     * @param totalParsed Number of bytes already consumed. Advanced along with messageString.
+     * @return MERROR_NONE on success. On failure, messageString and totalParsed are
+     *         left untouched, except when the input is empty.
+     */
     MessageError parseString(char*& messageString, const int maxParseAmount, int& totalParsed);
+
+    /**
+     * @brief Parse one message in the binary protocol from the start of data.
+     * @param data Points to the message header
+     * @param available Number of bytes available at data
+     * @param consumed Set to the size of the whole message, header and payload, once the header
+     *                 has been read. The message is consumed even if its payload is malformed.
+     * @return MERROR_NONE on success. MERROR_INCOMPLETE_MESSAGE if more data is needed, and
+     *         MERROR_OVERSIZED_MESSAGE if the payload is larger than MAX_BINARY_PAYLOAD_SIZE.
+     */
+    MessageError parseBinary(const char *data, const unsigned int available, unsigned int& consumed);
     MessageType getMessageType() const;
     void setFilename(const std::string& filename);
     const std::string& getFilename() const;
@@ -125,10 +216,35 @@ public:
     bool needsResponse() const;
     MessageError getError() const;
     const std::string& getOriginalString() const;
+    void setSessionID(unsigned int sessionID);
+    unsigned int getSessionID() const;
+
+    /**
+     * @brief Check if the client tagged this message with a sequence number, by prefixing it
+     *        with "@<sequence number>". The response to a tagged message is tagged with the
+     *        same sequence number, which lets the client pipeline its requests.
+     */
+    bool hasSequenceNumber() const;
+    unsigned int getSequenceNumber() const;
+
+    /**
+     * @brief Choose whether parsed messages keep a copy of their original text, for
+     *        getOriginalString(). Off by default, as it costs an allocation per message.
+     *        Should be set before the socket handler is started.
+     */
+    static void setKeepOriginalString(bool keep);
+    static bool keepsOriginalString();
+
+    /**
+     * @brief Reset this message to the state of a freshly constructed message, so that its
+     *        storage can be reused for parsing another one
+     */
+    void clear();
 
     Message();
     Message(MessageType mtype);
     Message(const Message& other);
+    Message& operator=(const Message& other);
     ~Message();
 
     struct timeval start;
@@ -145,24 +261,29 @@ private:
     bool _needsResponse;
     MessageError _errorType;
     std::string _originalString;
+    unsigned int _sessionID;
+    bool _hasSequenceNumber;
+    unsigned int _sequenceNumber;
 
     void _init();
 
-    bool _parseStringGetString(char *string, char*& pEnd, char*& result);
-    bool _parseStringGetLong(char *string, char*& pEnd, long& result);
-    bool _parseStringGetFloat(char *string, char*& pEnd, ALfloat& result);
-
-    bool _validateParseAmounts(char *startBuf, char *pEnd, const int maxParseAmount,
-                               int& totalParsed);
-
-    bool _parseHandleParameter(char *startBuf, char*& pEnd, const int maxParseAmount,
-                               int& totalParsed);
-    bool _parseFilenameParameter(char *startBuf, char*& pEnd, const int maxParseAmount,
-                                 int& totalParsed);
-    bool _parseIntegerParameter(char *startBuf, char*& pEnd, const int maxParseAmount,
-                                int& totalParsed);
-    bool _parseFloatParameter(char *startBuf, char*& pEnd, const int maxParseAmount,
-                              int& totalParsed, unsigned int index);
+    static bool _keepOriginalString;
+
+    bool _nextToken(const char*& pos, const char *end);
+    const char* _tokenEnd(const char *pos, const char *end) const;
+
+    bool _parseTokenLong(const char*& pos, const char *end, long& result);
+    bool _parseTokenFloat(const char*& pos, const char *end, ALfloat& result);
+
+    bool _parseHandleParameter(const char*& pos, const char *end);
+    bool _parseFilenameParameter(const char*& pos, const char *end);
+    bool _parseIntegerParameter(const char*& pos, const char *end);
+    bool _parseFloatParameter(const char*& pos, const char *end, unsigned int index);
+    bool _parseFloatParameters(const char*& pos, const char *end, unsigned int first,
+                               unsigned int count);
+    bool _parseOptionalFloatParameter(const char*& pos, const char *end, unsigned int index);
+
+    void _setFilename(const char *start, const char *end);
 };
 
 }
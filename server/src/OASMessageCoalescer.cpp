@@ -0,0 +1,137 @@
+/**
+ * @file OASMessageCoalescer.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASMessageCoalescer.h"
+
+using namespace oas;
+
+MessageCoalescer::MessageCoalescer() :
+    _numPending(0),
+    _updateCount(0),
+    _coalescedCount(0)
+{
+}
+
+MessageCoalescer::~MessageCoalescer()
+{
+}
+
+// public
+bool MessageCoalescer::add(const Message &message)
+{
+    if (Message::MERROR_NONE != message.getError())
+        return false;
+
+    Key key;
+    key.parameter = _parameterFor(message.getMessageType());
+
+    if (P_NONE == key.parameter)
+        return false;
+
+    // The listener is shared by all sessions
+    if (P_LISTENER_POSITION <= key.parameter)
+    {
+        key.session = 0;
+        key.handle = 0;
+    }
+    else
+    {
+        key.session = message.getSessionID();
+        key.handle = message.getHandle();
+    }
+
+    _updateCount++;
+
+    std::pair<IndexMap::iterator, bool> result = _indices.insert(std::make_pair(key, _numPending));
+
+    // An update of the same parameter is already pending. Overwrite it.
+    if (!result.second)
+    {
+        _pending[result.first->second] = message;
+        _coalescedCount++;
+        return true;
+    }
+
+    if (_numPending < _pending.size())
+        _pending[_numPending] = message;
+    else
+        _pending.push_back(message);
+
+    _numPending++;
+    return true;
+}
+
+// public
+unsigned int MessageCoalescer::size() const
+{
+    return _numPending;
+}
+
+// public
+const Message& MessageCoalescer::at(unsigned int index) const
+{
+    return _pending[index];
+}
+
+// public
+void MessageCoalescer::clear()
+{
+    _numPending = 0;
+    _indices.clear();
+}
+
+// public
+unsigned long MessageCoalescer::getUpdateCount() const
+{
+    return _updateCount;
+}
+
+// public
+unsigned long MessageCoalescer::getCoalescedCount() const
+{
+    return _coalescedCount;
+}
+
+// private, static
+MessageCoalescer::Parameter MessageCoalescer::_parameterFor(Message::MessageType type)
+{
+    switch (type)
+    {
+        case Message::MT_SSPO_HL_3F:
+            return P_SOURCE_POSITION;
+        case Message::MT_SSVO_HL_1F:
+            return P_SOURCE_GAIN;
+        case Message::MT_SSVE_HL_3F:
+            return P_SOURCE_VELOCITY;
+        // Both forms replace the whole direction vector
+        case Message::MT_SSDI_HL_1F:
+        case Message::MT_SSDI_HL_3F:
+            return P_SOURCE_DIRECTION;
+        case Message::MT_SPIT_HL_1F:
+            return P_SOURCE_PITCH;
+        case Message::MT_SLPO_3F:
+            return P_LISTENER_POSITION;
+        case Message::MT_SLVE_3F:
+            return P_LISTENER_VELOCITY;
+        case Message::MT_GAIN_1F:
+            return P_LISTENER_GAIN;
+        case Message::MT_SLOR_3F_3F:
+            return P_LISTENER_ORIENTATION;
+        // Everything else depends on, or changes, more than one parameter
+        default:
+            return P_NONE;
+    }
+}
+
+// public
+bool MessageCoalescer::Key::operator<(const Key &other) const
+{
+    if (session != other.session)
+        return session < other.session;
+    if (handle != other.handle)
+        return handle < other.handle;
+    return parameter < other.parameter;
+}
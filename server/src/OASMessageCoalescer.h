@@ -0,0 +1,107 @@
+/**
+ * @file    OASMessageCoalescer.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_MESSAGE_COALESCER_H_
+#define _OAS_MESSAGE_COALESCER_H_
+
+#include <vector>
+#include <map>
+
+#include "OASMessage.h"
+
+namespace oas
+{
+
+/**
+ * Collapses the parameter updates drained by the server in one iteration of its loop, so that
+ * only the final value of each parameter of each source (or of the listener) reaches OpenAL.
+ *
+ * Only messages that overwrite a single parameter with absolute values are coalesced. Every
+ * other message must be processed in order, so the pending updates have to be applied before
+ * it. Within the pending updates, each parameter keeps the position of its first update.
+ */
+class MessageCoalescer
+{
+public:
+
+    /**
+     * @brief Keep a copy of the message if it is a parameter update, replacing any pending
+     *        update of the same parameter.
+     * @return true if the message was kept. Else, the pending updates must be applied before
+     *         the message is processed.
+     */
+    bool add(const Message &message);
+
+    /**
+     * @brief Get the number of pending updates
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Get one of the pending updates, in the order they should be applied
+     */
+    const Message& at(unsigned int index) const;
+
+    /**
+     * @brief Forget the pending updates, once they have been applied
+     */
+    void clear();
+
+    /**
+     * @brief Get the total number of updates that were passed to add() and kept
+     */
+    unsigned long getUpdateCount() const;
+
+    /**
+     * @brief Get the total number of updates that were replaced by a later update before
+     *        they were applied
+     */
+    unsigned long getCoalescedCount() const;
+
+    MessageCoalescer();
+    ~MessageCoalescer();
+
+private:
+
+    // The parameters that can be coalesced. Message types that set the same parameter share one.
+    enum Parameter
+    {
+        P_NONE = 0,
+        P_SOURCE_POSITION,
+        P_SOURCE_GAIN,
+        P_SOURCE_VELOCITY,
+        P_SOURCE_DIRECTION,
+        P_SOURCE_PITCH,
+        P_LISTENER_POSITION,
+        P_LISTENER_VELOCITY,
+        P_LISTENER_GAIN,
+        P_LISTENER_ORIENTATION
+    };
+
+    struct Key
+    {
+        unsigned int session;
+        unsigned int handle;
+        Parameter parameter;
+
+        bool operator<(const Key &other) const;
+    };
+
+    typedef std::map<Key, unsigned int> IndexMap;
+
+    static Parameter _parameterFor(Message::MessageType type);
+
+    // Storage is kept between iterations, so that it only has to grow once
+    std::vector<Message> _pending;
+    unsigned int _numPending;
+    IndexMap _indices;
+
+    unsigned long _updateCount;
+    unsigned long _coalescedCount;
+};
+
+}
+
+#endif
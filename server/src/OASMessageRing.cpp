@@ -0,0 +1,180 @@
+/**
+ * @file OASMessageRing.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASMessageRing.h"
+
+using namespace oas;
+
+MessageRing::MessageRing() :
+    _tail(0),
+    _cachedHead(0),
+    _isProducerWaiting(0),
+    _head(0),
+    _cachedTail(0),
+    _isConsumerWaiting(0),
+    _messagesHandle(-1),
+    _spaceHandle(-1)
+{
+}
+
+MessageRing::~MessageRing()
+{
+    release();
+}
+
+// public
+bool MessageRing::initialize()
+{
+    if (-1 == _messagesHandle)
+        _messagesHandle = eventfd(0, EFD_NONBLOCK);
+    if (-1 == _spaceHandle)
+        _spaceHandle = eventfd(0, EFD_NONBLOCK);
+
+    if (-1 == _messagesHandle || -1 == _spaceHandle)
+    {
+        oas::Logger::error("MessageRing - Failed to create event descriptors");
+        release();
+        return false;
+    }
+
+    return true;
+}
+
+// public
+void MessageRing::release()
+{
+    if (-1 != _messagesHandle)
+        close(_messagesHandle);
+    if (-1 != _spaceHandle)
+        close(_spaceHandle);
+
+    _messagesHandle = _spaceHandle = -1;
+}
+
+// public
+Message* MessageRing::reserve()
+{
+    if (!_hasSpace())
+        return NULL;
+
+    Message *slot = &_slots[_tail & MESSAGE_RING_INDEX_MASK];
+    slot->clear();
+    return slot;
+}
+
+// public
+void MessageRing::push()
+{
+    // The release store makes the contents of the slot visible before the new tail
+    __atomic_store_n(&_tail, _tail + 1, __ATOMIC_RELEASE);
+    _wake(_messagesHandle, &_isConsumerWaiting);
+}
+
+// public
+bool MessageRing::waitForSpace(const Time &timeout)
+{
+    return _sleep(_spaceHandle, &_isProducerWaiting, &MessageRing::_hasSpace, timeout);
+}
+
+// public
+Message* MessageRing::front()
+{
+    if (!_hasMessages())
+        return NULL;
+
+    return &_slots[_head & MESSAGE_RING_INDEX_MASK];
+}
+
+// public
+void MessageRing::pop()
+{
+    // The release store makes sure the consumer is done with the slot before it can be reused
+    __atomic_store_n(&_head, _head + 1, __ATOMIC_RELEASE);
+    _wake(_spaceHandle, &_isProducerWaiting);
+}
+
+// public
+bool MessageRing::waitForMessages(const Time &timeout)
+{
+    return _sleep(_messagesHandle, &_isConsumerWaiting, &MessageRing::_hasMessages, timeout);
+}
+
+// public
+unsigned int MessageRing::size() const
+{
+    return __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+}
+
+// private
+bool MessageRing::_hasSpace()
+{
+    // Only look at the consumer's index when the cached copy says the ring is full
+    if (MESSAGE_RING_CAPACITY == _tail - _cachedHead)
+        _cachedHead = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+
+    return (MESSAGE_RING_CAPACITY != _tail - _cachedHead);
+}
+
+// private
+bool MessageRing::_hasMessages()
+{
+    // Only look at the producer's index when the cached copy says the ring is empty
+    if (_head == _cachedTail)
+        _cachedTail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+
+    return (_head != _cachedTail);
+}
+
+// private
+bool MessageRing::_sleep(int handle, int *isWaiting, bool (MessageRing::*isReady)(),
+                         const Time &timeout)
+{
+    while (!(this->*isReady)())
+    {
+        Time now;
+        now.update(Time::OAS_CLOCK_MONOTONIC);
+
+        if (!(timeout > now))
+            return false;
+
+        // Announce that we are about to sleep, then check again. The other side publishes its
+        // index before it checks the flag, so one of the two is guaranteed to see the other.
+        __atomic_store_n(isWaiting, 1, __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+        if ((this->*isReady)())
+        {
+            __atomic_store_n(isWaiting, 0, __ATOMIC_RELAXED);
+            break;
+        }
+
+        struct timespec remaining = (timeout - now).getTime();
+        struct pollfd pollInfo;
+        pollInfo.fd = handle;
+        pollInfo.events = POLLIN;
+
+        if (0 < ppoll(&pollInfo, 1, &remaining, NULL))
+        {
+            // Reset the event counter
+            eventfd_t value;
+            eventfd_read(handle, &value);
+        }
+
+        __atomic_store_n(isWaiting, 0, __ATOMIC_RELAXED);
+    }
+
+    return true;
+}
+
+// private
+void MessageRing::_wake(int handle, int *isWaiting)
+{
+    // Order the index update before the check of the flag. See _sleep().
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (__atomic_load_n(isWaiting, __ATOMIC_RELAXED))
+        eventfd_write(handle, 1);
+}
@@ -0,0 +1,117 @@
+/**
+ * @file    OASMessageRing.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_MESSAGE_RING_H_
+#define _OAS_MESSAGE_RING_H_
+
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <OASTime.h>
+
+#include "OASMessage.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Number of messages the ring can hold. Must be a power of two.
+#define MESSAGE_RING_CAPACITY       1024
+#define MESSAGE_RING_INDEX_MASK     (MESSAGE_RING_CAPACITY - 1)
+#define CACHE_LINE_SIZE             64
+
+/**
+ * Bounded, lock-free queue of messages for exactly one producer thread and one consumer thread.
+ * Messages are stored by value in pre-allocated slots: the producer fills in a slot in place and
+ * publishes it, and the consumer reads it in place and then frees it. Neither side takes a lock.
+ *
+ * A side that finds the ring empty (or full) can sleep on an event descriptor. The other side
+ * only signals the descriptor when it sees that someone is sleeping, so there is no system call
+ * per message while both threads are busy.
+ */
+class MessageRing
+{
+public:
+
+    /**
+     * @brief Create the event descriptors used for sleeping and waking up
+     */
+    bool initialize();
+
+    /**
+     * @brief Close the event descriptors
+     */
+    void release();
+
+    /**
+     * @brief Producer only. Get the next free slot, cleared to a freshly constructed message,
+     *        or NULL if the ring is full. The slot is not visible to the consumer until push().
+     */
+    Message* reserve();
+
+    /**
+     * @brief Producer only. Publish the slot returned by the last call to reserve().
+     */
+    void push();
+
+    /**
+     * @brief Producer only. Block until there is a free slot, or until the timeout.
+     * @return true if a slot is free
+     */
+    bool waitForSpace(const Time &timeout);
+
+    /**
+     * @brief Consumer only. Get the oldest message in the ring, or NULL if the ring is empty.
+     *        The message stays valid until pop().
+     */
+    Message* front();
+
+    /**
+     * @brief Consumer only. Free the slot of the message returned by front().
+     */
+    void pop();
+
+    /**
+     * @brief Consumer only. Block until there is a message, or until the timeout.
+     * @return true if a message is available
+     */
+    bool waitForMessages(const Time &timeout);
+
+    /**
+     * @brief Get the number of messages in the ring. Only an estimate while the other side runs.
+     */
+    unsigned int size() const;
+
+    MessageRing();
+    ~MessageRing();
+
+private:
+
+    // Written only by the producer. Kept on its own cache line so that the producer and
+    // consumer do not invalidate each other's cache lines on every message.
+    unsigned int _tail __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int _cachedHead;
+    int _isProducerWaiting;
+
+    // Written only by the consumer
+    unsigned int _head __attribute__((aligned(CACHE_LINE_SIZE)));
+    unsigned int _cachedTail;
+    int _isConsumerWaiting;
+
+    int _messagesHandle __attribute__((aligned(CACHE_LINE_SIZE)));
+    int _spaceHandle;
+
+    Message _slots[MESSAGE_RING_CAPACITY];
+
+    bool _hasSpace();
+    bool _hasMessages();
+    bool _sleep(int handle, int *isWaiting, bool (MessageRing::*isReady)(), const Time &timeout);
+    void _wake(int handle, int *isWaiting);
+};
+
+}
+
+#endif
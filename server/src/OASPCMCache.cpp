@@ -0,0 +1,247 @@
+/**
+ * @file OASPCMCache.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASPCMCache.h"
+
+using namespace oas;
+
+// Statics
+bool PCMCache::_isEnabled = true;
+
+// static, public
+void PCMCache::setEnabled(bool isEnabled)
+{
+    PCMCache::_isEnabled = isEnabled;
+}
+
+// static, public
+bool PCMCache::isEnabled()
+{
+    return PCMCache::_isEnabled;
+}
+
+// static, public
+bool PCMCache::load(const std::string &filename, Sound &sound)
+{
+    FileHandler fileHandler;
+    struct stat fileInfo;
+
+    sound.release();
+
+    // The size and modification time are taken before the file is read. If the file is replaced
+    // meanwhile, the decoded copy is out of date from the start, and is written again next time.
+    if (!fileHandler.getFileInfo(filename, fileInfo))
+    {
+        oas::Logger::warnf("PCMCache - Could not access \"%s\"", filename.c_str());
+        return false;
+    }
+
+    std::string copyFilename = filename + PCM_CACHE_EXTENSION;
+
+    if (PCMCache::_isEnabled && PCMCache::_readCopy(copyFilename, fileInfo, sound))
+        return true;
+
+    MappedFile file;
+    ALfloat frequency;
+
+    if (!fileHandler.readFile(filename, file))
+        return false;
+
+    // Decoding does not touch the OpenAL context, so it can be done on any thread
+    sound._decodedData = alutLoadMemoryFromFileImage(file.getData(), file.getSize(), &sound._format,
+                                                     &sound._size, &frequency);
+    file.release();
+
+    if (!sound._decodedData)
+        return false;
+
+    sound._data = sound._decodedData;
+    sound._frequency = (ALsizei) frequency;
+
+    if (PCMCache::_isEnabled)
+        PCMCache::_writeCopy(copyFilename, fileInfo, sound);
+
+    return true;
+}
+
+// static, private
+bool PCMCache::_readCopy(const std::string &filename, const struct stat &fileInfo, Sound &sound)
+{
+    FileHandler fileHandler;
+    struct stat copyInfo;
+
+    // Not having a decoded copy yet is no reason to complain
+    if (!fileHandler.getFileInfo(filename, copyInfo) || PCM_CACHE_HEADER_SIZE > copyInfo.st_size)
+        return false;
+
+    if (!fileHandler.readFile(filename, sound._file))
+        return false;
+
+    const Header *header = (const Header *) sound._file.getData();
+    uint64_t dataSize = sound._file.getSize() - PCM_CACHE_HEADER_SIZE;
+    uint32_t frameSize = header->channels * header->bitsPerSample / 8;
+
+    if (PCM_CACHE_MAGIC != header->magic || PCM_CACHE_VERSION != header->version
+        || (uint64_t) fileInfo.st_size != header->fileSize
+        || (int64_t) fileInfo.st_mtim.tv_sec != header->fileModifiedSeconds
+        || (int64_t) fileInfo.st_mtim.tv_nsec != header->fileModifiedNanoseconds)
+    {
+        sound._file.release();
+        return false;
+    }
+
+    if (1 == header->channels && 8 == header->bitsPerSample)
+        sound._format = AL_FORMAT_MONO8;
+    else if (1 == header->channels && 16 == header->bitsPerSample)
+        sound._format = AL_FORMAT_MONO16;
+    else if (2 == header->channels && 8 == header->bitsPerSample)
+        sound._format = AL_FORMAT_STEREO8;
+    else if (2 == header->channels && 16 == header->bitsPerSample)
+        sound._format = AL_FORMAT_STEREO16;
+    else
+        frameSize = 0;
+
+    // A copy that was cut short is written again
+    if (!frameSize || !header->frequency || header->frameCount * frameSize != dataSize
+        || dataSize > (uint64_t) INT_MAX)
+    {
+        oas::Logger::warnf("PCMCache - The decoded copy \"%s\" is damaged, and will be replaced.",
+                           filename.c_str());
+        sound._file.release();
+        return false;
+    }
+
+    sound._data = (const char *) sound._file.getData() + PCM_CACHE_HEADER_SIZE;
+    sound._size = (ALsizei) dataSize;
+    sound._frequency = (ALsizei) header->frequency;
+
+    return true;
+}
+
+// static, private
+void PCMCache::_writeCopy(const std::string &filename, const struct stat &fileInfo,
+                          const Sound &sound)
+{
+    FileHandler fileHandler;
+    char headerBlock[PCM_CACHE_HEADER_SIZE];
+    Header header;
+
+    memset(&header, 0, sizeof(header));
+
+    switch (sound._format)
+    {
+        case AL_FORMAT_MONO8:
+            header.channels = 1;
+            header.bitsPerSample = 8;
+            break;
+        case AL_FORMAT_MONO16:
+            header.channels = 1;
+            header.bitsPerSample = 16;
+            break;
+        case AL_FORMAT_STEREO8:
+            header.channels = 2;
+            header.bitsPerSample = 8;
+            break;
+        case AL_FORMAT_STEREO16:
+            header.channels = 2;
+            header.bitsPerSample = 16;
+            break;
+        default:
+            // Formats of extensions are decoded every time
+            return;
+    }
+
+    header.magic = PCM_CACHE_MAGIC;
+    header.version = PCM_CACHE_VERSION;
+    header.fileSize = fileInfo.st_size;
+    header.fileModifiedSeconds = fileInfo.st_mtim.tv_sec;
+    header.fileModifiedNanoseconds = fileInfo.st_mtim.tv_nsec;
+    header.frequency = sound._frequency;
+
+    unsigned int frameSize = header.channels * header.bitsPerSample / 8;
+
+    // OpenAL would not take a partial frame either
+    if (sound._size % frameSize)
+        return;
+
+    header.frameCount = sound._size / frameSize;
+
+    memset(headerBlock, 0, sizeof(headerBlock));
+    memcpy(headerBlock, &header, sizeof(header));
+
+    // The copy only replaces an older one once it is complete, so readers never see half of it
+    std::string tempPath;
+    int fileDescriptor = fileHandler.createTemporaryFile(filename, tempPath);
+
+    if (-1 == fileDescriptor)
+        return;
+
+    if (!fileHandler.writeToFile(fileDescriptor, headerBlock, sizeof(headerBlock))
+        || !fileHandler.writeToFile(fileDescriptor, (const char *) sound._data, sound._size))
+    {
+        fileHandler.discardTemporaryFile(fileDescriptor, tempPath);
+        return;
+    }
+
+    fileHandler.commitTemporaryFile(fileDescriptor, tempPath, filename);
+}
+
+PCMCache::Sound::Sound() :
+    _decodedData(NULL),
+    _data(NULL),
+    _size(0),
+    _format(AL_NONE),
+    _frequency(0)
+{
+}
+
+PCMCache::Sound::~Sound()
+{
+    release();
+}
+
+// public
+const ALvoid* PCMCache::Sound::getData() const
+{
+    return _data;
+}
+
+// public
+ALsizei PCMCache::Sound::getSize() const
+{
+    return _size;
+}
+
+// public
+ALenum PCMCache::Sound::getFormat() const
+{
+    return _format;
+}
+
+// public
+ALsizei PCMCache::Sound::getFrequency() const
+{
+    return _frequency;
+}
+
+// public
+bool PCMCache::Sound::isFromCache() const
+{
+    return NULL != _file.getData();
+}
+
+// public
+void PCMCache::Sound::release()
+{
+    _file.release();
+    free(_decodedData);
+
+    _decodedData = NULL;
+    _data = NULL;
+    _size = 0;
+    _format = AL_NONE;
+    _frequency = 0;
+}
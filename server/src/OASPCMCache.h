@@ -0,0 +1,144 @@
+/**
+ * @file    OASPCMCache.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_PCM_CACHE_H_
+#define _OAS_PCM_CACHE_H_
+
+#include <string>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <AL/alut.h>
+
+#include "OASFileHandler.h"
+#include "OASMappedFile.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// The decoded copy of a file is cached next to it, under its name with this extension
+#define PCM_CACHE_EXTENSION     ".oaspcm"
+#define PCM_CACHE_MAGIC         0x4d43504f      // "OPCM", read as a little-endian uint32
+#define PCM_CACHE_VERSION       1
+
+/* Layout of a decoded copy. The header is followed by the sound data at PCM_CACHE_HEADER_SIZE,
+ * so that the data starts on a page boundary of a mapping.
+ *  Offset  0:  uint32  magic, always PCM_CACHE_MAGIC
+ *  Offset  4:  uint32  version, always PCM_CACHE_VERSION
+ *  Offset  8:  uint64  size of the original file in bytes
+ *  Offset 16:  int64   time the original file was last modified, in seconds
+ *  Offset 24:  int64   and nanoseconds
+ *  Offset 32:  uint32  sample rate, in hertz
+ *  Offset 36:  uint32  number of channels, 1 or 2
+ *  Offset 40:  uint32  bits per sample, 8 or 16
+ *  Offset 44:  uint32  unused
+ *  Offset 48:  uint64  number of sample frames
+ * The rest of the header is filled with zeros. Numbers are in the byte order of the server.
+ */
+#define PCM_CACHE_HEADER_SIZE   4096
+
+/**
+ * Keeps a decoded copy of each sound file in the cache directory, so that a file only has to be
+ * decoded the first time it is loaded. Later loads map the decoded copy and hand it straight to
+ * OpenAL. A decoded copy is only used while the size and modification time of the original file
+ * match the ones it was decoded from, and is written again otherwise.
+ *
+ * Safe to call from any thread.
+ */
+class PCMCache
+{
+public:
+
+    /**
+     * The decoded sound data of a file, either mapped from its decoded copy, or just decoded
+     */
+    class Sound
+    {
+    public:
+
+        const ALvoid* getData() const;
+        ALsizei getSize() const;
+        ALenum getFormat() const;
+        ALsizei getFrequency() const;
+
+        /**
+         * @brief Check whether the data came from the decoded copy of the file
+         */
+        bool isFromCache() const;
+
+        /**
+         * @brief Release the sound data
+         */
+        void release();
+
+        Sound();
+        ~Sound();
+
+    private:
+        friend class PCMCache;
+
+        // Mapping of the decoded copy, or decoded data that was allocated by ALUT
+        MappedFile _file;
+        ALvoid *_decodedData;
+
+        const ALvoid *_data;
+        ALsizei _size;
+        ALenum _format;
+        ALsizei _frequency;
+
+        Sound(const Sound &other);
+        Sound& operator=(const Sound &other);
+    };
+
+    /**
+     * @brief Turn the decoded copies on or off. They are on by default. When they are off, files
+     *        are always decoded, and no copies are written.
+     */
+    static void setEnabled(bool isEnabled);
+    static bool isEnabled();
+
+    /**
+     * @brief Load the decoded sound data of a file in the cache. The decoded copy is used if it is
+     *        up to date. Otherwise, the file is decoded, and a decoded copy is written for later.
+     * @param filename Name of the file in the cache
+     * @param sound Will hold the sound data, until it is released or goes out of scope
+     * @retval True The file was loaded
+     * @retval False The file could not be read or decoded
+     */
+    static bool load(const std::string &filename, Sound &sound);
+
+private:
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t fileSize;
+        int64_t fileModifiedSeconds;
+        int64_t fileModifiedNanoseconds;
+        uint32_t frequency;
+        uint32_t channels;
+        uint32_t bitsPerSample;
+        uint32_t unused;
+        uint64_t frameCount;
+    };
+
+    static bool _isEnabled;
+
+    static bool _readCopy(const std::string &filename, const struct stat &fileInfo, Sound &sound);
+    static void _writeCopy(const std::string &filename, const struct stat &fileInfo,
+                           const Sound &sound);
+
+    PCMCache();
+    ~PCMCache();
+};
+
+}
+
+#endif
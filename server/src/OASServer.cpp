@@ -4,6 +4,8 @@ oas::Server::Server() :
     _audioHandler(oas::AudioHandler::getInstance())
 {
 	_serverInfo = NULL;
+    _isRetaining = false;
+    _isTerminating = false;
 }
 
 // static
@@ -81,14 +83,101 @@ bool oas::Server::_readConfigFile(int argc, char **argv)
     /*
      * Parse optional sections of the config file:
      *   audioDevice
+     *   udp port
+     *   unix socket
+     *   max parallel transfers
+     *   tick rate
+     *   buffer cache size
+     *   stream threshold
+     *   pcm cache
+     *   preload
+     *   retention time
      *   gui
      */
     std::string audioDevice;
+    std::string datagramPort;
+    std::string localSocketPath;
+    std::string maxParallelTransfers;
+    std::string maxParallelLoads;
+    std::string tickRate;
+    std::string bufferCacheSize;
+    std::string streamThreshold;
+    std::string pcmCache;
+    std::vector<std::string> preloadFiles;
+    std::string retentionTime;
     std::string gui;
 
     if (fh.findXML("audio_device", NULL, NULL, audioDevice) && audioDevice.size())
         this->_serverInfo->setAudioDeviceString(audioDevice);
 
+    // The datagram channel is disabled unless a port is given
+    if (fh.findXML("udp_port", NULL, NULL, datagramPort) && datagramPort.size())
+        this->_serverInfo->setDatagramPort(atol(datagramPort.c_str()));
+
+    // Likewise for the Unix domain socket
+    if (fh.findXML("unix_socket", NULL, NULL, localSocketPath) && localSocketPath.size())
+        this->_serverInfo->setLocalSocketPath(localSocketPath);
+
+    // Negative values disable transfer connections, like 0
+    this->_serverInfo->setMaxParallelTransfers(DEFAULT_MAX_PARALLEL_TRANSFERS);
+
+    if (fh.findXML("max_parallel_transfers", NULL, NULL, maxParallelTransfers) && maxParallelTransfers.size())
+        this->_serverInfo->setMaxParallelTransfers(MAX(0, atoi(maxParallelTransfers.c_str())));
+
+    // Likewise, 0 loads every file on the server thread
+    this->_serverInfo->setMaxParallelLoads(DEFAULT_MAX_PARALLEL_LOADS);
+
+    if (fh.findXML("max_parallel_loads", NULL, NULL, maxParallelLoads) && maxParallelLoads.size())
+        this->_serverInfo->setMaxParallelLoads(MAX(0, atoi(maxParallelLoads.c_str())));
+
+    this->_serverInfo->setTickRate(DEFAULT_TICK_RATE);
+
+    if (fh.findXML("tick_rate", NULL, NULL, tickRate) && tickRate.size())
+        this->_serverInfo->setTickRate(MAX(1, atoi(tickRate.c_str())));
+
+    // Given in megabytes
+    this->_serverInfo->setBufferCacheSize(DEFAULT_BUFFER_CACHE_SIZE * 1024UL * 1024UL);
+
+    if (fh.findXML("buffer_cache_size", NULL, NULL, bufferCacheSize) && bufferCacheSize.size())
+        this->_serverInfo->setBufferCacheSize(MAX(0, atol(bufferCacheSize.c_str())) * 1024UL * 1024UL);
+
+    // Also in megabytes. 0 disables streaming.
+    this->_serverInfo->setStreamThreshold(DEFAULT_STREAM_THRESHOLD * 1024UL * 1024UL);
+
+    if (fh.findXML("stream_threshold", NULL, NULL, streamThreshold) && streamThreshold.size())
+        this->_serverInfo->setStreamThreshold(MAX(0, atol(streamThreshold.c_str())) * 1024UL * 1024UL);
+
+    // Decoded copies are kept unless they are turned off, like the GUI
+    this->_serverInfo->setPCMCache(true);
+
+    if (fh.findXML("pcm_cache", NULL, NULL, pcmCache) && pcmCache.size())
+    {
+        if (!pcmCache.compare("off")
+            || !pcmCache.compare("false")
+            || !pcmCache.compare("no")
+            || !pcmCache.compare("disable")
+            || !pcmCache.compare("disabled"))
+        {
+            this->_serverInfo->setPCMCache(false);
+        }
+    }
+
+    // Sound files that are loaded before any client asks for them
+    if (fh.findAllXML("preload", "file", preloadFiles))
+    {
+        for (unsigned int i = 0; i < preloadFiles.size(); i++)
+        {
+            if (preloadFiles[i].size())
+                this->_serverInfo->addPreloadFile(preloadFiles[i]);
+        }
+    }
+
+    // In seconds. Unlike the other settings, negative values mean something of their own.
+    this->_serverInfo->setRetentionTime(DEFAULT_RETENTION_TIME);
+
+    if (fh.findXML("retention_time", NULL, NULL, retentionTime) && retentionTime.size())
+        this->_serverInfo->setRetentionTime(atol(retentionTime.c_str()));
+
     // GUI is enabled by default. We disable it only if explicitly specified
     this->_serverInfo->setGUI(true);
 
@@ -109,6 +198,72 @@ bool oas::Server::_readConfigFile(int argc, char **argv)
     return true;
 }
 
+// private
+void oas::Server::_preloadFiles()
+{
+    const std::vector<std::string> &filenames = this->_serverInfo->getPreloadFiles();
+
+    if (filenames.empty())
+        return;
+
+    if (oas::LoadHandler::isEnabled())
+        oas::Logger::logf("Preloading %u sound file(s) in the background...",
+                          (unsigned int) filenames.size());
+    else
+        oas::Logger::logf("Preloading %u sound file(s)...", (unsigned int) filenames.size());
+
+    Time start, end;
+    start.update(oas::Time::OAS_CLOCK_MONOTONIC);
+
+    for (unsigned int i = 0; i < filenames.size(); i++)
+        _audioHandler.preloadBuffer(filenames[i]);
+
+    // Background loads are timed as they finish
+    if (!oas::LoadHandler::isEnabled())
+    {
+        end.update(oas::Time::OAS_CLOCK_MONOTONIC);
+        oas::Logger::logf("Preloaded %u sound file(s) in %.1f ms.", (unsigned int) filenames.size(),
+                          (end - start).asDouble() * 1000.0);
+    }
+}
+
+// private
+void oas::Server::_releaseAudioResources()
+{
+    unsigned int delay = 5;
+
+    _isRetaining = false;
+
+    // Release all audio resources and then re-initialize them
+    _audioHandler.release();
+    // If for some reason initialization fails, try again
+    while (!_audioHandler.initialize(getServerInfo()->getAudioDeviceString()))
+    {
+        oas::Logger::errorf("Failed to reset audio resources. Trying again in %d seconds.", delay);
+        sleep(delay);
+        delay += 5;
+    }
+    // The buffers of the configuration were released along with everything else
+    _preloadFiles();
+}
+
+// private
+void oas::Server::_checkRetention(const Time &now)
+{
+    if (!_isRetaining || _retentionDeadline > now)
+        return;
+
+    _isRetaining = false;
+
+    // A client that connected in the meantime is using the audio resources
+    if (oas::SocketHandler::isConnectedToClient())
+        return;
+
+    oas::Logger::logf("No client connected for %ld seconds. Releasing the audio resources.",
+                      getServerInfo()->getRetentionTime());
+    _releaseAudioResources();
+}
+
 // private
 void oas::Server::_processMessage(const Message &message)
 {
@@ -119,7 +274,10 @@ void oas::Server::_processMessage(const Message &message)
     }
     
     int newSource, state;
-    unsigned int delay = 5;
+    char statistics[128];
+
+    // Handles are looked up in the namespace of the session that sent the message
+    _audioHandler.setSession(message.getSessionID());
 
     switch(message.getMessageType())
     {
@@ -138,7 +296,20 @@ void oas::Server::_processMessage(const Message &message)
                 oas::Logger::logf("New sound source created for \"%s\". (Sound ID = %d)",
                                   message.getFilename().c_str(),
                                   newSource);
-            oas::SocketHandler::addOutgoingResponse(newSource);
+            oas::SocketHandler::addOutgoingResponse(message, newSource);
+            break;
+        case oas::Message::MT_GHDC_FN:
+            // Generate new audio source based on the contents of a cached file. The client
+            // uploads the file with PTFC if this fails.
+            newSource = _audioHandler.createSourceForContent(message.getFilename());
+            if (-1 == newSource)
+                oas::Logger::logf("No cached file has the content hash %s.",
+                                  message.getFilename().c_str());
+            else
+                oas::Logger::logf("New sound source created for content %s. (Sound ID = %d)",
+                                  message.getFilename().c_str(),
+                                  newSource);
+            oas::SocketHandler::addOutgoingResponse(message, newSource);
             break;
         case oas::Message::MT_WAVE_1I_3F:
             newSource = _audioHandler.createSource(message.getIntegerParam(),
@@ -155,12 +326,13 @@ void oas::Server::_processMessage(const Message &message)
                                     "    waveshape = %d, freq = %.2f, phase = %.2f, duration = %.2f",
                                     message.getIntegerParam(), message.getFloatParam(0), message.getFloatParam(1),
                                     message.getFloatParam(2));
-            oas::SocketHandler::addOutgoingResponse(newSource);
+            oas::SocketHandler::addOutgoingResponse(message, newSource);
             break;
         case oas::Message::MT_RHDL_HL:
             _audioHandler.deleteSource(message.getHandle());
             break;
         case oas::Message::MT_PTFI_FN_1I:
+        case oas::Message::MT_PTFC_FN_1I:
             // Shouldn't need to do anything!
             break;
         case oas::Message::MT_PLAY_HL:
@@ -232,7 +404,7 @@ void oas::Server::_processMessage(const Message &message)
             break;
         case oas::Message::MT_STAT_HL:
             state = _audioHandler.getSourceState(message.getHandle());
-            oas::SocketHandler::addOutgoingResponse(state);
+            oas::SocketHandler::addOutgoingResponse(message, state);
             break;
         case oas::Message::MT_SLPO_3F:
             _audioHandler.setListenerPosition(message.getFloatParam(0),
@@ -270,23 +442,69 @@ void oas::Server::_processMessage(const Message &message)
             break;
         case oas::Message::MT_TEST:
             break;
+        case oas::Message::MT_BTCH_1I:
+            // Everything up to the end of the batch reaches the mixer at once
+            _audioHandler.deferUpdates();
+            break;
+        case oas::Message::MT_BTCH_END:
+            _audioHandler.processUpdates();
+            break;
+        case oas::Message::MT_SHUTDOWN:
+            // Queued up last by SocketHandler::terminate(), so no more messages will arrive
+            _isTerminating = true;
+            break;
         case oas::Message::MT_SYNC:
             // Send a simple "SYNC" response
-            oas::SocketHandler::addOutgoingResponse("SYNC");
+            oas::SocketHandler::addOutgoingResponse(message, "SYNC");
+            break;
+        case oas::Message::MT_PRLD_FN:
+            // Load the file into a buffer ahead of time. There is no response.
+            _audioHandler.preloadBuffer(message.getFilename());
+            break;
+        case oas::Message::MT_BUFS:
+            // The size of every buffer goes to the log, and the totals to the client
+            _audioHandler.getBufferCache().logContents();
+            snprintf(statistics, sizeof(statistics), "%u %lu %lu %lu %lu %lu",
+                     _audioHandler.getBufferCache().getCount(),
+                     _audioHandler.getBufferCache().getTotalSize(),
+                     _audioHandler.getBufferCache().getBudget(),
+                     _audioHandler.getBufferCache().getHitCount(),
+                     _audioHandler.getBufferCache().getMissCount(),
+                     _audioHandler.getBufferCache().getEvictionCount());
+            oas::SocketHandler::addOutgoingResponse(message, statistics);
             break;
         case oas::Message::MT_QUIT:
-            oas::Logger::logf("Terminating current session.");
+            oas::Logger::logf("Terminating session %u.", message.getSessionID());
+            _logUpdateCounts();
+            _logTickStatistics();
+            _logSourcePoolStatistics();
+            // Release only the sources that belong to the session that ended
+            _audioHandler.releaseSession(message.getSessionID());
+
+            // Other clients are still using the audio resources
+            if (oas::SocketHandler::isConnectedToClient())
+                break;
+
 #ifdef FLTK_FOUND
             oas::ServerWindow::reset();
 #endif
-            // Will need to release all audio resources and then re-initialize them
-            _audioHandler.release();
-            // If for some reason initialization fails, try again
-            while (!_audioHandler.initialize(getServerInfo()->getAudioDeviceString()))
+            // The last client disconnected. The next one starts from a clean slate, but the
+            // device and the loaded buffers are kept, so that its sounds are ready right away.
+            _audioHandler.reset();
+
+            if (0 == getServerInfo()->getRetentionTime())
             {
-                oas::Logger::errorf("Failed to reset audio resources. Trying again in %d seconds.", delay);
-                sleep(delay);
-                delay += 5;
+                _releaseAudioResources();
+            }
+            else if (0 < getServerInfo()->getRetentionTime())
+            {
+                _isRetaining = true;
+                _retentionDeadline.update(oas::Time::OAS_CLOCK_MONOTONIC);
+                _retentionDeadline += Time((double) getServerInfo()->getRetentionTime());
+                oas::Logger::logf("Keeping %u buffer(s) of %lu KB for %ld seconds.",
+                                  _audioHandler.getBufferCache().getCount(),
+                                  _audioHandler.getBufferCache().getTotalSize() / 1024UL,
+                                  getServerInfo()->getRetentionTime());
             }
             break;
         default:
@@ -315,12 +533,72 @@ void oas::Server::initialize(int argc, char **argv)
         _fatalError("Could not initialize the File Handler!");
     }
 
+    if (!oas::ContentIndex::initialize(this->_serverInfo->getCacheDirectory()))
+    {
+        _fatalError("Could not initialize the content index!");
+    }
+
     if (!_audioHandler.initialize(this->_serverInfo->getAudioDeviceString()))
     {
         _fatalError("Could not initialize the Audio Handler!");
     }
 
-    if (!oas::SocketHandler::initialize(this->_serverInfo->getPort()))
+    _audioHandler.setBufferCacheSize(this->_serverInfo->getBufferCacheSize());
+    oas::Logger::logf("Sound files that are not in use are kept loaded, up to %lu MB.",
+                      this->_serverInfo->getBufferCacheSize() / (1024UL * 1024UL));
+
+    _audioHandler.setStreamThreshold(this->_serverInfo->getStreamThreshold());
+
+    if (this->_serverInfo->getStreamThreshold())
+        oas::Logger::logf("WAVE files of %lu MB or more are streamed from disk.",
+                          this->_serverInfo->getStreamThreshold() / (1024UL * 1024UL));
+    else
+        oas::Logger::logf("Streaming from disk is disabled.");
+
+    oas::PCMCache::setEnabled(this->_serverInfo->usePCMCache());
+
+    if (this->_serverInfo->usePCMCache())
+        oas::Logger::logf("Decoded copies of sound files are kept in the cache directory.");
+    else
+        oas::Logger::logf("Sound files are decoded every time they are loaded.");
+
+    if (!oas::StreamHandler::initialize())
+    {
+        _fatalError("Could not initialize the Stream Handler!");
+    }
+
+    if (!oas::LoadHandler::initialize(this->_serverInfo->getMaxParallelLoads()))
+    {
+        _fatalError("Could not initialize the Load Handler!");
+    }
+
+    // With background loads, clients are accepted while the files are loading. Otherwise, the
+    // files are decoded right here, before the sockets are opened.
+    if (!oas::LoadHandler::isEnabled() && !this->_serverInfo->getPreloadFiles().empty())
+        oas::Logger::logf("Background loads are disabled, so clients are accepted once the "
+                          "preloaded files are in.");
+
+    _preloadFiles();
+
+    if (0 < this->_serverInfo->getRetentionTime())
+        oas::Logger::logf("Loaded sound files are kept for %ld seconds after the last client disconnects.",
+                          this->_serverInfo->getRetentionTime());
+    else if (0 == this->_serverInfo->getRetentionTime())
+        oas::Logger::logf("Loaded sound files are released when the last client disconnects.");
+    else
+        oas::Logger::logf("Loaded sound files are kept after the last client disconnects.");
+
+    _ticker.setRate(this->_serverInfo->getTickRate());
+    oas::Logger::logf("Playing and fading sources are updated %u times per second.", _ticker.getRate());
+
+    if (!oas::TransferHandler::initialize(this->_serverInfo->getMaxParallelTransfers()))
+    {
+        _fatalError("Could not initialize the Transfer Handler!");
+    }
+
+    if (!oas::SocketHandler::initialize(this->_serverInfo->getPort(),
+                                        this->_serverInfo->getDatagramPort(),
+                                        this->_serverInfo->getLocalSocketPath()))
     {
         _fatalError("Could not initialize the Socket Handler!");
     }
@@ -359,54 +637,58 @@ void oas::Server::initialize(int argc, char **argv)
 
 #ifdef FLTK_FOUND
 // private
-void* oas::Server::_run(void *parameter)
+void* oas::Server::_run(void *)
 {
-    std::queue<Message*> messages;
+    Message *nextMessage;
     std::queue<const AudioUnit*> sources;
-    const AudioUnit *audioUnit;
-
-    Time timeOut;
+    bool hasMessages;
+    Time now;
 
     // Add the listener to the GUI, before the loop even starts
     oas::ServerWindow::audioListenerWasModified(_audioHandler.getListener());
 
-    while (1)
-    {
-    	// Update timeOut to current time
-    	timeOut.update(oas::Time::OAS_CLOCK_MONOTONIC);
+    // Files that are preloaded in the background are picked up on the ticks
+    now.update(oas::Time::OAS_CLOCK_MONOTONIC);
+    _ticker.update(_audioHandler.isLoading(), now);
 
-        // If a client is connected, use a very short timeout allowing for fast updates
-        if (SocketHandler::isConnectedToClient())
-        	timeOut += Time(0.0005); 	// 0.5 ms -> maximum of ~2000 loop iterations per second
-        // Else use a longer timeout to save CPU cycles
-        else
-            timeOut += Time(2);
+    while (!_isTerminating)
+    {
+        // Sleep until a message arrives, or until the next tick if any source is playing or
+        // fading. Messages are applied as soon as they arrive, regardless of the ticks.
+        oas::SocketHandler::waitForIncomingMessages(_ticker.getNextTick());
 
-        // If there are no incoming messages, populateQueueWithIncomingMessages() will block
-        // until timeout
-        oas::SocketHandler::populateQueueWithIncomingMessages(messages, timeOut);
+        hasMessages = false;
 
-        while (!messages.empty())
+        while (NULL != (nextMessage = oas::Server::getInstance()._getNextMessage()))
         {
-            Message *nextMessage = messages.front();
-            oas::Server::getInstance()._processMessage(*nextMessage);
-//            oas::Logger::logf("Server processed message \"%s\"", nextMessage->getOriginalString().c_str());
-            delete nextMessage;
-            messages.pop();
+            hasMessages = true;
 
-            audioUnit = _audioHandler.getRecentlyModifiedAudioUnit();
-            if (audioUnit)
+            // Parameter updates are held back until something else needs to be processed, or
+            // until everything has been drained, so that only their final values are applied
+            if (!_coalescer.add(*nextMessage))
             {
-                // Call ServerWindow method that will queue up the source
-                oas::ServerWindow::audioUnitWasModified(audioUnit);
+                _applyCoalescedUpdates();
+                _applyMessage(*nextMessage);
             }
+//            oas::Logger::logf("Server processed message \"%s\"", nextMessage->getOriginalString().c_str());
+            oas::SocketHandler::releaseIncomingMessage(nextMessage);
         }
 
-        _audioHandler.populateQueueWithUpdatedSources(sources);
+        _applyCoalescedUpdates();
 
-        if (!sources.empty())
-             oas::ServerWindow::audioSourcesWereModified(sources);
+        now.update(oas::Time::OAS_CLOCK_MONOTONIC);
 
+        // The loop wakes up at least every IDLE_TICK_TIMEOUT, even without clients
+        _checkRetention(now);
+
+        // The messages may have started a source, or released some for the GUI to remove
+        if (_ticker.isDue(now) || (hasMessages && !_ticker.isRunning()))
+        {
+            _ticker.update(_audioHandler.populateQueueWithUpdatedSources(sources), now);
+
+            if (!sources.empty())
+                 oas::ServerWindow::audioSourcesWereModified(sources);
+        }
     }
 
     return NULL;
@@ -414,40 +696,144 @@ void* oas::Server::_run(void *parameter)
 #endif
 
 // private
-void* oas::Server::_runNoGUI(void *parameter)
+void* oas::Server::_runNoGUI(void *)
 {
-    std::queue<Message*> messages;
-    Time timeOut;
+    Message *nextMessage;
+    bool hasMessages;
+    Time now;
+
+    // See _run()
+    now.update(oas::Time::OAS_CLOCK_MONOTONIC);
+    _ticker.update(_audioHandler.isLoading(), now);
 
-    while (1)
+    while (!_isTerminating)
     {
-        // Update timeOut to current time
+        // Sleep until a message arrives, or until the next tick. See _run().
+        oas::SocketHandler::waitForIncomingMessages(_ticker.getNextTick());
+
+        hasMessages = false;
+
+        while (NULL != (nextMessage = oas::Server::getInstance()._getNextMessage()))
+        {
+            hasMessages = true;
+
+            // See _run()
+            if (!_coalescer.add(*nextMessage))
+            {
+                _applyCoalescedUpdates();
+                _applyMessage(*nextMessage);
+            }
+            //oas::Logger::logf("Server processed message \"%s\"", nextMessage->getOriginalString().c_str());
+            oas::SocketHandler::releaseIncomingMessage(nextMessage);
+        }
+
+        _applyCoalescedUpdates();
+
+        now.update(oas::Time::OAS_CLOCK_MONOTONIC);
+
+        // See _run()
+        _checkRetention(now);
+
+        // The messages may have started a source
+        if (_ticker.isDue(now) || (hasMessages && !_ticker.isRunning()))
+            _ticker.update(_audioHandler.updateSources(), now);
+    }
+
+    return NULL;
+}
+
+// private
+oas::Message* oas::Server::_getNextMessage()
+{
+    Message *message = oas::SocketHandler::getNextIncomingMessage();
+
+    // The socket thread only starts forwarding a batch once all of it has been received, so the
+    // rest of an open batch is already on its way. Wait for it, so that the whole batch is
+    // applied within this iteration of the loop.
+    if (!message && _audioHandler.isDeferringUpdates())
+    {
+        // What has been drained so far must not wait on the rest of the batch
+        _applyCoalescedUpdates();
+
+        Time timeOut;
         timeOut.update(oas::Time::OAS_CLOCK_MONOTONIC);
+        timeOut += Time(BATCH_COMPLETION_TIMEOUT);
 
-        // If a client is connected, use a very short timeout allowing for fast updates
-        if (SocketHandler::isConnectedToClient())
-            timeOut += Time(0.0005);    // 0.5 ms -> maximum of ~2000 loop iterations per second
-        // Else use a longer timeout to save CPU cycles
+        if (oas::SocketHandler::waitForIncomingMessages(timeOut))
+        {
+            message = oas::SocketHandler::getNextIncomingMessage();
+        }
         else
-            timeOut += Time(2);
+        {
+            oas::Logger::warnf("The end of a batch did not arrive in time. Applying it anyway.");
+            _audioHandler.processUpdates();
+        }
+    }
 
-        // If there are no incoming messages, populateQueueWithIncomingMessages() will block
-        // until timeout
-        oas::SocketHandler::populateQueueWithIncomingMessages(messages, timeOut);
+    return message;
+}
 
-        while (!messages.empty())
+// private
+void oas::Server::_applyMessage(const Message &message)
+{
+    _processMessage(message);
+
+#ifdef FLTK_FOUND
+    if (getServerInfo()->useGUI())
+    {
+        const AudioUnit *audioUnit = _audioHandler.getRecentlyModifiedAudioUnit();
+        if (audioUnit)
         {
-            Message *nextMessage = messages.front();
-            oas::Server::getInstance()._processMessage(*nextMessage);
-            //oas::Logger::logf("Server processed message \"%s\"", nextMessage->getOriginalString().c_str());
-            delete nextMessage;
-            messages.pop();
+            // Call ServerWindow method that will queue up the source
+            oas::ServerWindow::audioUnitWasModified(audioUnit);
         }
+    }
+#endif
+}
 
-        _audioHandler.updateSources();
+// private
+void oas::Server::_applyCoalescedUpdates()
+{
+    for (unsigned int i = 0; i < _coalescer.size(); i++)
+    {
+        _applyMessage(_coalescer.at(i));
     }
 
-    return NULL;
+    _coalescer.clear();
+}
+
+// private
+void oas::Server::_logUpdateCounts()
+{
+    oas::Logger::logf("%lu parameter updates received, %lu coalesced with a later update, "
+                      "%lu skipped as unchanged.",
+                      _coalescer.getUpdateCount(),
+                      _coalescer.getCoalescedCount(),
+                      _audioHandler.getUnchangedUpdateCount());
+}
+
+// private
+void oas::Server::_logTickStatistics()
+{
+    oas::Logger::logf("%lu ticks at %u Hz, late by %.1f us on average and %.1f us at most, "
+                      "%lu skipped.",
+                      _ticker.getTickCount(),
+                      _ticker.getRate(),
+                      _ticker.getAverageJitter() * 1000000.0,
+                      _ticker.getMaximumJitter() * 1000000.0,
+                      _ticker.getSkippedCount());
+}
+
+// private
+void oas::Server::_logSourcePoolStatistics()
+{
+    oas::Logger::logf("%u of %u voices in use, at most %u at once. Sound sources found no free "
+                      "voice %lu times, and lost their voice to a more audible source %lu times.",
+                      SourcePool::getNumberInUse(),
+                      SourcePool::getSize(),
+                      SourcePool::getHighWaterMark(),
+                      SourcePool::getExhaustedCount(),
+                      _audioHandler.getVoiceTransferCount());
 }
 
 // private
@@ -464,10 +850,17 @@ void oas::Server::_fatalError(const char *errorMessage)
 
 void oas::Server::_atExit()
 {
+    // This stops the socket thread and the transfer workers, and disconnects every client. The
+    // server thread then stops once it has processed the messages that are still queued up.
+    oas::SocketHandler::terminate();
+    pthread_join(this->_serverThread, NULL);
+
 #ifdef FLTK_FOUND
-        oas::ServerWindow::reset();
+    oas::ServerWindow::reset();
 #endif
-    oas::SocketHandler::terminate();
+    // Nothing else uses the audio resources any more
+    oas::StreamHandler::terminate();
+    oas::LoadHandler::terminate();
     _audioHandler.release();
 }
 
@@ -476,12 +869,12 @@ void oas::Server::terminate()
     oas::Server::getInstance()._atExit();
 }
 
-void* oas::Server::runServer(void *parameter)
+void* oas::Server::runServer(void *)
 {
     return oas::Server::getInstance()._run();
 }
 
-void* oas::Server::runServerNoGUI(void *parameter)
+void* oas::Server::runServerNoGUI(void *)
 {
     return oas::Server::getInstance()._runNoGUI();
 }
@@ -14,7 +14,13 @@
 
 #include "OASFileHandler.h"
 #include "OASSocketHandler.h"
+#include "OASTransferHandler.h"
+#include "OASStreamHandler.h"
+#include "OASLoadHandler.h"
+#include "OASPCMCache.h"
 #include "OASMessage.h"
+#include "OASMessageCoalescer.h"
+#include "OASTickScheduler.h"
 #include "OASAudioHandler.h"
 #include "OASServerInfo.h"
 #include "OASLogger.h"
@@ -31,6 +37,13 @@
 namespace oas
 {
 
+// Longest time, in seconds, that the server waits for the rest of a batch that has been started
+#define BATCH_COMPLETION_TIMEOUT    0.1
+
+// Time, in seconds, that the device and the loaded buffers are kept after the last client
+// disconnects. 0 releases them right away, and a negative time keeps them for good.
+#define DEFAULT_RETENTION_TIME      600
+
 
 class Server
 {
@@ -53,13 +66,35 @@ private:
 
     AudioHandler& _audioHandler;
 
+    // Parameter updates drained in the current iteration of the loop, but not applied yet
+    MessageCoalescer _coalescer;
+
+    // Decides when playing and fading sources are updated
+    TickScheduler _ticker;
+
+    // Whether the audio resources are being kept after the last client disconnected, and until when
+    bool _isRetaining;
+    Time _retentionDeadline;
+
+    // Set by the server thread once it has processed the last message, before the server exits
+    bool _isTerminating;
+
     void* _run(void *parameter = NULL);
     void* _runNoGUI(void *parameter = NULL);
 
     // private worker methods
     bool _readConfigFile(int argc, char **argv);
 
+    void _preloadFiles();
+    void _releaseAudioResources();
+    void _checkRetention(const Time &now);
     void _processMessage(const Message &message);
+    void _applyMessage(const Message &message);
+    void _applyCoalescedUpdates();
+    void _logUpdateCounts();
+    void _logTickStatistics();
+    void _logSourcePoolStatistics();
+    Message* _getNextMessage();
     void _fatalError(const char *errorMessage);
     void _atExit();
 
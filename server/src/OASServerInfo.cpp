@@ -5,6 +5,15 @@ using namespace oas;
 ServerInfo::ServerInfo():
 	_cacheDirectory(""),
 	_port(0),
+	_datagramPort(0),
+	_localSocketPath(""),
+	_maxParallelTransfers(0),
+	_maxParallelLoads(0),
+	_tickRate(0),
+	_bufferCacheSize(0),
+	_streamThreshold(0),
+	_usePCMCache(true),
+	_retentionTime(0),
 	_audioDeviceString(""),
 	_useGUI(true)
 {
@@ -14,6 +23,15 @@ ServerInfo::ServerInfo():
 ServerInfo::ServerInfo( std::string const& cacheDirectory, long int port):
                         _cacheDirectory(cacheDirectory),
                         _port(port),
+                        _datagramPort(0),
+                        _localSocketPath(""),
+                        _maxParallelTransfers(0),
+                        _maxParallelLoads(0),
+                        _tickRate(0),
+                        _bufferCacheSize(0),
+                        _streamThreshold(0),
+                        _usePCMCache(true),
+                        _retentionTime(0),
                         _audioDeviceString(""),
                         _useGUI(true)
 {
@@ -30,6 +48,106 @@ long int ServerInfo::getPort() const
     return this->_port;
 }
 
+long int ServerInfo::getDatagramPort() const
+{
+    return this->_datagramPort;
+}
+
+void ServerInfo::setDatagramPort(long int port)
+{
+    this->_datagramPort = port;
+}
+
+std::string const& ServerInfo::getLocalSocketPath() const
+{
+    return this->_localSocketPath;
+}
+
+void ServerInfo::setLocalSocketPath(std::string const& localSocketPath)
+{
+    this->_localSocketPath = localSocketPath;
+}
+
+unsigned int ServerInfo::getMaxParallelTransfers() const
+{
+    return this->_maxParallelTransfers;
+}
+
+void ServerInfo::setMaxParallelTransfers(unsigned int maxParallelTransfers)
+{
+    this->_maxParallelTransfers = maxParallelTransfers;
+}
+
+unsigned int ServerInfo::getMaxParallelLoads() const
+{
+    return this->_maxParallelLoads;
+}
+
+void ServerInfo::setMaxParallelLoads(unsigned int maxParallelLoads)
+{
+    this->_maxParallelLoads = maxParallelLoads;
+}
+
+unsigned int ServerInfo::getTickRate() const
+{
+    return this->_tickRate;
+}
+
+void ServerInfo::setTickRate(unsigned int tickRate)
+{
+    this->_tickRate = tickRate;
+}
+
+unsigned long ServerInfo::getBufferCacheSize() const
+{
+    return this->_bufferCacheSize;
+}
+
+void ServerInfo::setBufferCacheSize(unsigned long bufferCacheSize)
+{
+    this->_bufferCacheSize = bufferCacheSize;
+}
+
+unsigned long ServerInfo::getStreamThreshold() const
+{
+    return this->_streamThreshold;
+}
+
+void ServerInfo::setStreamThreshold(unsigned long streamThreshold)
+{
+    this->_streamThreshold = streamThreshold;
+}
+
+bool ServerInfo::usePCMCache() const
+{
+    return this->_usePCMCache;
+}
+
+void ServerInfo::setPCMCache(bool usePCMCache)
+{
+    this->_usePCMCache = usePCMCache;
+}
+
+std::vector<std::string> const& ServerInfo::getPreloadFiles() const
+{
+    return this->_preloadFiles;
+}
+
+void ServerInfo::addPreloadFile(std::string const& filename)
+{
+    this->_preloadFiles.push_back(filename);
+}
+
+long int ServerInfo::getRetentionTime() const
+{
+    return this->_retentionTime;
+}
+
+void ServerInfo::setRetentionTime(long int retentionTime)
+{
+    this->_retentionTime = retentionTime;
+}
+
 std::string const& ServerInfo::getAudioDeviceString() const
 {
     return this->_audioDeviceString;
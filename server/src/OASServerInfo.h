@@ -7,6 +7,7 @@
 #define _OAS_SERVER_INFO_H_
 
 #include <string>
+#include <vector>
 #include <cstdlib>
 
 namespace oas
@@ -19,6 +20,36 @@ public:
     std::string const& getCacheDirectory() const;
     long int getPort() const;
 
+    long int getDatagramPort() const;
+    void setDatagramPort(long int port);
+
+    std::string const& getLocalSocketPath() const;
+    void setLocalSocketPath(std::string const& localSocketPath);
+
+    unsigned int getMaxParallelTransfers() const;
+    void setMaxParallelTransfers(unsigned int maxParallelTransfers);
+
+    unsigned int getMaxParallelLoads() const;
+    void setMaxParallelLoads(unsigned int maxParallelLoads);
+
+    unsigned int getTickRate() const;
+    void setTickRate(unsigned int tickRate);
+
+    unsigned long getBufferCacheSize() const;
+    void setBufferCacheSize(unsigned long bufferCacheSize);
+
+    unsigned long getStreamThreshold() const;
+    void setStreamThreshold(unsigned long streamThreshold);
+
+    bool usePCMCache() const;
+    void setPCMCache(bool usePCMCache);
+
+    std::vector<std::string> const& getPreloadFiles() const;
+    void addPreloadFile(std::string const& filename);
+
+    long int getRetentionTime() const;
+    void setRetentionTime(long int retentionTime);
+
     std::string const& getAudioDeviceString() const;
     void setAudioDeviceString(std::string const& audioDevice);
 
@@ -32,6 +63,16 @@ private:
 
     std::string _cacheDirectory;
     long int _port;
+    long int _datagramPort;
+    std::string _localSocketPath;
+    unsigned int _maxParallelTransfers;
+    unsigned int _maxParallelLoads;
+    unsigned int _tickRate;
+    unsigned long _bufferCacheSize;
+    unsigned long _streamThreshold;
+    bool _usePCMCache;
+    std::vector<std::string> _preloadFiles;
+    long int _retentionTime;
     std::string _audioDeviceString;
     bool _useGUI;
 };
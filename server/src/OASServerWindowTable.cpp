@@ -158,13 +158,14 @@ void ServerWindowTable::_updateAudioUnitMap(std::queue<const AudioUnit*> &queue)
         if (!unit)
             continue;
 
-        // Try to find an audio unit with the same handle in the map
-        AudioUnitMapIterator iterator = _audioUnitMap.find(unit->getHandle());
+        // Try to find an audio unit with the same session and handle in the map
+        AudioUnitKey key(unit->getSession(), unit->getHandle());
+        AudioUnitMapIterator iterator = _audioUnitMap.find(key);
 
         // If we did not find one, then our job is easy - we insert into the map
         if (iterator == _audioUnitMap.end())
         {
-            _audioUnitMap.insert(AudioUnitPair(unit->getHandle(), unit));
+            _audioUnitMap.insert(AudioUnitPair(key, unit));
             rows(_audioUnitMap.size());
         }
         else
@@ -264,7 +265,8 @@ void ServerWindowTable::draw_cell(TableContext context, int ROW = 0, int COL = 0
             this->_drawHeader(buffer, X, Y, W, H);
             break;
         case CONTEXT_ROW_HEADER: // Draw row headers
-            sprintf(buffer, "%03d:", _audioUnitVector[ROW]->getHandle()); // "001:", "002:", etc
+            sprintf(buffer, "%u:%03d:", _audioUnitVector[ROW]->getSession(),
+                    _audioUnitVector[ROW]->getHandle()); // "1:001:", "1:002:", etc
             this->_drawHeader(buffer, X, Y, W, H);
             break;
         case CONTEXT_CELL: // Draw data in cells
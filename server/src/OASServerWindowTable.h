@@ -21,10 +21,12 @@ namespace oas
 {
 // Types for managing the state of audio units
 
-typedef std::map<unsigned int, const AudioUnit*>    AudioUnitMap;
+// Audio units are keyed by their session and their handle, since handles are unique per session
+typedef std::pair<unsigned int, unsigned int>       AudioUnitKey;
+typedef std::map<AudioUnitKey, const AudioUnit*>    AudioUnitMap;
 typedef AudioUnitMap::iterator                      AudioUnitMapIterator;
 typedef AudioUnitMap::const_iterator                AudioUnitMapConstIterator;
-typedef std::pair<unsigned int, const AudioUnit*>   AudioUnitPair;
+typedef std::pair<AudioUnitKey, const AudioUnit*>   AudioUnitPair;
 
 class ServerWindowTable : public Fl_Table 
 {
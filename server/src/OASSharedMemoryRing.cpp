@@ -0,0 +1,176 @@
+/**
+ * @file OASSharedMemoryRing.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASSharedMemoryRing.h"
+
+using namespace oas;
+
+SharedMemoryRing::SharedMemoryRing() :
+    _header(NULL),
+    _data(NULL),
+    _mappedSize(0),
+    _capacity(0),
+    _readIndex(0),
+    _isSleeping(false),
+    _memoryHandle(-1),
+    _wakeupHandle(-1)
+{
+}
+
+SharedMemoryRing::~SharedMemoryRing()
+{
+    release();
+}
+
+// public
+bool SharedMemoryRing::create(unsigned int capacity)
+{
+    static unsigned int nextID = 0;
+    char name[64];
+
+    release();
+
+    // The name only exists until the memory has been opened. The client gets the descriptor.
+    snprintf(name, sizeof(name), "/oas-ring-%d-%u", (int) getpid(), nextID++);
+
+    _memoryHandle = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (-1 == _memoryHandle)
+    {
+        oas::Logger::errorf("SharedMemoryRing - Could not create shared memory! %s", strerror(errno));
+        return false;
+    }
+
+    shm_unlink(name);
+
+    _mappedSize = SHARED_MEMORY_RING_DATA_OFFSET + capacity;
+
+    if (0 != ftruncate(_memoryHandle, _mappedSize))
+    {
+        oas::Logger::errorf("SharedMemoryRing - Could not size shared memory! %s", strerror(errno));
+        release();
+        return false;
+    }
+
+    void *memory = mmap(NULL, _mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, _memoryHandle, 0);
+
+    if (MAP_FAILED == memory)
+    {
+        oas::Logger::errorf("SharedMemoryRing - Could not map shared memory! %s", strerror(errno));
+        release();
+        return false;
+    }
+
+    _header = (Header *) memory;
+    _data = (char *) memory + SHARED_MEMORY_RING_DATA_OFFSET;
+    _capacity = capacity;
+    _readIndex = 0;
+
+    _wakeupHandle = eventfd(0, EFD_NONBLOCK);
+
+    if (-1 == _wakeupHandle)
+    {
+        oas::Logger::errorf("SharedMemoryRing - Could not create event descriptor! %s", strerror(errno));
+        release();
+        return false;
+    }
+
+    // The new memory is filled with zeros, so only the constants have to be set
+    _header->magic = SHARED_MEMORY_RING_MAGIC;
+    _header->capacity = capacity;
+    return true;
+}
+
+// public
+void SharedMemoryRing::release()
+{
+    if (_header)
+        munmap(_header, _mappedSize);
+    if (-1 != _wakeupHandle)
+        close(_wakeupHandle);
+
+    closeMemoryDescriptor();
+
+    _header = NULL;
+    _data = NULL;
+    _mappedSize = 0;
+    _capacity = 0;
+    _wakeupHandle = -1;
+}
+
+// public
+int SharedMemoryRing::getMemoryDescriptor() const
+{
+    return _memoryHandle;
+}
+
+// public
+void SharedMemoryRing::closeMemoryDescriptor()
+{
+    if (-1 != _memoryHandle)
+        close(_memoryHandle);
+
+    _memoryHandle = -1;
+}
+
+// public
+int SharedMemoryRing::getWakeupDescriptor() const
+{
+    return _wakeupHandle;
+}
+
+// public
+int SharedMemoryRing::read(char *buf, unsigned int size)
+{
+    uint32_t writeIndex = __atomic_load_n(&_header->writeIndex, __ATOMIC_ACQUIRE);
+    uint32_t available = writeIndex - _readIndex;
+
+    if (available > _capacity)
+        return -1;
+
+    unsigned int amount = (available < size) ? available : size;
+    unsigned int offset = _readIndex & (_capacity - 1);
+    unsigned int firstPart = (amount < _capacity - offset) ? amount : _capacity - offset;
+
+    // The bytes may wrap around the end of the data area
+    memcpy(buf, _data + offset, firstPart);
+    memcpy(buf + firstPart, _data, amount - firstPart);
+
+    // Hand the space back to the client
+    _readIndex += amount;
+    __atomic_store_n(&_header->readIndex, _readIndex, __ATOMIC_RELEASE);
+
+    return amount;
+}
+
+// public
+bool SharedMemoryRing::prepareToSleep()
+{
+    if (!_isSleeping)
+    {
+        __atomic_store_n(&_header->isServerSleeping, 1, __ATOMIC_RELAXED);
+        _isSleeping = true;
+    }
+
+    // The client publishes its index before it checks the flag, so one of the two is
+    // guaranteed to see the other
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return (__atomic_load_n(&_header->writeIndex, __ATOMIC_ACQUIRE) == _readIndex);
+}
+
+// public
+void SharedMemoryRing::wakeUp()
+{
+    if (_isSleeping)
+    {
+        eventfd_t value;
+
+        __atomic_store_n(&_header->isServerSleeping, 0, __ATOMIC_RELAXED);
+        eventfd_read(_wakeupHandle, &value);
+        _isSleeping = false;
+    }
+}
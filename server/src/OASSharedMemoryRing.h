@@ -0,0 +1,121 @@
+/**
+ * @file    OASSharedMemoryRing.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_SHARED_MEMORY_RING_H_
+#define _OAS_SHARED_MEMORY_RING_H_
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <stdint.h>
+
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Number of bytes the ring can hold. Must be a power of two.
+#define SHARED_MEMORY_RING_CAPACITY     (256 * 1024)
+#define SHARED_MEMORY_RING_MAGIC        0x5253414f      // "OASR", read as a little-endian uint32
+
+/* Layout of the shared memory. The header is followed by the data at SHARED_MEMORY_RING_DATA_OFFSET.
+ *  Offset  0:  uint32  magic, always SHARED_MEMORY_RING_MAGIC
+ *  Offset  4:  uint32  capacity of the data area in bytes, a power of two
+ *  Offset 64:  uint32  write index. Total number of bytes written by the client.
+ *  Offset 128: uint32  read index. Total number of bytes read by the server.
+ *  Offset 132: uint32  non-zero while the server is asleep, and must be woken up through the
+ *                      event descriptor once more bytes have been written
+ * The indices wrap around, and the data for an index is at (index & (capacity - 1)).
+ */
+#define SHARED_MEMORY_RING_DATA_OFFSET  256
+
+/**
+ * Ring of bytes in memory that is shared with a client on the same machine. The client writes the
+ * same stream of messages that it would otherwise write to its connection, and the server reads
+ * them out without any system call on either side.
+ *
+ * The client only has to signal the event descriptor when the server has announced that it is
+ * about to sleep. Only the socket thread may use this class.
+ */
+class SharedMemoryRing
+{
+public:
+
+    /**
+     * @brief Create the shared memory and the event descriptor that wakes up the server.
+     */
+    bool create(unsigned int capacity);
+
+    /**
+     * @brief Unmap the shared memory and close the descriptors
+     */
+    void release();
+
+    /**
+     * @brief Get the descriptor of the shared memory, to be passed to the client. It is closed by
+     *        release(), or by closeMemoryDescriptor() once it has been passed on.
+     */
+    int getMemoryDescriptor() const;
+    void closeMemoryDescriptor();
+
+    /**
+     * @brief Get the event descriptor that the client signals to wake up the server
+     */
+    int getWakeupDescriptor() const;
+
+    /**
+     * @brief Copy up to size bytes out of the ring.
+     * @return The number of bytes copied, or -1 if the indices in the shared memory are corrupt
+     */
+    int read(char *buf, unsigned int size);
+
+    /**
+     * @brief Announce that the server is about to sleep, so that the client wakes it up once it
+     *        writes more bytes.
+     * @return false if there are unread bytes, in which case the server should not sleep
+     */
+    bool prepareToSleep();
+
+    /**
+     * @brief Reset the event descriptor, and withdraw the announcement made by prepareToSleep()
+     */
+    void wakeUp();
+
+    SharedMemoryRing();
+    ~SharedMemoryRing();
+
+private:
+
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t capacity;
+        uint32_t writeIndex __attribute__((aligned(64)));
+        uint32_t readIndex __attribute__((aligned(64)));
+        uint32_t isServerSleeping;
+    };
+
+    Header *_header;
+    char *_data;
+    size_t _mappedSize;
+    unsigned int _capacity;
+
+    // The client can write anywhere in the shared memory, so the read index is kept here, and
+    // only copied out to the shared memory
+    uint32_t _readIndex;
+    bool _isSleeping;
+
+    int _memoryHandle;
+    int _wakeupHandle;
+};
+
+}
+
+#endif
@@ -10,21 +10,35 @@ using namespace oas;
 
 // Statics
 struct sockaddr_in      SocketHandler::_stSockAddr;
-int                     SocketHandler::_socketHandle;
+int                     SocketHandler::_socketHandle = -1;
+int                     SocketHandler::_epollHandle = -1;
+int                     SocketHandler::_wakeupHandle = -1;
 unsigned short          SocketHandler::_listeningPort;
+int                     SocketHandler::_datagramHandle = -1;
+unsigned short          SocketHandler::_datagramPort = 0;
+unsigned int            SocketHandler::_keySeed;
+int                     SocketHandler::_localSocketHandle = -1;
+std::string             SocketHandler::_localSocketPath;
 pthread_t               SocketHandler::_socketThread;
+#ifdef USE_CONDVAR_MESSAGE_QUEUE
 std::queue<Message*>    SocketHandler::_incomingMessages;
 pthread_mutex_t         SocketHandler::_inMutex;
 pthread_cond_t          SocketHandler::_inCondition;
-std::queue<char *>      SocketHandler::_outgoingResponses;
-pthread_mutex_t         SocketHandler::_outMutex;
-pthread_cond_t          SocketHandler::_outCondition;
+#else
+MessageRing             SocketHandler::_incomingRing;
+#endif
+SessionMap              SocketHandler::_sessions;
+pthread_mutex_t         SocketHandler::_sessionsMutex;
+unsigned int            SocketHandler::_nextSessionID = 1;
+unsigned int            SocketHandler::_numRingSessions = 0;
+Time                    SocketHandler::_lastRingActivity;
 bool                    SocketHandler::_isSocketOpen;
-bool                    SocketHandler::_isConnectedToClient = false;
+bool                    SocketHandler::_isTerminating = false;
 
 
 // static, public
-bool SocketHandler::initialize(long int listeningPort)
+bool SocketHandler::initialize(long int listeningPort, long int datagramPort,
+                               const std::string &localSocketPath)
 {
     // If already initialized, close the socket so that it can be re-opened
     if (SocketHandler::isSocketOpen())
@@ -38,9 +52,37 @@ bool SocketHandler::initialize(long int listeningPort)
     }
     SocketHandler::_listeningPort = listeningPort;
 
+    if (datagramPort && !_validatePortNumber(datagramPort))
+    {
+        return false;
+    }
+    SocketHandler::_datagramPort = datagramPort;
+    SocketHandler::_localSocketPath = localSocketPath;
+
+    // The keys only keep datagrams and transfer connections from being attributed to the wrong
+    // session by accident. They are not meant to stop an attacker that can see the traffic.
+    SocketHandler::_keySeed = time(NULL) ^ getpid();
+
     // Initialize mutexes
+    pthread_mutex_init(&SocketHandler::_sessionsMutex, NULL);
+
+    SocketHandler::_isTerminating = false;
+
+    // Responses can be queued up from other threads at any time, even while the socket is being
+    // re-opened, so the wakeup descriptor is created once and kept open
+    if (-1 == SocketHandler::_wakeupHandle)
+    {
+        SocketHandler::_wakeupHandle = eventfd(0, EFD_NONBLOCK);
+
+        if (-1 == SocketHandler::_wakeupHandle)
+        {
+            oas::Logger::error("SocketHandler - Failed to create wakeup event descriptor");
+            return false;
+        }
+    }
+
+#ifdef USE_CONDVAR_MESSAGE_QUEUE
     pthread_mutex_init(&SocketHandler::_inMutex, NULL);
-    pthread_mutex_init(&SocketHandler::_outMutex, NULL);
 
     // Initialize condition variables
     pthread_condattr_t inCondAttr;
@@ -49,8 +91,13 @@ bool SocketHandler::initialize(long int listeningPort)
     pthread_condattr_setclock(&inCondAttr, CLOCK_MONOTONIC);
 
     pthread_cond_init(&SocketHandler::_inCondition, &inCondAttr);
-    pthread_cond_init(&SocketHandler::_outCondition, NULL);
     pthread_condattr_destroy(&inCondAttr);
+#else
+    if (!SocketHandler::_incomingRing.initialize())
+    {
+        return false;
+    }
+#endif
 
     // Thread attribute variable
     pthread_attr_t threadAttr;
@@ -85,10 +132,45 @@ bool SocketHandler::initialize(long int listeningPort)
 // static, public
 void SocketHandler::terminate()
 {
-    // End the socket processing thread
-    pthread_cancel(SocketHandler::_socketThread);
-    // Close the socket and clean up the associated data
+    uint64_t one = 1;
+
+    // Stop the socket thread first. The server thread is still running, so the socket thread
+    // can't be stuck waiting for it to make room for incoming messages.
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    SocketHandler::_isTerminating = true;
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+    if (-1 == write(SocketHandler::_wakeupHandle, &one, sizeof(one)))
+    {
+        oas::Logger::error("SocketHandler - Failed to wake up the socket thread");
+    }
+
+    pthread_join(SocketHandler::_socketThread, NULL);
+
+    // Transfer workers may be using sessions that were lent to them
+    TransferHandler::terminate();
+
+    // Disconnect every client. The server thread is about to stop, so no QUIT messages are
+    // queued up to release the resources of the sessions.
+    SessionMap sessions;
+
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    sessions.swap(SocketHandler::_sessions);
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+    for (SessionMapIterator iterator = sessions.begin(); sessions.end() != iterator; ++iterator)
+    {
+        close(iterator->second->getConnection());
+        delete iterator->second;
+    }
+    SocketHandler::_numRingSessions = 0;
+
     SocketHandler::_closeSocket();
+
+    // With the socket thread gone, this thread is the only one that adds incoming messages
+    Message *shutdownMessage = SocketHandler::_reserveIncomingMessage();
+    *shutdownMessage = Message(Message::MT_SHUTDOWN);
+    SocketHandler::_addToIncomingMessages(shutdownMessage);
 }
 
 void SocketHandler::waitForSocketHandlerToTerminate()
@@ -99,7 +181,26 @@ void SocketHandler::waitForSocketHandlerToTerminate()
 // static, public
 bool SocketHandler::isConnectedToClient()
 {
-    return _isConnectedToClient;
+    bool retval = false;
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    for (SessionMapConstIterator iterator = SocketHandler::_sessions.begin();
+         SocketHandler::_sessions.end() != iterator && !retval;
+         ++iterator)
+    {
+        retval = !iterator->second->_isTransferConnection;
+    }
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+    return retval;
+}
+
+// static, public
+unsigned int SocketHandler::numberOfSessions()
+{
+    unsigned int retval = 0;
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    retval = SocketHandler::_sessions.size();
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+    return retval;
 }
 
 // static, private
@@ -112,8 +213,8 @@ bool SocketHandler::_openSocket()
     
     SocketHandler::_isSocketOpen = false;
 
-    // Create a new socket
-    SocketHandler::_socketHandle = socket(PF_INET, SOCK_STREAM, IPPROTO_TCP);
+    // Create a new socket. It is non-blocking, so that accepting connections never stalls the loop
+    SocketHandler::_socketHandle = socket(PF_INET, SOCK_STREAM | SOCK_NONBLOCK, IPPROTO_TCP);
 
     if (-1 == SocketHandler::_socketHandle)
     {
@@ -154,13 +255,50 @@ bool SocketHandler::_openSocket()
     }
     
     // Prepare socket for listening
-    if (-1 == listen(SocketHandler::_socketHandle, 1))
+    if (-1 == listen(SocketHandler::_socketHandle, SOMAXCONN))
     {
         oas::Logger::error("SocketHandler - Failed to listen on socket");
         close(SocketHandler::_socketHandle);
         return false;
     }
 
+    // Create the epoll instance that will multiplex the listening socket and all client sessions
+    SocketHandler::_epollHandle = epoll_create1(0);
+
+    if (-1 == SocketHandler::_epollHandle)
+    {
+        oas::Logger::error("SocketHandler - Failed to create epoll instance");
+        close(SocketHandler::_socketHandle);
+        return false;
+    }
+
+    if (!SocketHandler::_watchDescriptor(SocketHandler::_socketHandle, LISTENING_SOCKET_EVENT_ID,
+                                         EPOLLIN, EPOLL_CTL_ADD)
+        || !SocketHandler::_watchDescriptor(SocketHandler::_wakeupHandle, WAKEUP_EVENT_ID,
+                                            EPOLLIN, EPOLL_CTL_ADD)
+        || (-1 != TransferHandler::getReturnDescriptor()
+            && !SocketHandler::_watchDescriptor(TransferHandler::getReturnDescriptor(),
+                                                TRANSFER_RETURN_EVENT_ID, EPOLLIN, EPOLL_CTL_ADD)))
+    {
+        close(SocketHandler::_epollHandle);
+        close(SocketHandler::_socketHandle);
+        return false;
+    }
+
+    // The datagram channel is optional. Clients keep working over their connection without it.
+    if (SocketHandler::_datagramPort && !SocketHandler::_openDatagramSocket())
+    {
+        oas::Logger::warnf("SocketHandler - The datagram channel on port %d is not available.",
+                           SocketHandler::_datagramPort);
+    }
+
+    // Likewise for the Unix domain socket. Local clients can still connect over TCP.
+    if (!SocketHandler::_localSocketPath.empty() && !SocketHandler::_openLocalSocket())
+    {
+        oas::Logger::warnf("SocketHandler - The Unix domain socket \"%s\" is not available.",
+                           SocketHandler::_localSocketPath.c_str());
+    }
+
     SocketHandler::_isSocketOpen = true;
 
 
@@ -172,7 +310,7 @@ bool SocketHandler::_openSocket()
             && (NULL != (host = gethostbyname(buf)))
             && (NULL != inet_ntop(AF_INET, *host->h_addr_list, ipBuf, INET_ADDRSTRLEN)))
     {
-        oas::Logger::logf("Audio Server \"%s\" (%s) is waiting for client to connect on port %d...",
+        oas::Logger::logf("Audio Server \"%s\" (%s) is waiting for clients to connect on port %d...",
                           buf, ipBuf, SocketHandler::_listeningPort);
     }
     else
@@ -184,6 +322,90 @@ bool SocketHandler::_openSocket()
     return true;
 }
 
+// static, private
+bool SocketHandler::_openDatagramSocket()
+{
+    SocketHandler::_datagramHandle = socket(PF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+
+    if (-1 == SocketHandler::_datagramHandle)
+    {
+        oas::Logger::error("SocketHandler - Failed to create the datagram socket");
+        return false;
+    }
+
+    struct sockaddr_in datagramAddr;
+
+    memset(&datagramAddr, 0, sizeof(datagramAddr));
+    datagramAddr.sin_family = AF_INET;
+    datagramAddr.sin_port = htons(SocketHandler::_datagramPort);
+    datagramAddr.sin_addr.s_addr = htonl(INADDR_ANY);
+
+    if (-1 == bind(SocketHandler::_datagramHandle,
+                   (struct sockaddr *) &datagramAddr,
+                   sizeof(datagramAddr)))
+    {
+        oas::Logger::error("SocketHandler - Failed to bind the datagram socket to address");
+        close(SocketHandler::_datagramHandle);
+        SocketHandler::_datagramHandle = -1;
+        return false;
+    }
+
+    if (!SocketHandler::_watchDescriptor(SocketHandler::_datagramHandle, DATAGRAM_SOCKET_EVENT_ID,
+                                         EPOLLIN, EPOLL_CTL_ADD))
+    {
+        close(SocketHandler::_datagramHandle);
+        SocketHandler::_datagramHandle = -1;
+        return false;
+    }
+
+    oas::Logger::logf("SocketHandler - Accepting state updates over datagrams on port %d...",
+                      SocketHandler::_datagramPort);
+    return true;
+}
+
+// static, private
+bool SocketHandler::_openLocalSocket()
+{
+    struct sockaddr_un localAddr;
+
+    if (sizeof(localAddr.sun_path) <= SocketHandler::_localSocketPath.size())
+    {
+        oas::Logger::error("SocketHandler - The path of the Unix domain socket is too long");
+        return false;
+    }
+
+    SocketHandler::_localSocketHandle = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+
+    if (-1 == SocketHandler::_localSocketHandle)
+    {
+        oas::Logger::error("SocketHandler - Failed to create the Unix domain socket");
+        return false;
+    }
+
+    memset(&localAddr, 0, sizeof(localAddr));
+    localAddr.sun_family = AF_UNIX;
+    strcpy(localAddr.sun_path, SocketHandler::_localSocketPath.c_str());
+
+    // Remove the socket file left behind by a previous run of the server
+    unlink(SocketHandler::_localSocketPath.c_str());
+
+    if (-1 == bind(SocketHandler::_localSocketHandle, (struct sockaddr *) &localAddr, sizeof(localAddr))
+        || -1 == listen(SocketHandler::_localSocketHandle, SOMAXCONN)
+        || !SocketHandler::_watchDescriptor(SocketHandler::_localSocketHandle, LOCAL_SOCKET_EVENT_ID,
+                                            EPOLLIN, EPOLL_CTL_ADD))
+    {
+        oas::Logger::errorf("SocketHandler - Failed to listen on the Unix domain socket! %s",
+                            strerror(errno));
+        close(SocketHandler::_localSocketHandle);
+        SocketHandler::_localSocketHandle = -1;
+        return false;
+    }
+
+    oas::Logger::logf("SocketHandler - Local clients can connect to \"%s\"...",
+                      SocketHandler::_localSocketPath.c_str());
+    return true;
+}
+
 // static, private
 void SocketHandler::_closeSocket()
 {
@@ -192,11 +414,8 @@ void SocketHandler::_closeSocket()
         return;
     }
 
-    close(SocketHandler::_socketHandle);
-    SocketHandler::_isSocketOpen = false;
-
-    // Empty the incoming and outgoing queues
-
+#ifdef USE_CONDVAR_MESSAGE_QUEUE
+    // Empty the incoming queue
     pthread_mutex_lock(&SocketHandler::_inMutex);
     while (!SocketHandler::_incomingMessages.empty())
     {
@@ -204,60 +423,181 @@ void SocketHandler::_closeSocket()
         SocketHandler::_incomingMessages.pop();
     }
     pthread_mutex_unlock(&SocketHandler::_inMutex);
+#endif
+    // The lock-free ring can only be emptied by the server thread, which consumes it
+
+    // Disconnect every client. This queues up a QUIT message for each session. Sessions that are
+    // lent to a transfer worker are resumed once they are handed back, when the socket re-opens.
+    SessionMapIterator iterator = SocketHandler::_sessions.begin();
+
+    while (SocketHandler::_sessions.end() != iterator)
+    {
+        ClientSession *session = iterator->second;
+
+        ++iterator;
+        if (!session->_isReceivingFile)
+            SocketHandler::_closeConnection(session);
+    }
 
-    pthread_mutex_lock(&SocketHandler::_outMutex);
-    while (!SocketHandler::_outgoingResponses.empty())
+    if (-1 != SocketHandler::_datagramHandle)
+        close(SocketHandler::_datagramHandle);
+    if (-1 != SocketHandler::_localSocketHandle)
     {
-        delete SocketHandler::_outgoingResponses.front();
-        SocketHandler::_outgoingResponses.pop();
+        close(SocketHandler::_localSocketHandle);
+        unlink(SocketHandler::_localSocketPath.c_str());
     }
-    pthread_mutex_unlock(&SocketHandler::_outMutex);
+    close(SocketHandler::_epollHandle);
+    close(SocketHandler::_socketHandle);
+    SocketHandler::_datagramHandle = -1;
+    SocketHandler::_localSocketHandle = -1;
+    SocketHandler::_epollHandle = -1;
+    SocketHandler::_socketHandle = -1;
+    SocketHandler::_isSocketOpen = false;
 }
 
 // static, private
-int SocketHandler::_acceptNewConnection()
+bool SocketHandler::_watchDescriptor(int descriptor, unsigned int id, unsigned int events, int operation)
 {
-    if (!SocketHandler::isSocketOpen())
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u32 = id;
+
+    if (-1 == epoll_ctl(SocketHandler::_epollHandle, operation, descriptor, &event))
     {
-        return 0;
+        oas::Logger::error("SocketHandler - Failed to update the descriptors watched by epoll");
+        return false;
     }
 
-    struct sockaddr_in clientAddr;
-    socklen_t addrSize;
+    return true;
+}
+
+// static, private
+void SocketHandler::_updateSessionEvents(ClientSession *session)
+{
+    unsigned int events = 0;
+
+    // Stop reading from a client that is waiting on a response, so that its unparsed data is
+    // not overwritten. Data from other clients continues to be read in the meantime.
+    if (!session->_isAwaitingResponse)
+        events |= EPOLLIN;
 
-    addrSize = sizeof (clientAddr);
-    int connection = accept(SocketHandler::_socketHandle,
-                            (struct sockaddr *) &clientAddr,
-                            &addrSize);
+    // Wait for the socket to become writable if a response could not be written completely
+    if (!session->_pendingWrite.empty())
+        events |= EPOLLOUT;
 
-    if (0 > connection)
+    if (events != session->_watchedEvents
+        && SocketHandler::_watchDescriptor(session->getConnection(), session->getID(),
+                                           events, EPOLL_CTL_MOD))
     {
-        oas::Logger::error("SocketHandler - Could not accept new connection");
+        session->_watchedEvents = events;
     }
-    else
+}
+
+// static, private
+void SocketHandler::_acceptNewConnections(int listeningHandle, bool isLocal)
+{
+    if (!SocketHandler::isSocketOpen())
+    {
+        return;
+    }
+
+    // Accept every connection that is pending on the listening socket
+    while (1)
     {
+        struct sockaddr_storage clientAddr;
+        socklen_t addrSize;
+
+        addrSize = sizeof (clientAddr);
+        int connection = accept4(listeningHandle,
+                                 (struct sockaddr *) &clientAddr,
+                                 &addrSize,
+                                 SOCK_NONBLOCK);
+
+        if (0 > connection)
+        {
+            // No more pending connections
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+                break;
+            if (EINTR == errno)
+                continue;
+
+            oas::Logger::error("SocketHandler - Could not accept new connection");
+            break;
+        }
+
         char buf[INET_ADDRSTRLEN];
-        const char *addrPtr = inet_ntop(AF_INET,
-                                        &clientAddr.sin_addr,
-                                        buf,
-                                        INET_ADDRSTRLEN);
+        const char *addrPtr = "local";
+
+        if (!isLocal)
+        {
+            int one = 1;
+
+            // Responses are small, so send them out immediately
+            setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            addrPtr = inet_ntop(AF_INET,
+                                &((struct sockaddr_in *) &clientAddr)->sin_addr,
+                                buf,
+                                INET_ADDRSTRLEN);
+        }
+
+        ClientSession *session = new ClientSession(SocketHandler::_nextSessionID++,
+                                                   connection,
+                                                   addrPtr ? addrPtr : "(null)");
+        session->_isLocal = isLocal;
+
+        if (!SocketHandler::_watchDescriptor(connection, session->getID(), EPOLLIN, EPOLL_CTL_ADD))
+        {
+            close(connection);
+            delete session;
+            continue;
+        }
+        session->_watchedEvents = EPOLLIN;
 
-        oas::Logger::logf("A new client has connected from %s.",
-                          addrPtr ? addrPtr : "(null)");
+        pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+        SocketHandler::_sessions.insert(SessionPair(session->getID(), session));
+        pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+        oas::Logger::logf("A new client has connected from %s. (Session %u)",
+                          session->getAddress().c_str(), session->getID());
     }
-    return connection;
 }
 
 // static, private
-void SocketHandler::_closeConnection(const int connection)
+void SocketHandler::_closeConnection(ClientSession *session)
 {
-    oas::Logger::logf("SocketHandler - Closing connection with client.");
-    // Close the connection - causes client to disconnect
-    close(connection);
-    // Close the socket
-    SocketHandler::_closeSocket();
-    // Then finally add the QUIT message
-    SocketHandler::_addToIncomingMessages(new Message(Message::MT_QUIT));
+    unsigned int id = session->getID();
+
+    oas::Logger::logf("SocketHandler - Closing connection with client %s. (Session %u)",
+                      session->getAddress().c_str(), id);
+
+    // Stop watching the connection, and close it - causes client to disconnect
+    SocketHandler::_watchDescriptor(session->getConnection(), id, 0, EPOLL_CTL_DEL);
+    close(session->getConnection());
+
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    SocketHandler::_sessions.erase(id);
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+    bool isTransferConnection = session->_isTransferConnection;
+
+    // Closing the descriptors of the ring also stops epoll from watching them
+    if (session->_ring)
+        SocketHandler::_numRingSessions--;
+
+    delete session;
+
+    // Transfer connections never own any resources
+    if (isTransferConnection)
+        return;
+
+    // Then finally add the QUIT message, which releases the resources owned by this session
+    Message *quitMessage = SocketHandler::_reserveIncomingMessage();
+    *quitMessage = Message(Message::MT_QUIT);
+    quitMessage->setSessionID(id);
+    SocketHandler::_addToIncomingMessages(quitMessage);
 }
 
 // static, public
@@ -267,17 +607,30 @@ bool SocketHandler::isSocketOpen()
 }
 
 // static, private
-void* SocketHandler::_socketLoop(void* parameter)
+bool SocketHandler::_isShuttingDown()
 {
-    int connection;
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    bool isTerminating = SocketHandler::_isTerminating;
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
 
-    // Strategy:
-    // One outer infinite loop keeps the server listening for connections over time, allowing 
-    // multiple clients to connect and disconnect. The inner infinite loop reads data from the
-    // current active connection, parses the data into messages, and queues up the messages to 
-    // be read by another thread.
+    return isTerminating;
+}
 
-    while (1)
+// static, private
+void* SocketHandler::_socketLoop(void *)
+{
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    int numEvents;
+
+    // Strategy:
+    // One outer loop keeps the listening socket open over time, and re-opens it if an
+    // unrecoverable error occurs, until terminate() stops this thread. The inner loop waits on
+    // epoll for activity on the listening socket (new clients), on any client connection
+    // (incoming data), or on the wakeup descriptor (responses generated by the server thread, or
+    // terminate()). Each ready descriptor is serviced without blocking, so that a slow client
+    // never stalls the other clients.
+
+    while (!SocketHandler::_isShuttingDown())
     {
         // Open the socket
         if (!SocketHandler::_openSocket())
@@ -287,230 +640,1062 @@ void* SocketHandler::_socketLoop(void* parameter)
             continue; 
         }
 
-        // This thread will block until a client connects.
-        connection = SocketHandler::_acceptNewConnection();
-        
-        // If connection is an invalid socket descriptor, some error occured
-        if (0 > connection)
+        while (SocketHandler::isSocketOpen())
         {
-            // Close the socket and retry
-            SocketHandler::_closeSocket();
-            continue;
-        }
-
-        int amountRead, amountWritten;
-        int amountParsed = 0;
-        bool validConnection = true;
+            // This thread will block until there is activity on one of the descriptors, unless
+            // it is polling the shared memory rings
+            numEvents = epoll_wait(SocketHandler::_epollHandle, events, MAX_EPOLL_EVENTS,
+                                   SocketHandler::_pollRings());
 
-        // Use a circular buffer to read data
-        static char circularBuf[MAX_CIRCULAR_BUFFER_SIZE];
-        char *bufPtr = circularBuf;
-
-        _isConnectedToClient = true;
-
-        while (validConnection)
-        {
-            // If the circular buffer is out of space, reset it to the beginning
-            if ( ((bufPtr + MAX_TRANSMIT_BUFFER_SIZE) - circularBuf) >= MAX_CIRCULAR_BUFFER_SIZE)
+            if (-1 == numEvents)
             {
-                bufPtr = circularBuf;
-            }
+                if (EINTR == errno)
+                    continue;
 
-            // Zero out the section of the buffer we're reading into
-            bzero(bufPtr, MAX_TRANSMIT_BUFFER_SIZE);
-
-            // Read from the socket
-            amountRead = read(connection, bufPtr, MAX_TRANSMIT_BUFFER_SIZE);
-
-            // Error occured
-            if (-1 == amountRead)
-            {
-                oas::Logger::error("SocketHandler - Error occured while reading information");
-                SocketHandler::_closeConnection(connection);
+                oas::Logger::error("SocketHandler - Error occured while waiting for socket activity");
+                SocketHandler::_closeSocket();
                 break;
             }
 
-            // Client disconnected
-            if (0 == amountRead)
-    	    {
-                oas::Logger::logf("SocketHandler - Client disconnected.");
-                SocketHandler::_closeConnection(connection);
-                break;
-		    }
-        
-            /* IMPORTANT:   We don't know if bufPtr points to the beginning of an actual message.
-             *              We have to parse starting from the endpoint of the previous message
-             *              for a more robust implementation.
-             */
-
-            amountParsed = 0;
-
-            // Keep parsing the current input data until the amount parsed is equal to the amount read 
-            while (amountParsed < amountRead)
+            for (int i = 0; i < numEvents; i++)
             {
-                // Message needs to be parsed, starting from bufPtr
-                Message *newMessage = new Message();
-                Message::MessageError parseError;
+                unsigned int id = events[i].data.u32;
 
-                parseError = newMessage->parseString(bufPtr, amountRead, amountParsed);
+                // New clients are connecting
+                if (LISTENING_SOCKET_EVENT_ID == id)
+                {
+                    SocketHandler::_acceptNewConnections(SocketHandler::_socketHandle, false);
+                    continue;
+                }
 
+                if (LOCAL_SOCKET_EVENT_ID == id)
+                {
+                    SocketHandler::_acceptNewConnections(SocketHandler::_localSocketHandle, true);
+                    continue;
+                }
 
-                // check parseError to keep track as necessary
-                if (Message::MERROR_NONE != parseError)
+                // The server thread has generated responses
+                if (WAKEUP_EVENT_ID == id)
                 {
-                    // If the message is empty, we are done parsing this input
-                    if (Message::MERROR_EMPTY_MESSAGE == parseError)
-                    {
-                        delete newMessage;
-                        break;
-                    }
-                    // Else there was some parsing error 
-                    else
+                    uint64_t count;
+
+                    if (-1 == read(SocketHandler::_wakeupHandle, &count, sizeof(count))
+                        && EAGAIN != errno)
                     {
-                        oas::Logger::warnf("SocketHandler - Parsing failed for incoming message: \"%s\" "
-                                            "This message will be ignored.",  bufPtr);
-                        delete newMessage;
-                        break;
+                        oas::Logger::error("SocketHandler - Failed to read the wakeup event");
                     }
+
+                    // terminate() cleans up once this thread has stopped
+                    if (SocketHandler::_isShuttingDown())
+                        return NULL;
+
+                    SocketHandler::_flushOutgoingResponses();
+                    continue;
                 }
-                // Else, there was no error in parsing
-                else
+
+                // Transfer workers have received files sent over client connections
+                if (TRANSFER_RETURN_EVENT_ID == id)
                 {
-//                    oas::Logger::logf("SocketHandler - \"%s\"", newMessage->getOriginalString().c_str());
-                    // If the message is to quit
-                    if (Message::MT_QUIT == newMessage->getMessageType())
-                    {
-                        oas::Logger::logf("SocketHandler - Client disconnected.");
-                        delete newMessage;
-                        SocketHandler::_closeConnection(connection);
-                        validConnection = false;
-                        break;
-                    }
+                    SocketHandler::_resumeReturnedSessions();
+                    continue;
+                }
 
-                    // If a binary file is incoming, call _receiveBinaryFile(),
-                    // which will use FileHandler to append binary data to file
-                    else if (Message::MT_PTFI_FN_1I == newMessage->getMessageType())
-                    {
-                        SocketHandler::_receiveBinaryFile(connection, *newMessage);
-                    }
+                // State updates have arrived over the datagram channel
+                if (DATAGRAM_SOCKET_EVENT_ID == id)
+                {
+                    SocketHandler::_readDatagrams();
+                    continue;
+                }
 
-                    // Queue up the parsed message
-                    SocketHandler::_addToIncomingMessages(newMessage);
+                // Else, the event belongs to a client session. The sessions map is only modified
+                // by this thread, so it can be read here without locking. The session may have
+                // been closed by an earlier event, so it must be looked up every time.
+                SessionMapIterator iterator = SocketHandler::_sessions.find(id & ~RING_EVENT_ID_FLAG);
 
-                    // If the server needs to send a response back to the client for this message
-                    if (newMessage->needsResponse())
-                    {
-                        // The socket thread will block until the server has generated the response
-                        char *response = SocketHandler::_getNextOutgoingResponse();
-
-                        // write the response to the socket connection
-                        amountWritten = write(connection, response, strlen(response));
-                        if (-1 == amountWritten)
-                        {
-                            oas::Logger::errorf("SocketHandler - Error occurred writing a response to the client.");
-                        }
-                        // delete the response that was allocated
-                        delete[] response;
-                    }
+                if (SocketHandler::_sessions.end() == iterator)
+                    continue;
+
+                ClientSession *session = iterator->second;
+
+                // The connection may have been lent to a transfer worker by an earlier event
+                if (session->_isReceivingFile)
+                    continue;
+
+                // The client woke up this thread after writing to its ring. The ring is read
+                // by _pollRings(), before the next wait.
+                if (id & RING_EVENT_ID_FLAG)
+                {
+                    if (session->_ring)
+                        session->_ring->wakeUp();
+                    continue;
+                }
+
+                if (events[i].events & EPOLLOUT)
+                {
+                    if (!SocketHandler::_writeToSession(session))
+                        continue;
                 }
-            } // End message parsing loop
 
-        } // End connection loop. Client has disconnected, or an error occured.
-        _isConnectedToClient = false;
+                if (events[i].events & EPOLLIN)
+                {
+                    SocketHandler::_readFromSession(session);
+                }
+                else if (events[i].events & (EPOLLERR | EPOLLHUP))
+                {
+                    oas::Logger::logf("SocketHandler - Client disconnected.");
+                    SocketHandler::_closeConnection(session);
+                }
+            }
+        }
     }
 
-    close(SocketHandler::_socketHandle);
-    pthread_exit(NULL);
     return NULL;
 }
 
 // static, private
-void SocketHandler::_receiveBinaryFile(int connection, const Message& ptfi)
+void SocketHandler::_readFromSession(ClientSession *session)
 {
-    char *data, *dataPtr;
-	int fileSize, bytesLeft, bytesRead;
-    oas::FileHandler fileHandler;
-	bool errorOccured = false;
+    int amountRead;
 
-	fileSize = ptfi.getIntegerParam();
-	bytesLeft = fileSize;
-	data = new char[fileSize];
-	dataPtr = data;
+    // Messages from a client with a ring only come through the ring. The connection is still
+    // read, to find out when the client disconnects.
+    if (session->_ring)
+    {
+        char buf[MAX_TRANSMIT_BUFFER_SIZE];
 
-    oas::Logger::logf("> Receiving file \"%s\" (%d bytes) over socket.",
-                      ptfi.getFilename().c_str(),
-                      bytesLeft);
+        amountRead = read(session->getConnection(), buf, sizeof(buf));
 
-    long count = 0;
+        if (0 < amountRead)
+        {
+            oas::Logger::warnf("SocketHandler - Client %s wrote to its connection instead of its "
+                               "ring. The data will be ignored.", session->getAddress().c_str());
+            return;
+        }
+        if (-1 == amountRead && (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno))
+            return;
 
-	while (bytesLeft > 0)
-	{
-		bytesRead = read(connection, dataPtr, bytesLeft);
+        // The last messages may still be in the ring
+        if (!SocketHandler::_readFromRing(session))
+            return;
 
-		if (bytesRead == 0 || bytesRead == -1)
-		{
-			oas::Logger::errorf("SocketHandler - Error occured while receiving %s!",
-			                    ptfi.getFilename().c_str());
-			errorOccured = true;
-			break;
-		}
-		
-        bytesLeft -= bytesRead;
-        dataPtr += bytesRead;
+        oas::Logger::logf("SocketHandler - Client disconnected.");
+        SocketHandler::_closeConnection(session);
+        return;
+    }
 
-        count++;
+    unsigned int space = session->_prepareReceiveSpace();
 
-        if (!errorOccured && ((0 == (count % 50)) || 0 == bytesLeft))
-        {
-            float percentage = ((float) (fileSize - bytesLeft) / fileSize) * 100.0;
-            oas::Logger::logf("> File %s...%.2f%% complete.",
-                             ptfi.getFilename().c_str(), percentage);
-        }
-	}
+    // The buffer only fills up with unframed data if the client sends garbage. Drop it.
+    if (0 == space)
+    {
+        oas::Logger::warnf("SocketHandler - Receive buffer overflowed for client %s. "
+                           "The buffered data will be ignored.", session->getAddress().c_str());
+        session->_consume(session->_unconsumedBytes());
+        space = session->_prepareReceiveSpace();
+    }
 
-    // Write data to file
-    if (!errorOccured && !fileHandler.writeFile(ptfi.getFilename(), data, fileSize))
+    // Read from the socket, appending to whatever has not been consumed yet
+    amountRead = read(session->getConnection(), session->_receiveSpace(), space);
+
+    // Error occured
+    if (-1 == amountRead)
     {
-        oas::Logger::errorf("SocketHandler - Error occured while writing %s to disk.",
-                            ptfi.getFilename().c_str());
-        errorOccured = true;
+        // Nothing to read after all
+        if (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno)
+            return;
+
+        oas::Logger::error("SocketHandler - Error occured while reading information");
+        SocketHandler::_closeConnection(session);
+        return;
     }
 
-    if (!errorOccured)
-	{
-	    oas::Logger::logf("> File transmission complete.");
-	    oas::Logger::logf("> %s is %d bytes", ptfi.getFilename().c_str(), fileSize);
-	}
+    // Client disconnected
+    if (0 == amountRead)
+    {
+        oas::Logger::logf("SocketHandler - Client disconnected.");
+        SocketHandler::_closeConnection(session);
+        return;
+    }
 
-    delete[] data;
-}
+    session->_received(amountRead);
 
-// static, public
-unsigned int SocketHandler::numberOfIncomingMessages()
-{
-    unsigned retval = 0;
-    pthread_mutex_lock(&SocketHandler::_inMutex);
-    retval = _incomingMessages.size();
-    pthread_mutex_unlock(&SocketHandler::_inMutex);
-    return retval;
+    SocketHandler::_parseSessionBuffer(session);
 }
 
 // static, private
-void SocketHandler::_addToIncomingMessages(Message *message)
+bool SocketHandler::_parseSessionBuffer(ClientSession *session)
 {
-    // lock mutex
-    pthread_mutex_lock(&SocketHandler::_inMutex);
-    // push message into queue
-    SocketHandler::_incomingMessages.push(message);
-    // use condition variable to signal that queue is not empty
-    pthread_cond_signal(&SocketHandler::_inCondition);
-    // unlock mutex
-    pthread_mutex_unlock(&SocketHandler::_inMutex);
-}
+    // A batch is only started once all of it has been received, so it is always forwarded in
+    // one go, without messages from other clients in between. The batch ends once the number of
+    // unconsumed bytes drops to batchEndsAt.
+    bool isInBatch = false;
+    unsigned int batchEndsAt = 0;
+
+    // Keep parsing complete messages until the received data runs out, or until a message that
+    // needs a response is encountered. A message that is only partially received stays in the
+    // buffer until the rest of it arrives. Messages inside a batch are never held back.
+    while (isInBatch || !session->_isAwaitingResponse)
+    {
+        Message *newMessage;
+        Message::MessageError parseError;
+        unsigned int messageSize;
 
-// static, public
-void SocketHandler::populateQueueWithIncomingMessages(std::queue<Message*> &destination, const Time &timeout)
+        if (isInBatch && batchEndsAt >= session->_unconsumedBytes())
+        {
+            SocketHandler::_endBatch(session);
+            isInBatch = false;
+            continue;
+        }
+
+        if (session->_isBinaryProtocol)
+        {
+            unsigned int amountParsed;
+
+            // Don't take up a slot until there is at least a whole header
+            if (BINARY_HEADER_SIZE > session->_unconsumedBytes())
+                break;
+
+            newMessage = SocketHandler::_reserveIncomingMessage();
+            parseError = newMessage->parseBinary(session->_unconsumedData(),
+                                                 session->_unconsumedBytes(),
+                                                 amountParsed);
+
+            if (Message::MERROR_INCOMPLETE_MESSAGE == parseError)
+            {
+                SocketHandler::_discardIncomingMessage(newMessage);
+                break;
+            }
+            // The message would never fit in the receive buffer, and there is no way to find
+            // the start of the next message without reading it
+            else if (Message::MERROR_OVERSIZED_MESSAGE == parseError)
+            {
+                oas::Logger::warnf("SocketHandler - Incoming binary message \"%.4s\" is too large. "
+                                    "Closing the connection.", session->_unconsumedData());
+                SocketHandler::_discardIncomingMessage(newMessage);
+                if (isInBatch)
+                    SocketHandler::_endBatch(session);
+                SocketHandler::_closeConnection(session);
+                return false;
+            }
+            else if (Message::MERROR_NONE != parseError)
+            {
+                oas::Logger::warnf("SocketHandler - Parsing failed for incoming binary message \"%.4s\" "
+                                    "This message will be ignored.", session->_unconsumedData());
+                SocketHandler::_discardIncomingMessage(newMessage);
+                session->_consume(amountParsed);
+                continue;
+            }
+
+            messageSize = amountParsed;
+        }
+        else
+        {
+            char *frame;
+            unsigned int frameLength;
+
+            if (!session->_nextFrame(frame, frameLength))
+                break;
+
+            newMessage = SocketHandler::_reserveIncomingMessage();
+
+            char *parsePtr = frame;
+            int amountParsed = 0;
+
+            parseError = newMessage->parseString(parsePtr, frameLength, amountParsed);
+
+            // check parseError to keep track as necessary
+            if (Message::MERROR_NONE != parseError)
+            {
+                // If the message is not empty, there was some parsing error
+                if (Message::MERROR_EMPTY_MESSAGE != parseError)
+                {
+                    oas::Logger::warnf("SocketHandler - Parsing failed for incoming message: \"%.*s\" "
+                                        "This message will be ignored.", frameLength, frame);
+                }
+
+                // Either way, we are done with this frame and its terminator
+                SocketHandler::_discardIncomingMessage(newMessage);
+                session->_consume(frameLength + 1);
+                continue;
+            }
+
+            // A frame can hold several messages, so only consume the terminator once the whole
+            // frame has been parsed.
+            messageSize = (amountParsed < (int) frameLength) ? amountParsed : frameLength + 1;
+        }
+
+        // Else, there was no error in parsing
+        newMessage->setSessionID(session->getID());
+
+        // Start a batch only if all of it has been received. Otherwise, leave the message in the
+        // buffer, and look at it again once more data has arrived.
+        if (Message::MT_BTCH_1I == newMessage->getMessageType())
+        {
+            int batchSize = newMessage->getIntegerParam();
+            unsigned int bytesAfterMessage = session->_unconsumedBytes() - messageSize;
+            bool canStartBatch = !isInBatch && 0 < batchSize && MAX_BATCH_SIZE >= batchSize;
+
+            if (canStartBatch && bytesAfterMessage < (unsigned int) batchSize)
+            {
+                SocketHandler::_discardIncomingMessage(newMessage);
+                break;
+            }
+
+            session->_consume(messageSize);
+
+            if (!canStartBatch)
+            {
+                // The batch could never fit in the receive buffer, so apply its messages one by one
+                if (MAX_BATCH_SIZE < batchSize)
+                    oas::Logger::warnf("SocketHandler - Incoming batch of %d bytes is too large. "
+                                       "Its messages will not be applied together.", batchSize);
+
+                SocketHandler::_discardIncomingMessage(newMessage);
+                continue;
+            }
+
+            isInBatch = true;
+            batchEndsAt = bytesAfterMessage - batchSize;
+            SocketHandler::_addToIncomingMessages(newMessage);
+            continue;
+        }
+
+        session->_consume(messageSize);
+
+        // If the message is to quit
+        if (Message::MT_QUIT == newMessage->getMessageType())
+        {
+            oas::Logger::logf("SocketHandler - Client disconnected.");
+            SocketHandler::_discardIncomingMessage(newMessage);
+            if (isInBatch)
+                SocketHandler::_endBatch(session);
+            SocketHandler::_closeConnection(session);
+            return false;
+        }
+
+        // The protocol is a property of the connection, so the socket thread answers this
+        // itself. The response is always text, and every message after it uses the new protocol.
+        else if (Message::MT_PROT_1I == newMessage->getMessageType())
+        {
+            SocketHandler::_switchProtocol(session, *newMessage);
+            SocketHandler::_discardIncomingMessage(newMessage);
+            continue;
+        }
+
+        // Likewise, the datagram channel and transfer connections are set up by the socket thread
+        else if (Message::MT_DGRM == newMessage->getMessageType())
+        {
+            SocketHandler::_openDatagramChannel(session, *newMessage);
+            SocketHandler::_discardIncomingMessage(newMessage);
+            continue;
+        }
+        else if (Message::MT_XFER == newMessage->getMessageType())
+        {
+            SocketHandler::_openTransferChannel(session, *newMessage);
+            SocketHandler::_discardIncomingMessage(newMessage);
+            continue;
+        }
+        else if (Message::MT_SHMR == newMessage->getMessageType())
+        {
+            bool isOpen = SocketHandler::_openSharedMemoryChannel(session, *newMessage);
+
+            SocketHandler::_discardIncomingMessage(newMessage);
+            if (isOpen)
+                continue;
+
+            if (isInBatch)
+                SocketHandler::_endBatch(session);
+            SocketHandler::_closeConnection(session);
+            return false;
+        }
+        else if (Message::MT_ATCH_1I == newMessage->getMessageType())
+        {
+            bool isAttached = SocketHandler::_attachTransferConnection(session, *newMessage);
+
+            SocketHandler::_discardIncomingMessage(newMessage);
+            if (isAttached)
+                continue;
+
+            if (isInBatch)
+                SocketHandler::_endBatch(session);
+            SocketHandler::_closeConnection(session);
+            return false;
+        }
+
+        // If a binary file is incoming, call _receiveBinaryFile(),
+        // which will use FileHandler to append binary data to file
+        else if (Message::MT_PTFI_FN_1I == newMessage->getMessageType()
+                 || Message::MT_PTFC_FN_1I == newMessage->getMessageType())
+        {
+            // Files sent over a transfer connection are received by another thread, which
+            // takes over the connection
+            if (session->_isTransferConnection)
+            {
+                SocketHandler::_handOffTransfer(session, newMessage, isInBatch);
+                return false;
+            }
+
+            // The file would follow in the ring, where it can't be received from
+            if (session->_ring)
+            {
+                oas::Logger::warnf("SocketHandler - Client %s must send files over a transfer "
+                                   "connection. Closing the connection.", session->getAddress().c_str());
+                SocketHandler::_discardIncomingMessage(newMessage);
+                if (isInBatch)
+                    SocketHandler::_endBatch(session);
+                SocketHandler::_closeConnection(session);
+                return false;
+            }
+
+            // A worker receives the file, so that the other clients are not held up meanwhile
+            if (TransferHandler::isEnabled())
+            {
+                SocketHandler::_lendToTransferHandler(session, newMessage, isInBatch);
+                return false;
+            }
+
+            // Without workers, this thread would have to receive the file itself, which is only
+            // done while there are no other clients to hold up
+            if (1 < SocketHandler::_sessions.size())
+            {
+                oas::Logger::warnf("SocketHandler - Client %s can not send files while other clients "
+                                   "are connected. Closing the connection.", session->getAddress().c_str());
+                SocketHandler::_discardIncomingMessage(newMessage);
+                if (isInBatch)
+                    SocketHandler::_endBatch(session);
+                SocketHandler::_closeConnection(session);
+                return false;
+            }
+
+            // Only the socket thread receives files here, so it can keep one chunk buffer
+            static char fileChunk[FILE_CHUNK_SIZE];
+
+            TransferHandler::receiveFile(session, *newMessage, fileChunk);
+        }
+
+        // Transfer connections are only used for files
+        else if (session->_isTransferConnection)
+        {
+            oas::Logger::warnf("SocketHandler - Message type %d cannot be sent over a transfer "
+                               "connection. This message will be ignored.",
+                               newMessage->getMessageType());
+            SocketHandler::_discardIncomingMessage(newMessage);
+            continue;
+        }
+
+        // If the server needs to send a response back to the client for this message, hold off
+        // on parsing any more data from this client until the response has been written.
+        // Requests that carry a sequence number are pipelined instead: their responses are
+        // tagged, so the client can match them up no matter what else it has sent since.
+        if (newMessage->needsResponse() && !newMessage->hasSequenceNumber())
+        {
+            session->_isAwaitingResponse = true;
+        }
+
+        // Queue up the parsed message. The server thread owns it from this point on.
+        SocketHandler::_addToIncomingMessages(newMessage);
+    }
+
+    // The rest of the batch cannot be parsed, but the server is still waiting for its end
+    if (isInBatch)
+        SocketHandler::_endBatch(session);
+
+    SocketHandler::_updateSessionEvents(session);
+    return true;
+}
+
+// static, private
+void SocketHandler::_endBatch(ClientSession *session)
+{
+    Message *endMessage = SocketHandler::_reserveIncomingMessage();
+
+    *endMessage = Message(Message::MT_BTCH_END);
+    endMessage->setSessionID(session->getID());
+    SocketHandler::_addToIncomingMessages(endMessage);
+}
+
+// static, private
+void SocketHandler::_switchProtocol(ClientSession *session, const Message& prot)
+{
+    if (PROTOCOL_TEXT == prot.getIntegerParam() || PROTOCOL_BINARY == prot.getIntegerParam())
+    {
+        session->_isBinaryProtocol = (PROTOCOL_BINARY == prot.getIntegerParam());
+        oas::Logger::logf("SocketHandler - Client %s switched to the %s protocol.",
+                          session->getAddress().c_str(),
+                          session->_isBinaryProtocol ? "binary" : "text");
+    }
+    else
+    {
+        oas::Logger::warnf("SocketHandler - Client %s requested unknown protocol %d.",
+                           session->getAddress().c_str(), prot.getIntegerParam());
+    }
+
+    // Respond with the protocol in use, which tells the client whether the switch worked
+    SocketHandler::_respondFromSocketThread(session, prot,
+                                            session->_isBinaryProtocol ? "1" : "0");
+}
+
+// static, private
+void SocketHandler::_openDatagramChannel(ClientSession *session, const Message& dgrm)
+{
+    char response[MAX_TRANSMIT_BUFFER_SIZE];
+
+    if (-1 == SocketHandler::_datagramHandle)
+    {
+        SocketHandler::_respondFromSocketThread(session, dgrm, "-1");
+        return;
+    }
+
+    // Keep the key if the channel is opened again, so that datagrams already on their way
+    // are still accepted. A key of 0 means that the channel is not open.
+    if (0 == session->_datagramKey)
+        session->_datagramKey = SocketHandler::_generateKey();
+
+    // Respond with "<port> <session> <key>"
+    snprintf(response, sizeof(response), "%d %u %u",
+             SocketHandler::_datagramPort, session->getID(), session->_datagramKey);
+    SocketHandler::_respondFromSocketThread(session, dgrm, response);
+
+    oas::Logger::logf("SocketHandler - Client %s opened the datagram channel. (Session %u)",
+                      session->getAddress().c_str(), session->getID());
+}
+
+// static, private
+void SocketHandler::_respondFromSocketThread(ClientSession *session, const Message& request,
+                                             const char *response)
+{
+    char buf[MAX_TRANSMIT_BUFFER_SIZE];
+
+    if (request.hasSequenceNumber())
+        snprintf(buf, sizeof(buf), "@%u %s\n", request.getSequenceNumber(), response);
+    else
+        snprintf(buf, sizeof(buf), "%s\n", response);
+
+    // Written out by _updateSessionEvents(), once the socket is writable
+    session->_pendingWrite.append(buf);
+}
+
+// static, private
+void SocketHandler::_readDatagrams()
+{
+    unsigned char buf[MAX_DATAGRAM_SIZE];
+
+    // Read every datagram that is pending on the socket
+    while (1)
+    {
+        int amountRead = recv(SocketHandler::_datagramHandle, buf, sizeof(buf), MSG_TRUNC);
+
+        if (-1 == amountRead)
+        {
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+                break;
+            if (EINTR == errno)
+                continue;
+
+            oas::Logger::error("SocketHandler - Error occured while reading a datagram");
+            break;
+        }
+
+        // With MSG_TRUNC, the real size of the datagram is returned even if it did not fit
+        if ((unsigned int) amountRead > sizeof(buf))
+        {
+            oas::Logger::warnf("SocketHandler - Dropped a datagram of %d bytes, which is too large.",
+                               amountRead);
+            continue;
+        }
+
+        SocketHandler::_parseDatagram(buf, amountRead);
+    }
+}
+
+// static, private
+void SocketHandler::_parseDatagram(const unsigned char *data, unsigned int length)
+{
+    if (DATAGRAM_HEADER_SIZE > length)
+        return;
+
+    unsigned int id = readLittleEndian32(data);
+    unsigned int key = readLittleEndian32(data + 4);
+    unsigned int sequenceNumber = readLittleEndian32(data + 8);
+
+    SessionMapIterator iterator = SocketHandler::_sessions.find(id);
+
+    // Datagrams for sessions that have ended, or that don't have the right key, are dropped
+    if (SocketHandler::_sessions.end() == iterator
+        || 0 == iterator->second->_datagramKey
+        || key != iterator->second->_datagramKey)
+    {
+        return;
+    }
+
+    ClientSession *session = iterator->second;
+
+    // Drop datagrams that are older than, or duplicates of, one that has already been received.
+    // The signed difference keeps this working when the sequence number wraps around.
+    if (session->_hasReceivedDatagram
+        && 0 >= (int) (sequenceNumber - session->_lastDatagramSequence))
+    {
+        return;
+    }
+
+    session->_lastDatagramSequence = sequenceNumber;
+    session->_hasReceivedDatagram = true;
+
+    const unsigned char *pos = data + DATAGRAM_HEADER_SIZE;
+    unsigned int remaining = length - DATAGRAM_HEADER_SIZE;
+
+    while (BINARY_HEADER_SIZE <= remaining)
+    {
+        Message *newMessage = SocketHandler::_reserveIncomingMessage();
+        unsigned int amountParsed;
+
+        // A message that does not parse means that the rest of the datagram cannot be trusted
+        if (Message::MERROR_NONE != newMessage->parseBinary((const char *) pos, remaining, amountParsed))
+        {
+            oas::Logger::warnf("SocketHandler - Dropped a malformed datagram from client %s.",
+                               session->getAddress().c_str());
+            SocketHandler::_discardIncomingMessage(newMessage);
+            return;
+        }
+
+        pos += amountParsed;
+        remaining -= amountParsed;
+
+        switch (newMessage->getMessageType())
+        {
+            case Message::MT_SSPO_HL_3F:
+            case Message::MT_SSVE_HL_3F:
+            case Message::MT_SLPO_3F:
+            case Message::MT_SLOR_3F_3F:
+                if (!newMessage->hasSequenceNumber())
+                {
+                    newMessage->setSessionID(session->getID());
+                    SocketHandler::_addToIncomingMessages(newMessage);
+                    break;
+                }
+                // Else, fall through. Nothing can be sent back over the datagram channel.
+            default:
+                oas::Logger::warnf("SocketHandler - Message type %d cannot be sent over the "
+                                   "datagram channel. This message will be ignored.",
+                                   newMessage->getMessageType());
+                SocketHandler::_discardIncomingMessage(newMessage);
+                break;
+        }
+    }
+}
+
+// static, private
+void SocketHandler::_flushOutgoingResponses()
+{
+    SessionMapIterator iterator = SocketHandler::_sessions.begin();
+
+    while (SocketHandler::_sessions.end() != iterator)
+    {
+        ClientSession *session = iterator->second;
+        char *response;
+        bool isTagged;
+
+        // Advance first, because the session may be closed below
+        ++iterator;
+
+        // Responses to a client that is sending a file are written once it is handed back
+        if (session->_isReceivingFile)
+            continue;
+
+        while (NULL != (response = session->getNextOutgoingResponse(isTagged)))
+        {
+            session->_pendingWrite.append(response);
+            delete[] response;
+
+            // Tagged responses never held up parsing
+            if (!isTagged)
+                session->_isAwaitingResponse = false;
+        }
+
+        // Write out the responses, and then continue parsing any data that was held off
+        if (SocketHandler::_writeToSession(session)
+            && SocketHandler::_parseSessionBuffer(session)
+            && session->_ring)
+        {
+            SocketHandler::_readFromRing(session);
+        }
+    }
+}
+
+// static, private
+bool SocketHandler::_writeToSession(ClientSession *session)
+{
+    while (!session->_pendingWrite.empty())
+    {
+        int amountWritten = send(session->getConnection(),
+                                 session->_pendingWrite.data(),
+                                 session->_pendingWrite.size(),
+                                 MSG_NOSIGNAL);
+
+        if (-1 == amountWritten)
+        {
+            // The socket buffer is full. The rest will be written when epoll reports it writable
+            if (EAGAIN == errno || EWOULDBLOCK == errno)
+                break;
+            if (EINTR == errno)
+                continue;
+
+            oas::Logger::errorf("SocketHandler - Error occurred writing a response to the client.");
+            SocketHandler::_closeConnection(session);
+            return false;
+        }
+
+        session->_pendingWrite.erase(0, amountWritten);
+    }
+
+    SocketHandler::_updateSessionEvents(session);
+    return true;
+}
+
+// static, private
+void SocketHandler::_handOffTransfer(ClientSession *session, Message *ptfi, bool isInBatch)
+{
+    Message transferMessage = *ptfi;
+    unsigned int id = session->getID();
+
+    // The server thread is never told about files sent over transfer connections
+    SocketHandler::_discardIncomingMessage(ptfi);
+    if (isInBatch)
+        SocketHandler::_endBatch(session);
+
+    SocketHandler::_watchDescriptor(session->getConnection(), id, 0, EPOLL_CTL_DEL);
+
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    SocketHandler::_sessions.erase(id);
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+    TransferHandler::addTransfer(session, transferMessage);
+}
+
+// static, private
+void SocketHandler::_lendToTransferHandler(ClientSession *session, Message *ptfi, bool isInBatch)
+{
+    Message transferMessage = *ptfi;
+
+    // The server thread has nothing to do for the file, like for transfer connections
+    SocketHandler::_discardIncomingMessage(ptfi);
+    if (isInBatch)
+        SocketHandler::_endBatch(session);
+
+    // The session stays in the map, so that its handles stay valid and responses can still be
+    // queued up for it. Only its connection is left alone until the file has been received.
+    SocketHandler::_watchDescriptor(session->getConnection(), session->getID(), 0, EPOLL_CTL_DEL);
+    session->_watchedEvents = 0;
+    session->_isReceivingFile = true;
+
+    TransferHandler::lendSession(session, transferMessage);
+}
+
+// static, private
+void SocketHandler::_resumeReturnedSessions()
+{
+    uint64_t count;
+    ClientSession *session;
+
+    if (-1 == read(TransferHandler::getReturnDescriptor(), &count, sizeof(count))
+        && EAGAIN != errno)
+    {
+        oas::Logger::error("SocketHandler - Failed to read the transfer return event");
+    }
+
+    while (NULL != (session = TransferHandler::getReturnedSession()))
+    {
+        session->_isReceivingFile = false;
+
+        if (!SocketHandler::_watchDescriptor(session->getConnection(), session->getID(),
+                                             EPOLLIN, EPOLL_CTL_ADD))
+        {
+            SocketHandler::_closeConnection(session);
+            continue;
+        }
+        session->_watchedEvents = EPOLLIN;
+
+        // The messages that followed the file may have been read along with its end. Responses
+        // queued up by the server thread in the meantime are written by the flush below.
+        if (SocketHandler::_writeToSession(session))
+            SocketHandler::_parseSessionBuffer(session);
+    }
+
+    SocketHandler::_flushOutgoingResponses();
+}
+
+// static, private
+void SocketHandler::_openTransferChannel(ClientSession *session, const Message& xfer)
+{
+    char response[MAX_TRANSMIT_BUFFER_SIZE];
+
+    if (!TransferHandler::isEnabled() || session->_isTransferConnection)
+    {
+        SocketHandler::_respondFromSocketThread(session, xfer, "-1");
+        return;
+    }
+
+    // Keys are sent back as integers, so keep them positive
+    while (0 == session->_transferKey || INT_MAX < session->_transferKey)
+        session->_transferKey = SocketHandler::_generateKey();
+
+    snprintf(response, sizeof(response), "%u", session->_transferKey);
+    SocketHandler::_respondFromSocketThread(session, xfer, response);
+}
+
+// static, private
+bool SocketHandler::_attachTransferConnection(ClientSession *session, const Message& atch)
+{
+    ClientSession *owner = NULL;
+
+    if (0 < atch.getIntegerParam())
+    {
+        // Only this thread modifies the sessions map, so it can be read without locking
+        for (SessionMapConstIterator iterator = SocketHandler::_sessions.begin();
+             SocketHandler::_sessions.end() != iterator;
+             ++iterator)
+        {
+            if ((unsigned int) atch.getIntegerParam() == iterator->second->_transferKey)
+            {
+                owner = iterator->second;
+                break;
+            }
+        }
+    }
+
+    if (!owner || owner == session || !TransferHandler::isEnabled())
+    {
+        oas::Logger::warnf("SocketHandler - Client %s tried to attach a transfer connection with "
+                           "an unknown key. (Session %u)",
+                           session->getAddress().c_str(), session->getID());
+        return false;
+    }
+
+    // Read by isConnectedToClient(), from the server thread
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
+    session->_isTransferConnection = true;
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
+
+    oas::Logger::logf("SocketHandler - Client %s attached a transfer connection. (Session %u)",
+                      session->getAddress().c_str(), owner->getID());
+    return true;
+}
+
+// static, private
+unsigned int SocketHandler::_generateKey()
+{
+    unsigned int key = 0;
+
+    // A key of 0 means that no key has been given out
+    while (0 == key)
+    {
+        key = (rand_r(&SocketHandler::_keySeed) << 16) ^ rand_r(&SocketHandler::_keySeed);
+    }
+
+    return key;
+}
+
+// static, private
+bool SocketHandler::_openSharedMemoryChannel(ClientSession *session, const Message& shmr)
+{
+    // The descriptors of the ring can only be passed over a Unix domain socket. Files can't be
+    // sent through the ring, so they have to go over transfer connections instead.
+    if (!session->_isLocal || session->_ring || !TransferHandler::isEnabled())
+    {
+        SocketHandler::_respondFromSocketThread(session, shmr, "-1");
+        return true;
+    }
+
+    SharedMemoryRing *ring = new SharedMemoryRing();
+
+    // The descriptors are sent along with the response, which has to be written right away. It
+    // can't overtake responses to earlier requests that are still waiting to be written.
+    if (!session->_pendingWrite.empty()
+        || !ring->create(SHARED_MEMORY_RING_CAPACITY)
+        || !SocketHandler::_watchDescriptor(ring->getWakeupDescriptor(),
+                                            session->getID() | RING_EVENT_ID_FLAG,
+                                            EPOLLIN, EPOLL_CTL_ADD))
+    {
+        delete ring;
+        SocketHandler::_respondFromSocketThread(session, shmr, "-1");
+        return true;
+    }
+
+    // Respond with the capacity of the ring, and pass the shared memory and the event descriptor
+    // that wakes up this thread
+    char response[MAX_TRANSMIT_BUFFER_SIZE];
+    int descriptors[2] = {ring->getMemoryDescriptor(), ring->getWakeupDescriptor()};
+    char control[CMSG_SPACE(sizeof(descriptors))];
+    struct iovec data;
+    struct msghdr message;
+    struct cmsghdr *controlHeader;
+
+    if (shmr.hasSequenceNumber())
+        snprintf(response, sizeof(response), "@%u %d\n", shmr.getSequenceNumber(), SHARED_MEMORY_RING_CAPACITY);
+    else
+        snprintf(response, sizeof(response), "%d\n", SHARED_MEMORY_RING_CAPACITY);
+
+    data.iov_base = response;
+    data.iov_len = strlen(response);
+
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    controlHeader = CMSG_FIRSTHDR(&message);
+    controlHeader->cmsg_level = SOL_SOCKET;
+    controlHeader->cmsg_type = SCM_RIGHTS;
+    controlHeader->cmsg_len = CMSG_LEN(sizeof(descriptors));
+    memcpy(CMSG_DATA(controlHeader), descriptors, sizeof(descriptors));
+
+    if (-1 == sendmsg(session->getConnection(), &message, MSG_NOSIGNAL))
+    {
+        oas::Logger::errorf("SocketHandler - Failed to pass the shared memory ring to client %s. "
+                            "Closing the connection.", session->getAddress().c_str());
+        delete ring;
+        return false;
+    }
+
+    // The client has its own copy of the descriptor now
+    ring->closeMemoryDescriptor();
+
+    session->_ring = ring;
+    SocketHandler::_numRingSessions++;
+
+    oas::Logger::logf("SocketHandler - Client %s opened a shared memory ring. (Session %u)",
+                      session->getAddress().c_str(), session->getID());
+    return true;
+}
+
+// static, private
+bool SocketHandler::_readFromRing(ClientSession *session)
+{
+    // Like _readFromSession(), but as much is read as there is room for, since no system call is
+    // needed. Reading stops while the client waits on a response, like it does for connections.
+    while (!session->_isAwaitingResponse)
+    {
+        unsigned int space = session->_prepareReceiveSpace();
+
+        if (0 == space)
+        {
+            oas::Logger::warnf("SocketHandler - Receive buffer overflowed for client %s. "
+                               "The buffered data will be ignored.", session->getAddress().c_str());
+            session->_consume(session->_unconsumedBytes());
+            space = session->_prepareReceiveSpace();
+        }
+
+        int amountRead = session->_ring->read(session->_receiveSpace(), space);
+
+        if (-1 == amountRead)
+        {
+            oas::Logger::warnf("SocketHandler - The shared memory ring of client %s is corrupt. "
+                               "Closing the connection.", session->getAddress().c_str());
+            SocketHandler::_closeConnection(session);
+            return false;
+        }
+
+        if (0 == amountRead)
+            break;
+
+        SocketHandler::_lastRingActivity.update(Time::OAS_CLOCK_MONOTONIC);
+        session->_ring->wakeUp();
+        session->_received(amountRead);
+
+        if (!SocketHandler::_parseSessionBuffer(session))
+            return false;
+    }
+
+    return true;
+}
+
+// static, private
+int SocketHandler::_pollRings()
+{
+    if (0 == SocketHandler::_numRingSessions)
+        return -1;
+
+    SessionMapIterator iterator;
+    bool isReading = false;
+
+    for (iterator = SocketHandler::_sessions.begin(); SocketHandler::_sessions.end() != iterator; )
+    {
+        ClientSession *session = iterator->second;
+
+        // Advance first, because the session may be closed below
+        ++iterator;
+
+        if (session->_ring && SocketHandler::_readFromRing(session) && !session->_isAwaitingResponse)
+            isReading = true;
+    }
+
+    // Keep polling for a while after the last data, since clients tend to write in bursts. There
+    // is no point while every client is waiting on a response, which wakes up this thread anyway.
+    Time now;
+    now.update(Time::OAS_CLOCK_MONOTONIC);
+
+    if (isReading && SocketHandler::_lastRingActivity + Time(0, RING_POLL_DURATION_USEC * 1000) > now)
+        return 0;
+
+    // Else, tell the clients that this thread is going to sleep. If one of them wrote to its ring
+    // in the meantime, read it on the next pass instead. Sessions that are waiting on a response
+    // are not read from anyway.
+    int timeout = -1;
+
+    for (iterator = SocketHandler::_sessions.begin(); SocketHandler::_sessions.end() != iterator; ++iterator)
+    {
+        ClientSession *session = iterator->second;
+
+        if (session->_ring && !session->_ring->prepareToSleep() && !session->_isAwaitingResponse)
+            timeout = 0;
+    }
+
+    return timeout;
+}
+
+#ifdef USE_CONDVAR_MESSAGE_QUEUE
+
+// static, public
+unsigned int SocketHandler::numberOfIncomingMessages()
+{
+    unsigned retval = 0;
+    pthread_mutex_lock(&SocketHandler::_inMutex);
+    retval = _incomingMessages.size();
+    pthread_mutex_unlock(&SocketHandler::_inMutex);
+    return retval;
+}
+
+// static, private
+Message* SocketHandler::_reserveIncomingMessage()
+{
+    return new Message();
+}
+
+// static, private
+void SocketHandler::_discardIncomingMessage(Message *message)
+{
+    delete message;
+}
+
+// static, private
+void SocketHandler::_addToIncomingMessages(Message *message)
 {
+    // lock mutex
+    pthread_mutex_lock(&SocketHandler::_inMutex);
+    // push message into queue
+    SocketHandler::_incomingMessages.push(message);
+    // use condition variable to signal that queue is not empty
+    pthread_cond_signal(&SocketHandler::_inCondition);
+    // unlock mutex
+    pthread_mutex_unlock(&SocketHandler::_inMutex);
+}
+
+// static, public
+bool SocketHandler::waitForIncomingMessages(const Time &timeout)
+{
+    bool retval = true;
+
     // lock mutex
     pthread_mutex_lock(&SocketHandler::_inMutex);
 
@@ -524,83 +1709,169 @@ void SocketHandler::populateQueueWithIncomingMessages(std::queue<Message*> &dest
         // If some error occured (or the wait timed out)
         if (0 != error)
         {
-            // Unlock and return
-            pthread_mutex_unlock(&SocketHandler::_inMutex);
-            return;
+            retval = !SocketHandler::_incomingMessages.empty();
+            break;
         }
     }
 
-    // At this point, we know that the incoming messages queue is not empty.
-    // So, we empty out the incoming queue, adding each message to the destination queue
-    while (!SocketHandler::_incomingMessages.empty())
+    // unlock mutex
+    pthread_mutex_unlock(&SocketHandler::_inMutex);
+    return retval;
+}
+
+// static, public
+Message* SocketHandler::getNextIncomingMessage()
+{
+    Message *retval = NULL;
+
+    pthread_mutex_lock(&SocketHandler::_inMutex);
+    if (!SocketHandler::_incomingMessages.empty())
     {
-        // retrieve data after we're done waiting
-        Message* nextMessage = SocketHandler::_incomingMessages.front();
+        retval = SocketHandler::_incomingMessages.front();
         SocketHandler::_incomingMessages.pop();
-        destination.push(nextMessage);
     }
-
-    // unlock mutex
     pthread_mutex_unlock(&SocketHandler::_inMutex);
+
+    return retval;
 }
 
 // static, public
-void SocketHandler::addOutgoingResponse(const char *response)
+void SocketHandler::releaseIncomingMessage(Message *message)
 {
-    // If null or empty string, do nothing
-    if (!response || !*response)
+    delete message;
+}
+
+#else
+
+// static, public
+unsigned int SocketHandler::numberOfIncomingMessages()
+{
+    return SocketHandler::_incomingRing.size();
+}
+
+// static, private
+Message* SocketHandler::_reserveIncomingMessage()
+{
+    Message *retval;
+
+    // If the server thread has fallen behind and the ring is full, stop reading from clients
+    // until it catches up
+    while (NULL == (retval = SocketHandler::_incomingRing.reserve()))
     {
-        return;
+        Time timeout;
+        timeout.update(Time::OAS_CLOCK_MONOTONIC);
+        timeout += Time(INCOMING_MESSAGES_FULL_TIMEOUT_SEC, 0);
+
+        if (!SocketHandler::_incomingRing.waitForSpace(timeout))
+        {
+            oas::Logger::warnf("SocketHandler - Waiting for the server to process %u queued messages...",
+                               SocketHandler::_incomingRing.size());
+        }
     }
 
-    // create a copy of the response to put into the queue
-    char *newString = new char[strlen(response) + 1];
-    strcpy(newString, response);
+    return retval;
+}
 
-    // lock mutex 
-    pthread_mutex_lock(&SocketHandler::_outMutex);
+// static, private
+void SocketHandler::_discardIncomingMessage(Message *)
+{
+    // The slot was never pushed, so it is simply reused by the next reservation
+}
 
-    // add our copy of the response to the queue
-    SocketHandler::_outgoingResponses.push(newString);
+// static, private
+void SocketHandler::_addToIncomingMessages(Message *)
+{
+    // The message was written in place, in the slot returned by _reserveIncomingMessage()
+    SocketHandler::_incomingRing.push();
+}
 
-    // use condition variable to signal that the queue is not empty
-    pthread_cond_signal(&SocketHandler::_outCondition);
-    // unlock mutex
-    pthread_mutex_unlock(&SocketHandler::_outMutex);
+// static, public
+bool SocketHandler::waitForIncomingMessages(const Time &timeout)
+{
+    return SocketHandler::_incomingRing.waitForMessages(timeout);
+}
+
+// static, public
+Message* SocketHandler::getNextIncomingMessage()
+{
+    return SocketHandler::_incomingRing.front();
 }
 
 // static, public
-void SocketHandler::addOutgoingResponse(const long response)
+void SocketHandler::releaseIncomingMessage(Message *)
+{
+    SocketHandler::_incomingRing.pop();
+}
+
+#endif
+
+// static, public
+void SocketHandler::addOutgoingResponse(const Message &request, const char *response)
+{
+    // If null or empty string, do nothing
+    if (!response || !*response)
+    {
+        return;
+    }
+
+    if (request.hasSequenceNumber())
+    {
+        char buf[MAX_TRANSMIT_BUFFER_SIZE];
+        snprintf(buf, MAX_TRANSMIT_BUFFER_SIZE, "@%u %s\n", request.getSequenceNumber(), response);
+        SocketHandler::_queueOutgoingResponse(request.getSessionID(), buf, true);
+    }
+    else
+    {
+        SocketHandler::_queueOutgoingResponse(request.getSessionID(), response, false);
+    }
+}
+
+// static, public
+void SocketHandler::addOutgoingResponse(const Message &request, const long response)
 {
     // wrap the response into a character buffer
     char buf[MAX_TRANSMIT_BUFFER_SIZE];
-    sprintf(buf, "%ld\n", response);
-    SocketHandler::addOutgoingResponse(buf);
+
+    if (request.hasSequenceNumber())
+    {
+        sprintf(buf, "@%u %ld\n", request.getSequenceNumber(), response);
+        SocketHandler::_queueOutgoingResponse(request.getSessionID(), buf, true);
+    }
+    else
+    {
+        sprintf(buf, "%ld\n", response);
+        SocketHandler::_queueOutgoingResponse(request.getSessionID(), buf, false);
+    }
 }
 
 // static, private
-char* SocketHandler::_getNextOutgoingResponse()
+void SocketHandler::_queueOutgoingResponse(unsigned int session, const char *response, bool isTagged)
 {
-    char *retval = NULL;
+    bool isQueued = false;
 
-    // lock mutex
-    pthread_mutex_lock(&SocketHandler::_outMutex);
+    pthread_mutex_lock(&SocketHandler::_sessionsMutex);
 
-    // while the outgoing response queue is empty
-    while (SocketHandler::_outgoingResponses.empty())
+    // The client may have disconnected since its message was received
+    SessionMapIterator iterator = SocketHandler::_sessions.find(session);
+
+    if (SocketHandler::_sessions.end() != iterator)
     {
-        // wait (block) on the condition variable for queue to have content
-        pthread_cond_wait(&SocketHandler::_outCondition, &SocketHandler::_outMutex);
+        iterator->second->addOutgoingResponse(response, isTagged);
+        isQueued = true;
     }
 
-    // retrieve data after we're done waiting
-    retval = SocketHandler::_outgoingResponses.front();
-    SocketHandler::_outgoingResponses.pop();
+    pthread_mutex_unlock(&SocketHandler::_sessionsMutex);
 
-    // unlock mutex
-    pthread_mutex_unlock(&SocketHandler::_outMutex);
+    // Wake up the socket thread, so that it writes the response to the client
+    if (isQueued)
+    {
+        uint64_t one = 1;
 
-    return retval;
+        if (-1 == write(SocketHandler::_wakeupHandle, &one, sizeof(one)))
+        {
+            oas::Logger::error("SocketHandler - Failed to wake up the socket thread");
+        }
+    }
 }
 
 // static, private
@@ -9,12 +9,22 @@
 #include <iostream>
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <sys/param.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <fcntl.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <arpa/inet.h>
 #include <netdb.h>
 #include <cstring>
+#include <string>
 #include <queue>
+#include <map>
+#include <climits>
+#include <stdint.h>
 #include <pthread.h>
 #include <AL/alut.h>
 #include <cerrno>
@@ -22,60 +32,195 @@
 #include <unistd.h>
 #include <OASTime.h>
 
+#include "config.h"
 #include "OASFileHandler.h"
+#include "OASContentIndex.h"
 #include "OASMessage.h"
+#include "OASMessageRing.h"
+#include "OASClientSession.h"
+#include "OASTransferHandler.h"
 #include "OASLogger.h"
 
 
 namespace oas
 {
 
-#define MAX_TRANSMIT_BUFFER_SIZE 	MAX_MESSAGE_SIZE
-#define MAX_CIRCULAR_BUFFER_SIZE 	(MAX_TRANSMIT_BUFFER_SIZE * 4)
 #define MAX_BINARY_READ_SIZE 		MAX_TRANSMIT_BUFFER_SIZE
+#define MAX_EPOLL_EVENTS            64
+
+// How long the socket thread waits for the server thread to free up space for incoming messages,
+// before it logs a warning and waits again
+#define INCOMING_MESSAGES_FULL_TIMEOUT_SEC  1
+
+// Identifiers stored in the epoll event data for the descriptors that are not client sessions
+#define LISTENING_SOCKET_EVENT_ID   0
+#define WAKEUP_EVENT_ID             UINT_MAX
+#define DATAGRAM_SOCKET_EVENT_ID    (UINT_MAX - 1)
+#define LOCAL_SOCKET_EVENT_ID       (UINT_MAX - 2)
+#define TRANSFER_RETURN_EVENT_ID    (UINT_MAX - 3)
+
+// The event descriptor of a session's shared memory ring is identified by the session's
+// identifier, with this bit set
+#define RING_EVENT_ID_FLAG          0x80000000
+
+// How long the socket thread keeps polling the shared memory rings after it last found data in
+// them, before it goes to sleep. Clients don't have to wake up the server while it polls.
+#define RING_POLL_DURATION_USEC     1000
+
+/* Datagram channel. Each datagram starts with a header, followed by any number of messages in the
+ * binary protocol. Only state updates where the newest value is all that matters may be sent this
+ * way: SSPO, SSVE (3 values), SLPO and SLOR.
+ *  Header:
+ *      uint32      session, as given in the response to DGRM
+ *      uint32      key, as given in the response to DGRM
+ *      uint32      sequence number. Datagrams that are not newer than the newest one received
+ *                  so far are dropped.
+ */
+#define DATAGRAM_HEADER_SIZE        12
+#define MAX_DATAGRAM_SIZE           2048
+
+// Session types
+typedef std::map<unsigned int, ClientSession*>      SessionMap;
+typedef SessionMap::iterator                        SessionMapIterator;
+typedef SessionMap::const_iterator                  SessionMapConstIterator;
+typedef std::pair<unsigned int, ClientSession*>     SessionPair;
 
 /**
- * Manages socket traffic
+ * Manages socket traffic. A single thread multiplexes the listening socket and every connected
+ * client with epoll, so that any number of clients can be served concurrently. Each client
+ * connection is represented by a ClientSession, and all messages are tagged with the identifier
+ * of the session they arrived on.
+ *
+ * Parsed messages are handed to the server thread through a lock-free ring of pre-allocated
+ * messages. If USE_CONDVAR_MESSAGE_QUEUE is defined, a mutex and condition variable guarded
+ * queue of heap allocated messages is used instead.
  */
 class SocketHandler
 {
     public:
-        static bool initialize(long int listeningPort);
+        /**
+         * @brief Start the socket thread.
+         * @param listeningPort Port for client connections
+         * @param datagramPort Port for the datagram channel, or 0 to disable it
+         * @param localSocketPath Path of a Unix domain socket for clients on the same machine,
+         *                        or an empty string to disable it
+         */
+        static bool initialize(long int listeningPort, long int datagramPort = 0,
+                               const std::string &localSocketPath = "");
+
+        /**
+         * @brief Stop the socket thread and the transfer workers, and disconnect every client.
+         *        No QUIT messages are queued up for the sessions. Instead, a SHUTDOWN message is
+         *        queued up last, after which the server thread must stop. The server thread must
+         *        keep running until it gets there.
+         */
         static void terminate();
         static void waitForSocketHandlerToTerminate();
         static bool isSocketOpen();
+
+        /**
+         * @brief Check whether any client is connected. Connections that were attached to a
+         *        client to send files over don't count.
+         */
         static bool isConnectedToClient();
+        static unsigned int numberOfSessions();
         static unsigned int numberOfIncomingMessages();
-        static void populateQueueWithIncomingMessages(std::queue<Message*> &destination, const Time &timeout);
-        static void addOutgoingResponse(const char *response);
-        static void addOutgoingResponse(const long response);
+
+        /**
+         * @brief Block until there are incoming messages, or until the timeout.
+         *        Only to be called from the server thread.
+         * @return true if there are incoming messages
+         */
+        static bool waitForIncomingMessages(const Time &timeout);
+
+        /**
+         * @brief Get the oldest incoming message without blocking, or NULL if there are none.
+         *        The message must be handed back with releaseIncomingMessage() once it has been
+         *        processed, before the next one is retrieved. Only to be called from the server
+         *        thread.
+         */
+        static Message* getNextIncomingMessage();
+        static void releaseIncomingMessage(Message *message);
+
+        /**
+         * @brief Queue up the response to a request, to be written to the client that sent it.
+         *        If the request carried a sequence number, the response is tagged with it, as
+         *        "@<sequence number> <response>" followed by a newline.
+         *        Safe to call from any thread.
+         */
+        static void addOutgoingResponse(const Message &request, const char *response);
+        static void addOutgoingResponse(const Message &request, const long response);
         static pthread_t getSocketThread();
 
     protected:
         static struct sockaddr_in _stSockAddr;
         static int _socketHandle;
+        static int _epollHandle;
+        static int _wakeupHandle;
         static unsigned short _listeningPort;
+        static int _datagramHandle;
+        static unsigned short _datagramPort;
+        static unsigned int _keySeed;
+        static int _localSocketHandle;
+        static std::string _localSocketPath;
         static pthread_t _socketThread;
 
+#ifdef USE_CONDVAR_MESSAGE_QUEUE
         static std::queue<Message*> _incomingMessages;
         static pthread_mutex_t _inMutex;
         static pthread_cond_t _inCondition;
-        static std::queue<char *> _outgoingResponses;
-        static pthread_mutex_t _outMutex;
-        static pthread_cond_t _outCondition;
+#else
+        static MessageRing _incomingRing;
+#endif
+
+        static SessionMap _sessions;
+        static pthread_mutex_t _sessionsMutex;
+        static unsigned int _nextSessionID;
+
+        // Number of sessions that have a shared memory ring, and when data was last read from one
+        static unsigned int _numRingSessions;
+        static Time _lastRingActivity;
 
         static bool _isSocketOpen;
-        static bool _isConnectedToClient;
+
+        // Set by terminate(), to stop the socket thread. Guarded by the sessions mutex.
+        static bool _isTerminating;
 
     private:
         static bool _openSocket();
+        static bool _openDatagramSocket();
+        static bool _openLocalSocket();
         static void _closeSocket();
-        static int _acceptNewConnection();
-        static void _closeConnection(const int connection);
+        static bool _isShuttingDown();
+        static bool _watchDescriptor(int descriptor, unsigned int id, unsigned int events, int operation);
+        static void _updateSessionEvents(ClientSession *session);
+        static void _acceptNewConnections(int listeningHandle, bool isLocal);
+        static void _closeConnection(ClientSession *session);
         static void* _socketLoop(void* parameter);
-        static void  _receiveBinaryFile(int connection, const Message& ptfi);
+        static void  _readFromSession(ClientSession *session);
+        static bool  _parseSessionBuffer(ClientSession *session);
+        static void  _flushOutgoingResponses();
+        static bool  _writeToSession(ClientSession *session);
+        static void  _handOffTransfer(ClientSession *session, Message *ptfi, bool isInBatch);
+        static void  _lendToTransferHandler(ClientSession *session, Message *ptfi, bool isInBatch);
+        static void  _resumeReturnedSessions();
+        static void  _switchProtocol(ClientSession *session, const Message& prot);
+        static void  _openDatagramChannel(ClientSession *session, const Message& dgrm);
+        static void  _openTransferChannel(ClientSession *session, const Message& xfer);
+        static bool  _attachTransferConnection(ClientSession *session, const Message& atch);
+        static bool  _openSharedMemoryChannel(ClientSession *session, const Message& shmr);
+        static bool  _readFromRing(ClientSession *session);
+        static int   _pollRings();
+        static unsigned int _generateKey();
+        static void  _respondFromSocketThread(ClientSession *session, const Message& request,
+                                              const char *response);
+        static void  _readDatagrams();
+        static void  _parseDatagram(const unsigned char *data, unsigned int length);
+        static void  _endBatch(ClientSession *session);
+        static Message* _reserveIncomingMessage();
+        static void  _discardIncomingMessage(Message *message);
         static void  _addToIncomingMessages(Message *message);
-        static char* _getNextOutgoingResponse();
+        static void  _queueOutgoingResponse(unsigned int session, const char *response, bool isTagged);
         static bool _validatePortNumber(long int portNum);
         SocketHandler();
         ~SocketHandler();
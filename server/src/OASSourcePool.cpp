@@ -0,0 +1,138 @@
+/**
+ * @file OASSourcePool.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASSourcePool.h"
+
+using namespace oas;
+
+// Statics
+std::vector<ALuint>     SourcePool::_sources;
+std::vector<ALuint>     SourcePool::_freeSources;
+unsigned int            SourcePool::_highWaterMark = 0;
+unsigned long           SourcePool::_exhaustedCount = 0;
+
+// static, public
+bool SourcePool::initialize(ALCdevice *device)
+{
+    ALCint monoSources = 0, stereoSources = 0;
+
+    release();
+
+    if (device)
+    {
+        alcGetIntegerv(device, ALC_MONO_SOURCES, 1, &monoSources);
+        alcGetIntegerv(device, ALC_STEREO_SOURCES, 1, &stereoSources);
+    }
+
+    int size = monoSources + stereoSources;
+
+    if (0 >= size)
+        size = SOURCE_POOL_DEFAULT_SIZE;
+    else if (SOURCE_POOL_MAX_SIZE < size)
+        size = SOURCE_POOL_MAX_SIZE;
+
+    // Some devices can not deliver as many sources as they report, so stop at the first failure
+    alGetError();
+
+    for (int i = 0; i < size; i++)
+    {
+        ALuint source;
+
+        alGenSources(1, &source);
+
+        if (AL_NO_ERROR != alGetError())
+            break;
+
+        _sources.push_back(source);
+    }
+
+    // Sources are taken from the back, so the first ones generated are used first
+    _freeSources.assign(_sources.rbegin(), _sources.rend());
+    _highWaterMark = 0;
+    _exhaustedCount = 0;
+
+    if (_sources.empty())
+    {
+        oas::Logger::errorf("SourcePool - Could not generate any sound sources!");
+        return false;
+    }
+
+    oas::Logger::logf("SourcePool - Generated %u sound sources. The device reports %d mono and "
+                      "%d stereo sources.",
+                      (unsigned int) _sources.size(), monoSources, stereoSources);
+    return true;
+}
+
+// static, public
+void SourcePool::release()
+{
+    if (!_sources.empty())
+        alDeleteSources(_sources.size(), &_sources[0]);
+
+    _sources.clear();
+    _freeSources.clear();
+}
+
+// static, public
+bool SourcePool::acquire(ALuint &source)
+{
+    // Not worth a warning, because sound sources simply play without a voice until one is free
+    if (_freeSources.empty())
+    {
+        _exhaustedCount++;
+        return false;
+    }
+
+    source = _freeSources.back();
+    _freeSources.pop_back();
+
+    if (getNumberInUse() > _highWaterMark)
+        _highWaterMark = getNumberInUse();
+
+    return true;
+}
+
+// static, public
+void SourcePool::recycle(ALuint source)
+{
+    _reset(source);
+    _freeSources.push_back(source);
+}
+
+// static, public
+unsigned int SourcePool::getSize()
+{
+    return _sources.size();
+}
+
+// static, public
+unsigned int SourcePool::getNumberInUse()
+{
+    return _sources.size() - _freeSources.size();
+}
+
+// static, public
+unsigned int SourcePool::getHighWaterMark()
+{
+    return _highWaterMark;
+}
+
+// static, public
+unsigned long SourcePool::getExhaustedCount()
+{
+    return _exhaustedCount;
+}
+
+// static, private
+void SourcePool::_reset(ALuint source)
+{
+    // Rewinding stops the source and puts it back into the initial state, so that the buffer can
+    // be detached
+    alSourceRewind(source);
+    alSourcei(source, AL_BUFFER, AL_NONE);
+
+    alGetError();
+}
@@ -0,0 +1,90 @@
+/**
+ * @file    OASSourcePool.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_SOURCE_POOL_H_
+#define _OAS_SOURCE_POOL_H_
+
+#include <vector>
+#include <AL/alut.h>
+
+#include "OASLogger.h"
+
+namespace oas
+{
+
+// Size of the pool if the device does not report how many sources it can play
+#define SOURCE_POOL_DEFAULT_SIZE    256
+
+// Largest pool that is created, no matter how many sources the device reports
+#define SOURCE_POOL_MAX_SIZE        4096
+
+/**
+ * Keeps the OpenAL sources that sound sources play through. All of them are generated once, when
+ * the audio device is opened, as many as the device can mix at the same time. A sound source
+ * takes one from the pool as its voice when it is played, and gives it back when it stops or a
+ * more audible source needs it, so that OpenAL sources are never generated or deleted on the way.
+ *
+ * Sources must be handed back with their properties restored to the defaults of OpenAL. The
+ * pool only stops them and detaches their buffer.
+ */
+class SourcePool
+{
+public:
+
+    /**
+     * @brief Generate the OpenAL sources for the current context
+     * @return false if not a single source could be generated
+     */
+    static bool initialize(ALCdevice *device);
+
+    /**
+     * @brief Delete every OpenAL source of the pool. Must be called before the context is
+     *        destroyed, once all sound sources have been deleted.
+     */
+    static void release();
+
+    /**
+     * @brief Take a source out of the pool
+     * @return false if every source is in use
+     */
+    static bool acquire(ALuint &source);
+
+    /**
+     * @brief Stop a source that was taken out of the pool, detach its buffer, and put it back
+     */
+    static void recycle(ALuint source);
+
+    /**
+     * @brief Get the number of sources in the pool, and the number of those that are in use
+     */
+    static unsigned int getSize();
+    static unsigned int getNumberInUse();
+
+    /**
+     * @brief Get the largest number of sources that were in use at the same time
+     */
+    static unsigned int getHighWaterMark();
+
+    /**
+     * @brief Get the number of times that a source was requested while all of them were in use
+     */
+    static unsigned long getExhaustedCount();
+
+private:
+
+    static std::vector<ALuint> _sources;
+    static std::vector<ALuint> _freeSources;
+    static unsigned int _highWaterMark;
+    static unsigned long _exhaustedCount;
+
+    static void _reset(ALuint source);
+
+    SourcePool();
+    ~SourcePool();
+};
+
+}
+
+#endif
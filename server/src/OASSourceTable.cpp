@@ -0,0 +1,134 @@
+/**
+ * @file OASSourceTable.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASSourceTable.h"
+
+using namespace oas;
+
+SourceTable::SourceTable() :
+    _firstFree(NO_SLOT),
+    _lastFree(NO_SLOT),
+    _numFree(0),
+    _size(0)
+{
+}
+
+SourceTable::~SourceTable()
+{
+}
+
+// public
+bool SourceTable::reserve(ALuint &handle)
+{
+    unsigned int index;
+
+    if (_numFree > SOURCE_TABLE_MIN_FREE_SLOTS
+        || (_numFree && _slots.size() >= SOURCE_TABLE_CAPACITY))
+    {
+        index = _firstFree;
+        _firstFree = _slots[index].nextFree;
+        _numFree--;
+
+        if (NO_SLOT == _firstFree)
+            _lastFree = NO_SLOT;
+    }
+    else if (_slots.size() < SOURCE_TABLE_CAPACITY)
+    {
+        Slot slot;
+        slot.generation = 0;
+        _slots.push_back(slot);
+        index = _slots.size() - 1;
+    }
+    else
+    {
+        return false;
+    }
+
+    Slot &slot = _slots[index];
+    slot.source = NULL;
+    slot.nextFree = NO_SLOT;
+    slot.isUsed = true;
+    _size++;
+
+    handle = (slot.generation << SOURCE_TABLE_INDEX_BITS) | index;
+    return true;
+}
+
+// public
+void SourceTable::set(ALuint handle, AudioSource *source)
+{
+    unsigned int index = handle & SOURCE_TABLE_INDEX_MASK;
+
+    if (index < _slots.size() && _slots[index].isUsed
+        && _slots[index].generation == (handle >> SOURCE_TABLE_INDEX_BITS))
+    {
+        _slots[index].source = source;
+    }
+}
+
+// public
+AudioSource* SourceTable::find(ALuint handle) const
+{
+    unsigned int index = handle & SOURCE_TABLE_INDEX_MASK;
+
+    // A handle from a released source has an older generation than its slot
+    if (index >= _slots.size() || _slots[index].generation != (handle >> SOURCE_TABLE_INDEX_BITS))
+        return NULL;
+
+    return _slots[index].source;
+}
+
+// public
+AudioSource* SourceTable::remove(ALuint handle)
+{
+    unsigned int index = handle & SOURCE_TABLE_INDEX_MASK;
+
+    if (index >= _slots.size() || !_slots[index].isUsed
+        || _slots[index].generation != (handle >> SOURCE_TABLE_INDEX_BITS))
+    {
+        return NULL;
+    }
+
+    Slot &slot = _slots[index];
+    AudioSource *source = slot.source;
+
+    slot.source = NULL;
+    slot.isUsed = false;
+    slot.generation = (slot.generation + 1) & SOURCE_TABLE_GENERATION_MASK;
+    _size--;
+
+    // Append the slot to the end of the free list
+    if (NO_SLOT == _lastFree)
+        _firstFree = index;
+    else
+        _slots[_lastFree].nextFree = index;
+
+    _lastFree = index;
+    _numFree++;
+
+    return source;
+}
+
+// public
+unsigned int SourceTable::size() const
+{
+    return _size;
+}
+
+// public
+unsigned int SourceTable::getSlotCount() const
+{
+    return _slots.size();
+}
+
+// public
+AudioSource* SourceTable::getSourceAt(unsigned int index) const
+{
+    if (index >= _slots.size())
+        return NULL;
+
+    return _slots[index].source;
+}
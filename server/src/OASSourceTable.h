@@ -0,0 +1,108 @@
+/**
+ * @file    OASSourceTable.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_SOURCE_TABLE_H_
+#define _OAS_SOURCE_TABLE_H_
+
+#include <vector>
+#include <climits>
+#include <cstddef>
+#include <AL/alut.h>
+
+namespace oas
+{
+
+class AudioSource;
+
+// The low bits of a handle select a slot, and the bits above them hold the generation of the slot
+#define SOURCE_TABLE_INDEX_BITS         20
+#define SOURCE_TABLE_INDEX_MASK         ((1 << SOURCE_TABLE_INDEX_BITS) - 1)
+#define SOURCE_TABLE_CAPACITY           (1 << SOURCE_TABLE_INDEX_BITS)
+
+// Handles are sent to clients as non-negative integers, so only 11 bits are left for generations
+#define SOURCE_TABLE_GENERATION_MASK    0x7ff
+
+// Number of free slots that are held back before slots are reused. Without this, a client that
+// keeps creating and releasing one source at a time would cycle one slot through all of its
+// generations every 2048 sources.
+#define SOURCE_TABLE_MIN_FREE_SLOTS     1024
+
+/**
+ * Maps the handles of one session to its sources. A handle is the index of a slot, combined with
+ * the generation of the slot. The generation changes every time the slot is freed, so a handle
+ * that was released stops matching, even after its slot has been reused for a new source.
+ *
+ * Freed slots are reused in the order they were freed, and only once enough of them are free, so
+ * that a generation takes a long time to come around again. The table only grows while few slots
+ * are free, so its size is bounded by the largest number of sources that existed at once, plus
+ * SOURCE_TABLE_MIN_FREE_SLOTS.
+ */
+class SourceTable
+{
+public:
+
+    /**
+     * @brief Reserve a handle for a new source. Its slot holds NULL until set() is called.
+     * @return false if the table is full
+     */
+    bool reserve(ALuint &handle);
+
+    /**
+     * @brief Store the source for a handle returned by reserve()
+     */
+    void set(ALuint handle, AudioSource *source);
+
+    /**
+     * @brief Get the source with the given handle, or NULL if the handle is not in use
+     */
+    AudioSource* find(ALuint handle) const;
+
+    /**
+     * @brief Free the slot of the given handle, so that the handle no longer matches
+     * @return The source that had the handle, or NULL if the handle was not in use
+     */
+    AudioSource* remove(ALuint handle);
+
+    /**
+     * @brief Get the number of handles in use
+     */
+    unsigned int size() const;
+
+    /**
+     * @brief Get the number of slots, used or not. Along with getSourceAt(), this allows for
+     *        visiting every source in the table.
+     */
+    unsigned int getSlotCount() const;
+
+    /**
+     * @brief Get the source in the given slot, or NULL if the slot is free
+     */
+    AudioSource* getSourceAt(unsigned int index) const;
+
+    SourceTable();
+    ~SourceTable();
+
+private:
+
+    struct Slot
+    {
+        AudioSource *source;
+        unsigned int generation;
+        unsigned int nextFree;
+        bool isUsed;
+    };
+
+    static const unsigned int NO_SLOT = UINT_MAX;
+
+    std::vector<Slot> _slots;
+    unsigned int _firstFree;
+    unsigned int _lastFree;
+    unsigned int _numFree;
+    unsigned int _size;
+};
+
+}
+
+#endif
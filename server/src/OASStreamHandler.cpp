@@ -0,0 +1,163 @@
+/**
+ * @file OASStreamHandler.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASStreamHandler.h"
+
+using namespace oas;
+
+// Statics
+pthread_t                   StreamHandler::_thread;
+bool                        StreamHandler::_isRunning = false;
+std::list<AudioStream*>     StreamHandler::_streams;
+std::vector<AudioStream*>   StreamHandler::_removedStreams;
+pthread_mutex_t             StreamHandler::_streamsMutex = PTHREAD_MUTEX_INITIALIZER;
+bool                        StreamHandler::_hasWork = false;
+pthread_mutex_t             StreamHandler::_workMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t              StreamHandler::_workCondition = PTHREAD_COND_INITIALIZER;
+
+// static, public
+bool StreamHandler::initialize()
+{
+    if (StreamHandler::_isRunning)
+        return true;
+
+    StreamHandler::_isRunning = true;
+
+    if (pthread_create(&StreamHandler::_thread, NULL, &StreamHandler::_readLoop, NULL))
+    {
+        oas::Logger::errorf("StreamHandler - Failed to create the thread that reads streams.");
+        StreamHandler::_isRunning = false;
+        return false;
+    }
+
+    oas::Logger::logf("StreamHandler initialized...");
+    return true;
+}
+
+// static, public
+void StreamHandler::terminate()
+{
+    if (!StreamHandler::_isRunning)
+        return;
+
+    // The thread is not cancelled, because it might be in the middle of reading a stream
+    pthread_mutex_lock(&StreamHandler::_workMutex);
+    StreamHandler::_isRunning = false;
+    pthread_cond_signal(&StreamHandler::_workCondition);
+    pthread_mutex_unlock(&StreamHandler::_workMutex);
+
+    pthread_join(StreamHandler::_thread, NULL);
+
+    // Streams that were removed after the last pass of the thread
+    StreamHandler::_deleteRemovedStreams();
+}
+
+// static, public
+void StreamHandler::addStream(AudioStream *stream)
+{
+    pthread_mutex_lock(&StreamHandler::_streamsMutex);
+    StreamHandler::_streams.push_back(stream);
+    pthread_mutex_unlock(&StreamHandler::_streamsMutex);
+
+    StreamHandler::wake();
+}
+
+// static, public
+void StreamHandler::removeStream(AudioStream *stream)
+{
+    // Without the thread, nothing else can be reading the stream
+    if (!StreamHandler::_isRunning)
+    {
+        pthread_mutex_lock(&StreamHandler::_streamsMutex);
+        StreamHandler::_streams.remove(stream);
+        pthread_mutex_unlock(&StreamHandler::_streamsMutex);
+
+        delete stream;
+        return;
+    }
+
+    pthread_mutex_lock(&StreamHandler::_streamsMutex);
+    StreamHandler::_streams.remove(stream);
+    StreamHandler::_removedStreams.push_back(stream);
+    pthread_mutex_unlock(&StreamHandler::_streamsMutex);
+
+    // Let the thread delete it, instead of waiting for the thread to finish a read of it
+    StreamHandler::wake();
+}
+
+// static, public
+void StreamHandler::wake()
+{
+    pthread_mutex_lock(&StreamHandler::_workMutex);
+    StreamHandler::_hasWork = true;
+    pthread_cond_signal(&StreamHandler::_workCondition);
+    pthread_mutex_unlock(&StreamHandler::_workMutex);
+}
+
+// static, private
+void StreamHandler::_deleteRemovedStreams()
+{
+    std::vector<AudioStream*> removedStreams;
+
+    pthread_mutex_lock(&StreamHandler::_streamsMutex);
+    removedStreams.swap(StreamHandler::_removedStreams);
+    pthread_mutex_unlock(&StreamHandler::_streamsMutex);
+
+    for (unsigned int i = 0; i < removedStreams.size(); i++)
+        delete removedStreams[i];
+}
+
+// static, private
+void* StreamHandler::_readLoop(void *)
+{
+    std::vector<AudioStream*> streams;
+
+    while (1)
+    {
+        pthread_mutex_lock(&StreamHandler::_workMutex);
+
+        while (!StreamHandler::_hasWork && StreamHandler::_isRunning)
+        {
+            pthread_cond_wait(&StreamHandler::_workCondition,
+                              &StreamHandler::_workMutex);
+        }
+
+        StreamHandler::_hasWork = false;
+        bool isRunning = StreamHandler::_isRunning;
+
+        pthread_mutex_unlock(&StreamHandler::_workMutex);
+
+        if (!isRunning)
+            break;
+
+        // One block per stream at a time, so that every stream gets its turn, until all are full
+        bool didRead;
+
+        do
+        {
+            didRead = false;
+
+            // No pointer from the previous pass is held anymore
+            StreamHandler::_deleteRemovedStreams();
+
+            // The streams are read without the lock, so that adding or removing a stream never
+            // waits for the disk. A stream removed during the pass is only deleted after it.
+            pthread_mutex_lock(&StreamHandler::_streamsMutex);
+            streams.assign(StreamHandler::_streams.begin(), StreamHandler::_streams.end());
+            pthread_mutex_unlock(&StreamHandler::_streamsMutex);
+
+            for (unsigned int i = 0; i < streams.size(); i++)
+            {
+                if (streams[i]->decode())
+                    didRead = true;
+            }
+
+            streams.clear();
+        } while (didRead);
+    }
+
+    return NULL;
+}
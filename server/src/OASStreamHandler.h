@@ -0,0 +1,76 @@
+/**
+ * @file    OASStreamHandler.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_STREAM_HANDLER_H_
+#define _OAS_STREAM_HANDLER_H_
+
+#include <list>
+#include <vector>
+#include <pthread.h>
+
+#include "OASAudioStream.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+/**
+ * Reads the blocks of every audio stream ahead of playback, on a thread of its own, so that the
+ * server thread never waits for the disk. The thread sleeps until a stream has room for more
+ * blocks, and only touches the file. Queueing the blocks on OpenAL sources is left to the server
+ * thread.
+ */
+class StreamHandler
+{
+public:
+
+    /**
+     * @brief Start the thread that reads the streams
+     */
+    static bool initialize();
+    static void terminate();
+
+    /**
+     * @brief Start reading a stream. The stream handler does not take ownership of it.
+     */
+    static void addStream(AudioStream *stream);
+
+    /**
+     * @brief Stop reading a stream, and hand it over to the stream handler, which deletes it once
+     *        the thread is no longer reading it. The caller must not use the stream anymore.
+     */
+    static void removeStream(AudioStream *stream);
+
+    /**
+     * @brief Let the thread know that a stream has room for more blocks, because blocks were taken
+     *        or the stream was moved
+     */
+    static void wake();
+
+private:
+
+    static pthread_t _thread;
+    static bool _isRunning;
+
+    // Only held while the lists change, never while a stream is read. Removed streams are deleted
+    // by the thread between its passes over the streams, when it holds no pointer to them.
+    static std::list<AudioStream*> _streams;
+    static std::vector<AudioStream*> _removedStreams;
+    static pthread_mutex_t _streamsMutex;
+
+    static bool _hasWork;
+    static pthread_mutex_t _workMutex;
+    static pthread_cond_t _workCondition;
+
+    static void _deleteRemovedStreams();
+    static void* _readLoop(void *);
+
+    StreamHandler();
+    ~StreamHandler();
+};
+
+}
+
+#endif
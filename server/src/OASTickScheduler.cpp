@@ -0,0 +1,124 @@
+/**
+ * @file OASTickScheduler.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASTickScheduler.h"
+
+using namespace oas;
+
+TickScheduler::TickScheduler() :
+    _isRunning(false)
+{
+    setRate(DEFAULT_TICK_RATE);
+    resetStatistics();
+}
+
+TickScheduler::~TickScheduler()
+{
+}
+
+// public
+void TickScheduler::setRate(unsigned int ticksPerSecond)
+{
+    if (0 == ticksPerSecond)
+        ticksPerSecond = 1;
+
+    _rate = ticksPerSecond;
+    _period = Time(1.0 / ticksPerSecond);
+}
+
+// public
+unsigned int TickScheduler::getRate() const
+{
+    return _rate;
+}
+
+// public
+bool TickScheduler::isRunning() const
+{
+    return _isRunning;
+}
+
+// public
+Time TickScheduler::getNextTick() const
+{
+    if (_isRunning)
+        return _nextTick;
+
+    Time timeout;
+    timeout.update(Time::OAS_CLOCK_MONOTONIC);
+    timeout += Time(IDLE_TICK_TIMEOUT);
+    return timeout;
+}
+
+// public
+bool TickScheduler::isDue(const Time &now) const
+{
+    return (_isRunning && now >= _nextTick);
+}
+
+// public
+void TickScheduler::update(bool isActive, const Time &now)
+{
+    if (isDue(now))
+    {
+        double lateness = (now - _nextTick).asDouble();
+
+        _tickCount++;
+        _totalLateness += lateness;
+        if (lateness > _maximumLateness)
+            _maximumLateness = lateness;
+
+        // Stay on the grid. Ticks that were missed entirely are dropped, not run back to back.
+        _nextTick += _period;
+        while (now >= _nextTick)
+        {
+            _nextTick += _period;
+            _skippedCount++;
+        }
+    }
+    else if (!_isRunning)
+    {
+        _nextTick = now + _period;
+    }
+
+    _isRunning = isActive;
+}
+
+// public
+unsigned long TickScheduler::getTickCount() const
+{
+    return _tickCount;
+}
+
+// public
+unsigned long TickScheduler::getSkippedCount() const
+{
+    return _skippedCount;
+}
+
+// public
+double TickScheduler::getAverageJitter() const
+{
+    if (0 == _tickCount)
+        return 0.0;
+
+    return _totalLateness / _tickCount;
+}
+
+// public
+double TickScheduler::getMaximumJitter() const
+{
+    return _maximumLateness;
+}
+
+// public
+void TickScheduler::resetStatistics()
+{
+    _tickCount = 0;
+    _skippedCount = 0;
+    _totalLateness = 0.0;
+    _maximumLateness = 0.0;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file    OASTickScheduler.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_TICK_SCHEDULER_H_
+#define _OAS_TICK_SCHEDULER_H_
+
+#include "OASTime.h"
+
+namespace oas
+{
+
+// Number of times per second that playing and fading sources are updated
+#define DEFAULT_TICK_RATE       250
+
+// Longest time, in seconds, that the server sleeps while there is nothing to update
+#define IDLE_TICK_TIMEOUT       2
+
+/**
+ * Decides when the server updates its sources. Ticks fall on a fixed grid, one period apart, so
+ * that a late tick does not delay the ones after it. Ticks only run while some source is playing
+ * or fading. Otherwise, the server sleeps until a message arrives.
+ *
+ * The lateness of every tick is recorded, to measure the jitter of the server loop.
+ */
+class TickScheduler
+{
+public:
+
+    /**
+     * @brief Set the number of ticks per second
+     */
+    void setRate(unsigned int ticksPerSecond);
+    unsigned int getRate() const;
+
+    /**
+     * @brief Check whether ticks are running
+     */
+    bool isRunning() const;
+
+    /**
+     * @brief Get the time until which the server can sleep: the next tick if ticks are running,
+     *        else IDLE_TICK_TIMEOUT from now.
+     */
+    Time getNextTick() const;
+
+    /**
+     * @brief Check whether ticks are running and the next one is due
+     */
+    bool isDue(const Time &now) const;
+
+    /**
+     * @brief Record that the sources have just been updated. If ticks are running and the next
+     *        one is due, it counts as that tick.
+     * @param isActive Whether any source still needs updates. Ticks start one period from now,
+     *                 or stop, accordingly.
+     */
+    void update(bool isActive, const Time &now);
+
+    /**
+     * @brief Get the number of ticks that ran, and the number that were skipped because the
+     *        previous tick ran more than a period late
+     */
+    unsigned long getTickCount() const;
+    unsigned long getSkippedCount() const;
+
+    /**
+     * @brief Get the average and the largest lateness of a tick, in seconds
+     */
+    double getAverageJitter() const;
+    double getMaximumJitter() const;
+
+    void resetStatistics();
+
+    TickScheduler();
+    ~TickScheduler();
+
+private:
+
+    unsigned int _rate;
+    Time _period;
+    Time _nextTick;
+    bool _isRunning;
+
+    unsigned long _tickCount;
+    unsigned long _skippedCount;
+    double _totalLateness;
+    double _maximumLateness;
+};
+
+}
+
+#endif
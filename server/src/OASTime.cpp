@@ -102,3 +102,9 @@ Time::Time()
 	reset();
 }
 
+Time::Time(const Time &other)
+{
+    _time.tv_sec = other.getSeconds();
+    _time.tv_nsec = other.getNanoseconds();
+}
+
@@ -140,6 +140,11 @@ public:
      * @brief Constructor that sets an empty time.
      */
     Time();
+
+    /**
+     * @brief Copy constructor
+     */
+    Time(const Time &other);
 private:
 
     struct timespec _time;
@@ -0,0 +1,399 @@
+/**
+ * @file OASTransferHandler.cpp
+ * @author Shreenidhi Chowkwale
+ *
+ */
+
+#include "OASTransferHandler.h"
+
+using namespace oas;
+
+// Statics
+std::vector<pthread_t>              TransferHandler::_workers;
+std::queue<TransferHandler::Transfer> TransferHandler::_transfers;
+pthread_mutex_t                     TransferHandler::_transfersMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t                      TransferHandler::_transfersCondition = PTHREAD_COND_INITIALIZER;
+bool                                TransferHandler::_isTerminating = false;
+std::queue<ClientSession*>          TransferHandler::_returnedSessions;
+int                                 TransferHandler::_returnHandle = -1;
+
+// static, public
+bool TransferHandler::initialize(unsigned int numWorkers)
+{
+    // Uploads are accepted again after an earlier terminate()
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    TransferHandler::_isTerminating = false;
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+
+    // Created once, and kept open while the server runs, so the socket thread can keep watching it
+    if (numWorkers && -1 == TransferHandler::_returnHandle)
+    {
+        TransferHandler::_returnHandle = eventfd(0, EFD_NONBLOCK);
+
+        if (-1 == TransferHandler::_returnHandle)
+        {
+            oas::Logger::errorf("TransferHandler - Failed to create the return event descriptor.");
+            return false;
+        }
+    }
+
+    // Thread attribute variable
+    pthread_attr_t threadAttr;
+
+    pthread_attr_init(&threadAttr);
+    pthread_attr_setdetachstate(&threadAttr, PTHREAD_CREATE_JOINABLE);
+
+    for (unsigned int i = 0; i < numWorkers; i++)
+    {
+        pthread_t worker;
+
+        if (pthread_create(&worker, &threadAttr, &TransferHandler::_workerLoop, NULL))
+        {
+            oas::Logger::errorf("TransferHandler - Failed to create a worker thread.");
+            pthread_attr_destroy(&threadAttr);
+            return false;
+        }
+
+        TransferHandler::_workers.push_back(worker);
+    }
+
+    pthread_attr_destroy(&threadAttr);
+
+    if (numWorkers)
+        oas::Logger::logf("TransferHandler initialized with up to %u parallel transfers...", numWorkers);
+    else
+        oas::Logger::logf("TransferHandler - Transfer connections are disabled.");
+
+    return true;
+}
+
+// static, public
+void TransferHandler::terminate()
+{
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    TransferHandler::_isTerminating = true;
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+
+    // Idle workers are cancelled right away. Busy ones finish or abandon their transfer first.
+    for (unsigned int i = 0; i < TransferHandler::_workers.size(); i++)
+        pthread_cancel(TransferHandler::_workers[i]);
+
+    for (unsigned int i = 0; i < TransferHandler::_workers.size(); i++)
+        pthread_join(TransferHandler::_workers[i], NULL);
+
+    TransferHandler::_workers.clear();
+
+    // Give up on the files that no worker got to. Lent sessions still belong to the socket thread.
+    while (!TransferHandler::_transfers.empty())
+    {
+        Transfer transfer = TransferHandler::_transfers.front();
+        TransferHandler::_transfers.pop();
+
+        if (transfer.isLent)
+            TransferHandler::_returnSession(transfer.session);
+        else
+            TransferHandler::_finishTransfer(transfer.session, false);
+    }
+}
+
+// static, public
+bool TransferHandler::isEnabled()
+{
+    return !TransferHandler::_workers.empty();
+}
+
+// static, public
+void TransferHandler::addTransfer(ClientSession *session, const Message &ptfi)
+{
+    TransferHandler::_queueTransfer(session, ptfi, false);
+}
+
+// static, public
+void TransferHandler::lendSession(ClientSession *session, const Message &ptfi)
+{
+    TransferHandler::_queueTransfer(session, ptfi, true);
+}
+
+// static, public
+ClientSession* TransferHandler::getReturnedSession()
+{
+    ClientSession *retval = NULL;
+
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    if (!TransferHandler::_returnedSessions.empty())
+    {
+        retval = TransferHandler::_returnedSessions.front();
+        TransferHandler::_returnedSessions.pop();
+    }
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+
+    return retval;
+}
+
+// static, public
+int TransferHandler::getReturnDescriptor()
+{
+    return TransferHandler::isEnabled() ? TransferHandler::_returnHandle : -1;
+}
+
+// static, public
+bool TransferHandler::receiveFile(ClientSession *session, const Message &ptfi, char *fileChunk)
+{
+    int fileSize, bytesLeft, bytesRead;
+    oas::FileHandler fileHandler;
+    std::string filename, tempPath;
+    ContentHash hash;
+    std::string contentHash;
+    bool errorOccured = false;
+    bool writeFailed = false;
+    int connection = session->getConnection();
+
+    fileSize = ptfi.getIntegerParam();
+    bytesLeft = fileSize;
+
+    // Files uploaded by content are named after their hash, so that files with the same name but
+    // different contents do not overwrite each other
+    if (Message::MT_PTFC_FN_1I == ptfi.getMessageType())
+        filename = ContentIndex::getContentFilename(ptfi.getFilename());
+    else
+        filename = ptfi.getFilename();
+
+    if (0 > fileSize)
+    {
+        oas::Logger::errorf("TransferHandler - Invalid size %d for file %s!",
+                            fileSize, ptfi.getFilename().c_str());
+        return false;
+    }
+
+    oas::Logger::logf("> Receiving file \"%s\" (%d bytes) over socket.",
+                      ptfi.getFilename().c_str(),
+                      bytesLeft);
+
+    // The file is streamed to disk one chunk at a time, so memory use does not depend on its size.
+    // It replaces the cached file only once it has been received completely.
+    int fileDescriptor = -1;
+
+    if (Message::MT_PTFC_FN_1I == ptfi.getMessageType()
+        && !ContentIndex::isValidHash(ptfi.getFilename()))
+    {
+        oas::Logger::errorf("TransferHandler - \"%s\" is not a valid content hash!",
+                            ptfi.getFilename().c_str());
+    }
+    else
+        fileDescriptor = fileHandler.createTemporaryFile(filename, tempPath);
+
+    // If the file can't be written, the rest of it still has to be read off the connection
+    if (-1 == fileDescriptor)
+        writeFailed = true;
+
+    // The hash is computed along the way, to add the file to the content index
+    ContentIndex::beginHash(hash);
+
+    // The start of the file may have arrived in the same read as the PTFI message
+    bytesRead = MIN((int) session->_unconsumedBytes(), bytesLeft);
+    ContentIndex::updateHash(hash, session->_unconsumedData(), bytesRead);
+    if (!writeFailed && !fileHandler.writeToFile(fileDescriptor, session->_unconsumedData(), bytesRead))
+        writeFailed = true;
+    session->_consume(bytesRead);
+    bytesLeft -= bytesRead;
+
+    long count = 0;
+    int waitedMs = 0;
+
+    while (bytesLeft > 0)
+    {
+        if (TransferHandler::_isShuttingDown())
+        {
+            oas::Logger::errorf("TransferHandler - The server is shutting down. Abandoning %s.",
+                                ptfi.getFilename().c_str());
+            errorOccured = true;
+            break;
+        }
+
+        bytesRead = read(connection, fileChunk, MIN(bytesLeft, FILE_CHUNK_SIZE));
+
+        // The connection is non-blocking, so wait for more of the file to arrive. The wait is
+        // cut into short intervals, so that a shutdown does not have to wait for a stalled client.
+        if (-1 == bytesRead && (EAGAIN == errno || EWOULDBLOCK == errno || EINTR == errno))
+        {
+            struct pollfd pollInfo;
+            pollInfo.fd = connection;
+            pollInfo.events = POLLIN;
+
+            if (0 < poll(&pollInfo, 1, TRANSFER_POLL_INTERVAL_MS))
+            {
+                waitedMs = 0;
+                continue;
+            }
+
+            waitedMs += TRANSFER_POLL_INTERVAL_MS;
+            if (BINARY_READ_TIMEOUT_MS > waitedMs)
+                continue;
+        }
+
+        if (bytesRead == 0 || bytesRead == -1)
+        {
+            oas::Logger::errorf("TransferHandler - Error occured while receiving %s!",
+                                ptfi.getFilename().c_str());
+            errorOccured = true;
+            break;
+        }
+
+        ContentIndex::updateHash(hash, fileChunk, bytesRead);
+        if (!writeFailed && !fileHandler.writeToFile(fileDescriptor, fileChunk, bytesRead))
+            writeFailed = true;
+
+        bytesLeft -= bytesRead;
+
+        count++;
+
+        if ((0 == (count % 50)) || 0 == bytesLeft)
+        {
+            float percentage = ((float) (fileSize - bytesLeft) / fileSize) * 100.0;
+            oas::Logger::logf("> File %s...%.2f%% complete.",
+                             ptfi.getFilename().c_str(), percentage);
+        }
+    }
+
+    if (writeFailed)
+    {
+        oas::Logger::errorf("TransferHandler - Error occured while writing %s to disk.",
+                            ptfi.getFilename().c_str());
+        errorOccured = true;
+    }
+
+    contentHash = ContentIndex::finishHash(hash);
+
+    // Only keep a file uploaded by content if it really has that content
+    if (!errorOccured && Message::MT_PTFC_FN_1I == ptfi.getMessageType()
+        && contentHash != ptfi.getFilename())
+    {
+        oas::Logger::errorf("TransferHandler - The contents of %s do not match its hash!",
+                            ptfi.getFilename().c_str());
+        errorOccured = true;
+    }
+
+    if (-1 != fileDescriptor)
+    {
+        if (errorOccured)
+            fileHandler.discardTemporaryFile(fileDescriptor, tempPath);
+        else if (fileHandler.commitTemporaryFile(fileDescriptor, tempPath, filename))
+            ContentIndex::addFile(contentHash, filename);
+        else
+            errorOccured = true;
+    }
+
+    if (!errorOccured)
+    {
+        oas::Logger::logf("> File transmission complete.");
+        oas::Logger::logf("> %s is %d bytes", ptfi.getFilename().c_str(), fileSize);
+    }
+
+    return !errorOccured;
+}
+
+// static, private
+void* TransferHandler::_workerLoop(void *)
+{
+    int cancelState;
+
+    // Every file this worker receives is read through the same chunk buffer. It lives on the
+    // stack, so nothing is leaked when the worker is cancelled.
+    char fileChunk[FILE_CHUNK_SIZE];
+
+    while (1)
+    {
+        Transfer transfer;
+
+        pthread_mutex_lock(&TransferHandler::_transfersMutex);
+
+        // A worker that is cancelled while waiting holds the lock again, and must give it back
+        pthread_cleanup_push(&TransferHandler::_unlockTransfers, NULL);
+
+        while (TransferHandler::_transfers.empty())
+        {
+            pthread_cond_wait(&TransferHandler::_transfersCondition,
+                              &TransferHandler::_transfersMutex);
+        }
+
+        transfer = TransferHandler::_transfers.front();
+        TransferHandler::_transfers.pop();
+
+        pthread_cleanup_pop(1);
+
+        // A transfer is never cut short by cancellation, which would leak its session and leave
+        // its temporary file behind. terminate() makes it give up at the next chunk instead.
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &cancelState);
+
+        bool isSuccess = TransferHandler::receiveFile(transfer.session, transfer.ptfi, fileChunk);
+
+        if (transfer.isLent)
+            TransferHandler::_returnSession(transfer.session);
+        else
+            TransferHandler::_finishTransfer(transfer.session, isSuccess);
+
+        pthread_setcancelstate(cancelState, NULL);
+    }
+
+    return NULL;
+}
+
+// static, private
+void TransferHandler::_unlockTransfers(void *)
+{
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+}
+
+// static, private
+bool TransferHandler::_isShuttingDown()
+{
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    bool isTerminating = TransferHandler::_isTerminating;
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+
+    return isTerminating;
+}
+
+// static, private
+void TransferHandler::_queueTransfer(ClientSession *session, const Message &ptfi, bool isLent)
+{
+    Transfer transfer;
+
+    transfer.session = session;
+    transfer.ptfi = ptfi;
+    transfer.isLent = isLent;
+
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    TransferHandler::_transfers.push(transfer);
+    pthread_cond_signal(&TransferHandler::_transfersCondition);
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+}
+
+// static, private
+void TransferHandler::_returnSession(ClientSession *session)
+{
+    pthread_mutex_lock(&TransferHandler::_transfersMutex);
+    TransferHandler::_returnedSessions.push(session);
+    pthread_mutex_unlock(&TransferHandler::_transfersMutex);
+
+    // Wake up the socket thread, which resumes reading from the session
+    eventfd_write(TransferHandler::_returnHandle, 1);
+}
+
+// static, private
+void TransferHandler::_finishTransfer(ClientSession *session, bool isSuccess)
+{
+    const char *response = isSuccess ? "0\n" : "-1\n";
+    unsigned int responseLength = strlen(response);
+
+    // The file has been committed to the cache by now, so the client can load it as soon as it
+    // reads the response. The response is tiny, so the socket buffer always has room for it.
+    if (-1 == send(session->getConnection(), response, responseLength, MSG_NOSIGNAL))
+    {
+        oas::Logger::warnf("TransferHandler - Could not respond to client %s.",
+                           session->getAddress().c_str());
+    }
+
+    close(session->getConnection());
+    delete session;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file    OASTransferHandler.h
+ * @author  Shreenidhi Chowkwale
+ */
+
+#ifndef _OAS_TRANSFER_HANDLER_H_
+#define _OAS_TRANSFER_HANDLER_H_
+
+#include <string>
+#include <vector>
+#include <queue>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/param.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <cerrno>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "OASFileHandler.h"
+#include "OASContentIndex.h"
+#include "OASMessage.h"
+#include "OASClientSession.h"
+#include "OASLogger.h"
+
+namespace oas
+{
+
+#define FILE_CHUNK_SIZE             (64 * 1024)
+#define BINARY_READ_TIMEOUT_MS      10000
+
+// While waiting for more of a file, how often a transfer checks whether the server is shutting down
+#define TRANSFER_POLL_INTERVAL_MS   100
+
+// Number of files that can be received at the same time, over transfer connections
+#define DEFAULT_MAX_PARALLEL_TRANSFERS  2
+
+/**
+ * Receives files from clients. A client can attach extra connections to its session, which are
+ * only used for file transfers. Files sent over those connections are received by a pool of
+ * worker threads, so that the socket thread can keep parsing messages from every connection,
+ * including the client's own, while large files are uploaded.
+ *
+ * Files sent over a client's main connection are received by the workers too. The socket thread
+ * stops reading from that connection until the worker hands it back, so the messages around the
+ * file stay in order.
+ */
+class TransferHandler
+{
+public:
+
+    /**
+     * @brief Start the worker threads.
+     * @param numWorkers Number of files that can be received at the same time. With 0, clients
+     *                   can not attach transfer connections.
+     */
+    static bool initialize(unsigned int numWorkers);
+    static void terminate();
+
+    /**
+     * @brief Check whether clients can attach transfer connections
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Queue up the file that is about to be sent over a transfer connection, to be
+     *        received by the next free worker. The transfer handler takes ownership of the session,
+     *        which must not be watched by the socket thread any more. Once the file has been
+     *        received, the worker responds with "0" on success or "-1" on failure, and then
+     *        closes the connection.
+     * @param ptfi The PTFI or PTFC message that announced the file
+     */
+    static void addTransfer(ClientSession *session, const Message &ptfi);
+
+    /**
+     * @brief Queue up the file that is about to be sent over a client's main connection. The
+     *        worker that receives it does not respond or close the connection. Instead, it hands
+     *        the session back through getReturnedSession(), and signals the return descriptor.
+     *        The socket thread must not touch the session in the meantime.
+     * @param ptfi The PTFI or PTFC message that announced the file
+     */
+    static void lendSession(ClientSession *session, const Message &ptfi);
+
+    /**
+     * @brief Get the next session that a worker has handed back, or NULL if there are none
+     */
+    static ClientSession* getReturnedSession();
+
+    /**
+     * @brief Get the event descriptor that becomes readable when a session is handed back,
+     *        or -1 if there are no workers
+     */
+    static int getReturnDescriptor();
+
+    /**
+     * @brief Receive a file that was announced by a PTFI or PTFC message, and write it to the
+     *        cache. Blocks until the whole file has been read from the connection.
+     * @param fileChunk Buffer of FILE_CHUNK_SIZE bytes that the file is read into, owned by the
+     *                  calling thread
+     * @return true if the file was received and written to the cache
+     */
+    static bool receiveFile(ClientSession *session, const Message &ptfi, char *fileChunk);
+
+private:
+
+    struct Transfer
+    {
+        ClientSession *session;
+        Message ptfi;
+        bool isLent;
+    };
+
+    static std::vector<pthread_t> _workers;
+    static std::queue<Transfer> _transfers;
+    static pthread_mutex_t _transfersMutex;
+    static pthread_cond_t _transfersCondition;
+
+    // Sessions lent by lendSession(), once their file has been received
+    static std::queue<ClientSession*> _returnedSessions;
+    static int _returnHandle;
+
+    // Set by terminate(), so that a transfer in flight is abandoned at its next chunk
+    static bool _isTerminating;
+
+    static void* _workerLoop(void *parameter);
+    static void _unlockTransfers(void *parameter);
+    static bool _isShuttingDown();
+    static void _queueTransfer(ClientSession *session, const Message &ptfi, bool isLent);
+    static void _returnSession(ClientSession *session);
+    static void _finishTransfer(ClientSession *session, bool isSuccess);
+
+    TransferHandler();
+    ~TransferHandler();
+};
+
+}
+
+#endif